@@ -14,12 +14,15 @@
 #include "src/imagedata/imageinfo.h"
 #include "src/imagedata/imagesourcemodel.h"
 #include "src/imagedata/imageprovider.h"
+#include "src/imagedata/imagetileprovider.h"
+#include "src/imagedata/animationplayer.h"
 #include "src/utils/filetrashhelper.h"
 #include "src/qmlWidget.h"
 #include "config.h"
 
 #include "src/albumControl.h"
 #include "src/imageengine/imagedataservice.h"
+#include "src/dbmanager/formatsniffcache.h"
 #include "thumbnailview/itemviewadapter.h"
 #include "thumbnailview/positioner.h"
 #include "thumbnailview/rubberband.h"
@@ -39,6 +42,7 @@
 #include <QScopedPointer>
 #include <QQmlContext>
 #include <QIcon>
+#include <QTimer>
 
 DWIDGET_USE_NAMESPACE
 DCORE_USE_NAMESPACE
@@ -98,6 +102,8 @@ int main(int argc, char *argv[])
     qmlRegisterUncreatableType<PathViewProxyModel>(uri.toUtf8().data(), 1, 0, "PathViewProxyModel", "Use for view data");
     qmlRegisterType<MouseTrackItem>(uri.toUtf8().data(), 1, 0, "MouseTrackItem");
     qmlRegisterType<PathViewRangeHandler>(uri.toUtf8().data(), 1, 0, "PathViewRangeHandler");
+    // 动态图后台预解码播放
+    qmlRegisterType<AnimationPlayer>(uri.toUtf8().data(), 1, 0, "AnimationPlayer");
     // 文件回收站处理
     qmlRegisterType<FileTrashHelper>(uri.toUtf8().data(), 1, 0, "FileTrashHelper");
 
@@ -140,7 +146,15 @@ int main(int argc, char *argv[])
     ThumbnailProvider *multiImageLoad = new ThumbnailProvider;
     engine.addImageProvider(QLatin1String("ThumbnailLoad"), multiImageLoad);
 
+    // 超大图像分块加载
+    ImageTileProvider *imageTileProvider = new ImageTileProvider;
+    engine.addImageProvider(QLatin1String("ImageTile"), imageTileProvider);
+
     // 关联各组件
+    // 切换图片时固定当前及相邻图片的缓存，预加载附近的图片
+    QObject::connect(control.viewModel(), &PathViewProxyModel::preloadRequested, [&](const QStringList &visiblePaths, const QStringList &filePaths) {
+        providerCache->preloadImages(visiblePaths, filePaths);
+    });
     // 图片旋转时更新图像缓存
     QObject::connect(&control, &GlobalControl::requestRotateCacheImage, [&]() {
         providerCache->rotateImageCached(control.currentRotation(), control.currentSource().toLocalFile());
@@ -153,6 +167,7 @@ int main(int argc, char *argv[])
     // 文件变更时清理缓存
     QObject::connect(&fileControl, &FileControl::imageFileChanged, [&](const QString &fileName) {
         providerCache->removeImageCache(fileName);
+        imageTileProvider->removeImageCache(fileName);
     });
 
     // 判断命令行数据，在 QML 前优先加载
@@ -215,12 +230,20 @@ int main(int argc, char *argv[])
     }
     qInfo() << "Main QML file loaded successfully";
 
+    // 界面连接信号后再恢复上次未完成的导入任务，保证界面能收到导入开始、进度等信号
+    QTimer::singleShot(0, AlbumControl::instance(), &AlbumControl::resumeImportJobs);
+
     // 设置DBus接口
     qDebug() << "Registering DBus service and object";
     ApplicationAdaptor adaptor(&fileControl);
     QDBusConnection::sessionBus().registerService("com.deepin.album");
     QDBusConnection::sessionBus().registerObject("/", &fileControl);
 
+    // 退出前保存格式嗅探缓存
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+        FormatSniffCache::instance()->flush();
+    });
+
     qInfo() << "Application initialization completed";
     return app.exec();
 }
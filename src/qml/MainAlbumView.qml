@@ -257,6 +257,16 @@ FadeInoutAnimation {
             idStandardProgressDialog.setProgress(percent, 100)
         }
     
+        // 收到按字节的导入进度消息(从设备复制文件)
+        function onSigImportBytesProgress(copiedBytes, totalBytes, bytesPerSecond) {
+            var prevS = qsTr("Imported:")
+            var suffixS = qsTr("%1/%2").arg(formatBytes(copiedBytes)).arg(formatBytes(totalBytes))
+            var contentS = prevS + suffixS + " (" + formatBytes(bytesPerSecond) + "/s)"
+            var percent = totalBytes > 0 ? copiedBytes * 100 / totalBytes : 0
+            idStandardProgressDialog.setContent(contentS)
+            idStandardProgressDialog.setProgress(percent, 100)
+        }
+    
         // 收到导入完成消息
         function onSigImportFinished() {
             delayTimer.start()
@@ -302,6 +312,16 @@ FadeInoutAnimation {
         onTriggered: closeProgress()
     }
 
+    function formatBytes(bytes) {
+        var units = ["B", "KB", "MB", "GB", "TB"]
+        var i = 0
+        while (bytes >= 1024 && i < units.length - 1) {
+            bytes /= 1024
+            ++i
+        }
+        return (i === 0 ? bytes : bytes.toFixed(1)) + " " + units[i]
+    }
+
     function showProgress(title, content) {
         idStandardProgressDialog.clear()
         idStandardProgressDialog.setTitle(title)
@@ -28,13 +28,16 @@ Item {
     property ImageInputHandler inputHandler: null
     // PathView下不再提供 index === GControl.currentIndex
     property bool isCurrentImage: parent.PathView.view.currentIndex === model.index
+    // 图片开始加载的时间，用于统计打开图片的感知耗时
+    property double loadStartTime: 0
     // 坐标偏移，用于动画效果时调整显示位置
     property real offset: 0
     // 图片绘制区域到边框的位置
     property real paintedPaddingWidth: 0
     property url source
     property int status: Image.Null
-    property Image targetImage
+    // 显示的图片组件，Image 或提供 paintedWidth/paintedHeight/status 等相同属性的组件(如 AnimationPlayer)
+    property Item targetImage
     property alias targetImageInfo: imageInfo
     property int type: Album.Types.NullImage
 
@@ -122,7 +125,14 @@ Item {
         }
     }
     onStatusChanged: {
-        if (Image.Ready === status || Image.Error === status) {
+        if (Image.Loading === status) {
+            loadStartTime = Date.now();
+        } else if (Image.Ready === status || Image.Error === status) {
+            if (isCurrentImage && loadStartTime > 0) {
+                console.debug("Image open latency(ms):", Date.now() - loadStartTime, source);
+            }
+            loadStartTime = 0;
+
             // 重置状态
             reset();
         }
@@ -189,6 +199,12 @@ Item {
                 height: parent.height
                 source: "image://ThumbnailLoad/" + delegate.source + "#frame_" + delegate.frameIndex
                 width: parent.width
+
+                onStatusChanged: {
+                    if (Image.Ready === status && baseDelegate.loadStartTime > 0) {
+                        console.debug("Image preview latency(ms):", Date.now() - baseDelegate.loadStartTime, baseDelegate.source);
+                    }
+                }
             }
 
             MultiEffect {
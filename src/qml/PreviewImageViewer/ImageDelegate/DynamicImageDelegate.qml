@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 import QtQuick
+import org.deepin.image.viewer 1.0 as IV
 import "../Utils"
 
 BaseImageDelegate {
@@ -14,14 +15,13 @@ BaseImageDelegate {
     status: image.status
     targetImage: image
 
-    AnimatedImage {
+    // 后台线程预解码帧数据，仅当前显示的图片播放
+    IV.AnimationPlayer {
         id: image
 
-        asynchronous: true
-        cache: false
         clip: true
-        fillMode: Image.PreserveAspectFit
         height: delegate.height
+        playing: delegate.isCurrentImage
         scale: 1.0
         smooth: true
         source: delegate.source
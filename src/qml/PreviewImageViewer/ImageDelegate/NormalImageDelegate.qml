@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 import QtQuick
+import QtQuick.Window
 import org.deepin.image.viewer 1.0 as IV
 import "../Utils"
 
@@ -10,6 +11,18 @@ BaseImageDelegate {
     id: delegate
 
     property bool rotationRunning: false
+    // 超大图像仅加载预览图，放大后通过 TiledImageLayer 分块加载可见区域
+    // 判断在后台线程完成，完成前不加载图像，避免超大图像按原始大小解码
+    property bool tiled: false
+    property bool tiledChecked: false
+
+    function checkTiled() {
+        delegate.tiled = false;
+        delegate.tiledChecked = (delegate.source == "");
+        if (!delegate.tiledChecked) {
+            FileControl.checkTiledImage(delegate.source.toString());
+        }
+    }
 
     function resetSource() {
         // 加载完成，触发动画效果
@@ -21,7 +34,7 @@ BaseImageDelegate {
     }
 
     function updateSource() {
-        if (delegate.source != "") {
+        if (delegate.source != "" && delegate.tiledChecked) {
             // 由于会 resetSource() 破坏绑定，因此重新设置源数据
             image.source = "image://ImageLoad/" + delegate.source + "#frame_" + delegate.frameIndex;
         } else {
@@ -33,8 +46,27 @@ BaseImageDelegate {
     status: image.status
     targetImage: image
 
+    Component.onCompleted: {
+        checkTiled();
+        updateSource();
+    }
     onFrameIndexChanged: updateSource()
-    onSourceChanged: updateSource()
+    onSourceChanged: {
+        checkTiled();
+        updateSource();
+    }
+    onTiledCheckedChanged: updateSource()
+
+    Connections {
+        function onTiledImageChecked(path, isTiled) {
+            if (path === delegate.source.toString()) {
+                delegate.tiled = isTiled;
+                delegate.tiledChecked = true;
+            }
+        }
+
+        target: FileControl
+    }
 
     Image {
         id: image
@@ -46,7 +78,7 @@ BaseImageDelegate {
         mipmap: true
         scale: 1.0
         smooth: true
-        source: "image://ImageLoad/" + delegate.source + "#frame_" + delegate.frameIndex
+        sourceSize: delegate.tiled ? Qt.size(Screen.width * Screen.devicePixelRatio, Screen.height * Screen.devicePixelRatio) : undefined
         width: delegate.width
 
         onStatusChanged: {
@@ -54,6 +86,20 @@ BaseImageDelegate {
                 rotateAnimationLoader.active = false;
             }
         }
+
+        TiledImageLayer {
+            height: image.paintedHeight
+            source: delegate.source
+            sourceHeight: delegate.targetImageInfo.height
+            sourceWidth: delegate.targetImageInfo.width
+            targetImage: image
+            viewItem: delegate
+            // 旋转过程中缓存的预览图已旋转，分块未旋转，此时不显示分块
+            visible: delegate.tiled && Image.Ready === image.status && !rotationRunning && (!delegate.isCurrentImage || 0 === GControl.currentRotation % 360)
+            width: image.paintedWidth
+            x: (image.width - image.paintedWidth) / 2
+            y: (image.height - image.paintedHeight) / 2
+        }
     }
 
     // 旋转动画效果
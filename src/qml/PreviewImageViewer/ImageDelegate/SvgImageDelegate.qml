@@ -10,10 +10,34 @@ import "../Utils"
 BaseImageDelegate {
     id: delegate
 
+    // 放大超出光栅化图像清晰度时，通过 TiledImageLayer 仅光栅化可见区域
+    property size tiledSize: Qt.size(0, 0)
+
+    // 矢量图在后台线程解析，通过 svgTiledSizeChecked() 更新分块大小
+    function checkTiledSize() {
+        delegate.tiledSize = Qt.size(0, 0);
+        if (delegate.source != "") {
+            FileControl.checkSvgTiledSize(delegate.source.toString());
+        }
+    }
+
     status: image.status
     targetImage: image
     inputHandler: imageInput
 
+    Component.onCompleted: checkTiledSize()
+    onSourceChanged: checkTiledSize()
+
+    Connections {
+        function onSvgTiledSizeChecked(path, size) {
+            if (path === delegate.source.toString()) {
+                delegate.tiledSize = size;
+            }
+        }
+
+        target: FileControl
+    }
+
     Image {
         id: image
 
@@ -26,9 +50,22 @@ BaseImageDelegate {
         mipmap: true
         smooth: true
         scale: 1.0
-        source: delegate.source
-        // 设置为当前图像的图片源，调整因缩放导致的模糊
+        // 按显示大小所属档位光栅化，相近大小复用缓存的光栅化图像
+        source: delegate.source != "" ? "image://ImageTile/" + delegate.source + "#svg" : ""
         sourceSize: Qt.size(width, height)
+
+        TiledImageLayer {
+            height: image.paintedHeight
+            source: delegate.source
+            sourceHeight: delegate.tiledSize.height
+            sourceWidth: delegate.tiledSize.width
+            targetImage: image
+            viewItem: delegate
+            visible: Image.Ready === image.status
+            width: image.paintedWidth
+            x: (image.width - image.paintedWidth) / 2
+            y: (image.height - image.paintedHeight) / 2
+        }
     }
 
     ImageInputHandler {
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+import QtQuick
+
+// 超大图像分块图层，放置于 targetImage 内部跟随缩放和拖拽。
+// 放大超出预览图清晰度时，仅请求当前缩放层级下可见区域的图像分块
+Item {
+    id: tileLayer
+
+    // 当前显示比例(屏幕像素 / 原图像素)
+    readonly property real displayScale: (targetImage && sourceWidth > 0) ? targetImage.paintedWidth * targetImage.scale / sourceWidth : 0
+    // 分块层级，每级为上一级缩小 1/2 ，显示比例越小层级越高
+    readonly property int level: displayScale > 0 ? Math.max(0, Math.floor(Math.log(1 / displayScale) / Math.LN2)) : 0
+    property url source
+    property int sourceHeight: 0
+    property int sourceWidth: 0
+    property Image targetImage: null
+    readonly property int tileSize: FileControl.imageTileSize()
+    property var tiles: []
+    // 用于计算可见区域的视图
+    property Item viewItem: null
+
+    function updateTiles() {
+        if (!visible || !targetImage || !viewItem || sourceWidth <= 0 || width <= 0) {
+            tiles = [];
+            return;
+        }
+
+        // 显示大小未超出预览图分辨率时，无需加载分块
+        if (targetImage.paintedWidth * targetImage.scale <= targetImage.implicitWidth) {
+            tiles = [];
+            return;
+        }
+
+        // 可见区域映射到原图坐标
+        var visibleRect = tileLayer.mapFromItem(viewItem, 0, 0, viewItem.width, viewItem.height);
+        var left = Math.max(0, visibleRect.x);
+        var top = Math.max(0, visibleRect.y);
+        var right = Math.min(width, visibleRect.x + visibleRect.width);
+        var bottom = Math.min(height, visibleRect.y + visibleRect.height);
+        if (right <= left || bottom <= top) {
+            tiles = [];
+            return;
+        }
+
+        var ratio = sourceWidth / width;
+        var tileSourceSize = tileSize * Math.pow(2, level);
+        var firstColumn = Math.floor(left * ratio / tileSourceSize);
+        var lastColumn = Math.floor((right * ratio - 1) / tileSourceSize);
+        var firstRow = Math.floor(top * ratio / tileSourceSize);
+        var lastRow = Math.floor((bottom * ratio - 1) / tileSourceSize);
+        var newTiles = [];
+        for (var row = firstRow; row <= lastRow; ++row) {
+            for (var column = firstColumn; column <= lastColumn; ++column) {
+                var sourceX = column * tileSourceSize;
+                var sourceY = row * tileSourceSize;
+                newTiles.push({
+                        "x": sourceX / ratio,
+                        "y": sourceY / ratio,
+                        "width": Math.min(tileSourceSize, sourceWidth - sourceX) / ratio,
+                        "height": Math.min(tileSourceSize, sourceHeight - sourceY) / ratio,
+                        "source": "image://ImageTile/" + tileLayer.source + "#tile_" + level + "_" + column + "_" + row
+                    });
+            }
+        }
+        tiles = newTiles;
+    }
+
+    onSourceWidthChanged: updateTimer.restart()
+    onVisibleChanged: updateTimer.restart()
+    onWidthChanged: updateTimer.restart()
+
+    // 缩放拖拽时合并刷新，避免频繁请求分块
+    Timer {
+        id: updateTimer
+
+        interval: 50
+
+        onTriggered: tileLayer.updateTiles()
+    }
+
+    Connections {
+        function onScaleChanged() {
+            updateTimer.restart();
+        }
+
+        function onXChanged() {
+            updateTimer.restart();
+        }
+
+        function onYChanged() {
+            updateTimer.restart();
+        }
+
+        target: tileLayer.targetImage
+    }
+
+    Connections {
+        function onHeightChanged() {
+            updateTimer.restart();
+        }
+
+        function onWidthChanged() {
+            updateTimer.restart();
+        }
+
+        target: tileLayer.viewItem
+    }
+
+    Repeater {
+        model: tileLayer.tiles
+
+        delegate: Image {
+            asynchronous: true
+            cache: false
+            height: modelData.height
+            smooth: true
+            source: modelData.source
+            width: modelData.width
+            x: modelData.x
+            y: modelData.y
+        }
+    }
+}
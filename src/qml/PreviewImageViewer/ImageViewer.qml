@@ -432,7 +432,7 @@ Item {
 
         // 当前展示的 Image 图片对象，空图片、错误图片、消失图片等异常为 undefined
         // 此图片信息用于外部交互缩放、导航窗口等，已标识类型，使用 null !== currentImage 判断
-        property Image currentImage: {
+        property Item currentImage: {
             if (view.currentItem) {
                 if (view.currentItem.item) {
                     return view.currentItem.item.targetImage;
@@ -23,7 +23,7 @@ Item {
     // 期望是否显示，同时控制动画效果
     property bool prefferVisible: GStatus.enableNavigation && imageNeedNavi
     // 指向的图片对象
-    property Image targetImage
+    property Item targetImage
 
     // 请求释放信号，长时间不使用的导航窗口将请求销毁
     signal requestRelease
@@ -23,7 +23,7 @@ Control {
     // 用于外部获取当前缩略图栏内容的长度，用于布局, 10px为焦点缩略图不在ListView中的边框像素宽度(radius = 4 * 1.25)
     property int listContentWidth: bottomthumbnaillistView.count > 10 ? (bottomthumbnaillistView.contentWidth + 10)
                                                                       : (55 + (bottomthumbnaillistView.count - 1) * 30 + 20)
-    property Image targetImage
+    property Item targetImage
 
     function deleteCurrentImage() {
         thumbnailView.imageDeleting = true;
@@ -14,7 +14,7 @@ Item {
 
     // 仅部分图片允许旋转
     property bool isRotatable: false
-    property Image targetImage: null
+    property Item targetImage: null
 
     function reset() {
         // 复位时立即刷新
@@ -222,7 +222,6 @@ BaseView {
                     }else{
                         albumControl.importFromMountDevice(theView.allUrls(),albumControl.getAllCustomAlbumId(GStatus.albumChangeList)[currentImportIndex])
                     }
-                    DTK.sendMessage(thumbnailImage, qsTr("Import successful"), "notify_checked")
                 }
                 width: 114
                 height: 36
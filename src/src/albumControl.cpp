@@ -6,6 +6,12 @@
 #include "dbmanager/dbmanager.h"
 #include "fileMonitor/fileinotifygroup.h"
 #include "imageengine/imageenginethread.h"
+#include "imageengine/imagedataservice.h"
+#include "imagedata/svgrastercache.h"
+#include "imageengine/filecopyengine.h"
+#include "dbmanager/devicescancache.h"
+#include "unionimage/baseutils.h"
+#include "unionimage/dirwalker.h"
 #include "utils/devicehelper.h"
 
 #include <DDialog>
@@ -19,17 +25,23 @@
 #include <QFileDialog>
 #include <QProcess>
 #include <QRegularExpression>
-#include <QDirIterator>
 #include <QCoreApplication>
 #include <QFuture>
 #include <QtConcurrent>
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
 
 DWIDGET_USE_NAMESPACE
 DGUI_USE_NAMESPACE
 DCORE_USE_NAMESPACE
 
+// 启动后补充内容标识的延迟(ms)
+static const int s_backfillDelay = 10000;
+
 namespace {
 static QMap<QString, const char *> i18nMap {
     {"data", "Data Disk"}
@@ -60,6 +72,9 @@ static std::initializer_list<std::pair<QString, QString>> opticalmediakeys {
 static QVector<std::pair<QString, QString>> opticalmediakv(opticalmediakeys);
 static QMap<QString, QString> opticalmediamap(opticalmediakeys);
 
+// 图库文件所在目录的快照在 DirSnapshotTable3 中的键
+const QString librarySnapshotKey = QStringLiteral("library");
+
 } //namespace
 
 AlbumControl *AlbumControl::m_instance = nullptr;
@@ -129,6 +144,13 @@ AlbumControl::AlbumControl(QObject *parent)
     initDeviceMonitor();
 
     connect(DGuiApplicationHelper::instance(), &DGuiApplicationHelper::newProcessInstance, this, &AlbumControl::onNewAPPOpen);
+
+    // 为内容标识字段添加前导入的记录补充内容标识，延迟执行避免与启动时的缩略图加载争抢磁盘
+    QTimer::singleShot(s_backfillDelay, this, []() {
+        QThreadPool::globalInstance()->start([]() {
+            DBManager::instance()->backfillContentHash();
+        });
+    });
     qDebug() << "AlbumControl initialization completed";
 }
 
@@ -154,6 +176,7 @@ DBImgInfo AlbumControl::getDBInfo(const QString &srcpath, bool isVideo)
     QFileInfo srcfi(srcpath);
     DBImgInfo dbi;
     dbi.filePath = srcpath;
+    dbi.fileSize = srcfi.size();
     dbi.importTime = QDateTime::currentDateTime();
     if (isVideo) {
         //获取视频信息
@@ -165,10 +188,13 @@ DBImgInfo AlbumControl::getDBInfo(const QString &srcpath, bool isVideo)
             return dbi;
         }
         //对视频信息缓存
+        QMutexLocker locker(&m_movieInfosMutex);
         m_movieInfos[srcpath] = movieInfo;
+        locker.unlock();
 
         dbi.itemType = ItemTypeVideo;
         dbi.changeTime = srcfi.lastModified();
+        dbi.contentHash = Libutils::base::contentHash(srcpath);
 
         if (movieInfo.creation.isValid()) {
             dbi.time = movieInfo.creation;
@@ -181,12 +207,16 @@ DBImgInfo AlbumControl::getDBInfo(const QString &srcpath, bool isVideo)
         }
     } else {
         qDebug() << "Processing image file";
-        auto mds = getAllMetaData(srcpath);
-        QString value = mds.value("DateTimeOriginal");
+        //只读取文件头的 EXIF 信息，优先使用拍摄时间
+        UnionImageProbe probe(srcpath);
+        const ExifInfo &exif = probe.exifInfo();
         dbi.itemType = ItemTypePic;
-        dbi.changeTime = QDateTime::fromString(mds.value("DateTimeDigitized"), "yyyy/MM/dd hh:mm");
-        if (!value.isEmpty()) {
-            dbi.time = QDateTime::fromString(value, "yyyy/MM/dd hh:mm");
+        dbi.changeTime = exif.dateTimeDigitized;
+        // 内容标识复用 EXIF 解析使用的文件映射，仅访问首尾数据块，未映射时读取文件
+        dbi.contentHash = probe.fileData().isEmpty() ? Libutils::base::contentHash(srcpath)
+                                                     : Libutils::base::contentHash(probe.fileData());
+        if (exif.dateTimeOriginal.isValid()) {
+            dbi.time = exif.dateTimeOriginal;
         } else if (srcfi.birthTime().isValid()) {
             dbi.time = srcfi.birthTime();
         } else if (srcfi.metadataChangeTime().isValid()) {
@@ -284,6 +314,9 @@ QString AlbumControl::getAllFilters()
 
 void AlbumControl::unMountDevice(const QString &devicePath)
 {
+    //先停止从该设备复制导入，避免设备因正在读取而无法弹出
+    stopDeviceImports(devicePath);
+
     QString deviceId = DeviceHelper::instance()->getDeviceIdByMountPoint(devicePath);
     if (!deviceId.isEmpty() && DeviceHelper::instance()->detachDevice(deviceId)) {
         // 等待最多200ms超时
@@ -297,7 +330,7 @@ void AlbumControl::unMountDevice(const QString &devicePath)
         // 设备不存在，则卸载成功，否则提示卸载失败
         if (!DeviceHelper::instance()->isExist(deviceId)) {
             m_durlAndNameMap.remove(devicePath);
-            m_PhonePicFileMap.remove(devicePath);
+            removeDeviceAlbumInfo(devicePath);
         } else {
             DDialog msgbox;
             msgbox.setFixedWidth(400);
@@ -356,6 +389,51 @@ QStringList AlbumControl::getAllPaths(const int &filterType)
     return list;
 }
 
+/**
+   @brief 按文件大小和内容标识查询重复文件，并逐字节确认内容相同，不存在的文件不计入
+   @return 重复文件分组，每组为至少包含两个 url 路径的列表
+ */
+static QVariantList duplicateUrlGroups()
+{
+    QVariantList groups;
+    const QList<QStringList> candidates = DBManager::instance()->getDuplicateGroups();
+    for (const QStringList &candidate : candidates) {
+        QStringList urls;
+        QString firstPath;
+        for (const QString &path : candidate) {
+            if (!QFile::exists(path)) {
+                continue;
+            }
+            if (firstPath.isEmpty()) {
+                firstPath = path;
+            } else if (!Libutils::base::sameFileContent(firstPath, path)) {
+                continue;
+            }
+            urls << "file://" + path;
+        }
+        if (urls.size() > 1) {
+            groups << urls;
+        }
+    }
+    qDebug() << "Found" << groups.size() << "duplicate groups";
+    return groups;
+}
+
+void AlbumControl::requestDuplicateUrlGroups()
+{
+    QPointer<AlbumControl> self(this);
+    QThreadPool::globalInstance()->start([self]() {
+        const QVariantList groups = duplicateUrlGroups();
+        if (self) {
+            QMetaObject::invokeMethod(self, [self, groups]() {
+                if (self) {
+                    emit self->sigDuplicateUrlGroups(groups);
+                }
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
 QVariantList AlbumControl::getAlbumAllInfos(const int &filterType)
 {
     QVariantList reinfoList;
@@ -727,53 +805,173 @@ void AlbumControl::startMonitor()
             continue;
         }
 
-        //1.获取原有的路径
-        auto originPaths = DBManager::instance()->getPathsByAlbum(uid);
-
-        //2.获取现在的路径
-        QFileInfoList infos = LibUnionImage_NameSpace::getImagesAndVideoInfo(eachItem, false);
-        QStringList currentPaths;
-        std::transform(infos.begin(), infos.end(), std::back_inserter(currentPaths), [](const QFileInfo & info) {
-            return info.isSymLink() ? info.readSymLink() : info.absoluteFilePath();
-        });
+        //与 FileInotify::reconcileDir 相同，只重新读取修改时间变化的目录，并按目录与相册中的记录比较
+        const QString root = QDir(eachItem).absolutePath();
+        const QString snapshotKey = QString("custom/%1%2").arg(uid).arg(root);
+        //FAT/exFAT 上目录修改时间不可靠，不使用快照，完整读取并与全部记录比较
+        const bool useSnapshot = DeviceScanCache::reliableDirModifyTime(root);
+        const LibUnionImage_NameSpace::DirSnapshot previous = useSnapshot ? DBManager::instance()->getDirSnapshot(snapshotKey)
+                                                                           : LibUnionImage_NameSpace::DirSnapshot();
+        LibUnionImage_NameSpace::DirSnapshot current;
+        QHash<QString, QStringList> found;  // 重新读取的目录中的文件 QHash<目录, 文件>
+        LibUnionImage_NameSpace::walkMediaFilesBatched(root, [&found](const QStringList &files) {
+            for (const QString &file : files) {
+                found[file.left(file.lastIndexOf('/'))] << file;
+            }
+            return true;
+        }, true, &previous, &current);
 
-        //3.1获取已不存在的路径
-        QFuture<QString> watcher = QtConcurrent::filtered(originPaths, [currentPaths](const QString & path) {
-            return !currentPaths.contains(path);
-        });
-        watcher.waitForFinished();
-        QStringList deleteFiles(watcher.results());
+        QSet<QString> changedDirs;
+        QSet<QString> currentDirs;
+        const bool changed = LibUnionImage_NameSpace::diffDirSnapshot(root, previous, current, changedDirs, currentDirs);
+        //快照只需记录目录结构
+        for (auto itr = current.begin(); itr != current.end(); ++itr) {
+            itr->files.clear();
+        }
+        if (!changed) {
+            continue;
+        }
 
-        //3.2移除已导入的路径
-        auto watcher2 = QtConcurrent::filter(currentPaths, [originPaths](const QString & path) {
-            return !originPaths.contains(path);
-        });
-        watcher2.waitForFinished();
+        //1.获取原有的路径，按目录分组
+        QHash<QString, QStringList> recorded;
+        const QString prefix = root.endsWith('/') ? root : root + '/';
+        const QStringList originPaths = DBManager::instance()->getPathsByAlbum(uid);
+        for (const QString &path : originPaths) {
+            if (path.startsWith(prefix)) {
+                recorded[path.left(path.lastIndexOf('/'))] << path;
+            }
+        }
 
+        //2.比较重新读取的目录，已删除目录中的记录全部移除
+        QStringList deleteFiles;
+        QStringList currentPaths;
+        for (const QString &dir : changedDirs) {
+            const QStringList dbFiles = recorded.value(dir);
+            const QSet<QString> dbSet(dbFiles.begin(), dbFiles.end());
+            QSet<QString> diskSet;
+            for (const QString &file : found.value(dir)) {
+                QFileInfo fileInfo(file);
+                const QString filePath = fileInfo.isSymLink() ? fileInfo.readSymLink() : file;
+                diskSet.insert(filePath);
+                if (!dbSet.contains(filePath)) {
+                    currentPaths << filePath;
+                }
+            }
+            for (const QString &path : dbFiles) {
+                //符号链接指向其它目录时记录不在本目录的读取结果中
+                if (!diskSet.contains(path) && !QFileInfo::exists(path)) {
+                    deleteFiles << path;
+                }
+            }
+        }
+        for (auto itr = recorded.constBegin(); itr != recorded.constEnd(); ++itr) {
+            if (!currentDirs.contains(itr.key())) {
+                deleteFiles << itr.value();
+            }
+        }
+        qInfo() << "Reconciled custom auto import folder" << root << "directories:" << current.size()
+                << "changed:" << changedDirs.size() << "new files:" << currentPaths.size() << "deleted files:" << deleteFiles.size();
 
-        //4.删除不存在的路径
+        //3.删除不存在的路径
         if (!deleteFiles.isEmpty()) {
             DBManager::instance()->removeImgInfos(deleteFiles);
         }
 
-        //5.执行导入
-        if (!currentPaths.isEmpty()) {
-            QStringList urls;
-            for (QString path : currentPaths) {
-                urls << QUrl::fromLocalFile(path).toString();
+        //4.执行导入，导入数据全部提交后才保存快照，导入中断时下次启动重新比较
+        if (currentPaths.isEmpty()) {
+            if (useSnapshot) {
+                DBManager::instance()->saveDirSnapshot(snapshotKey, current);
             }
-            importAllImagesAndVideos(urls, -1, false);
-            insertImportIntoAlbum(uid, urls);
+            continue;
         }
+        QStringList urls;
+        for (QString path : currentPaths) {
+            urls << QUrl::fromLocalFile(path).toString();
+        }
+        ImportImagesThread *imagesthread = new ImportImagesThread;
+        imagesthread->setData(urls, -1);
+        imagesthread->setNotifyUI(false);
+        if (useSnapshot) {
+            connect(imagesthread, &ImportImagesThread::sigImportCommitted, this, [snapshotKey, current]() {
+                DBManager::instance()->saveDirSnapshot(snapshotKey, current);
+            }, Qt::DirectConnection);
+        }
+        QThreadPool::globalInstance()->start(imagesthread);
+        insertImportIntoAlbum(uid, urls);
     }
     QStringList pathlist = DBManager::instance()->getAllPaths();
-    QStringList needDeletes ;
-    for (QString path : pathlist) {
-        if (!QFileInfo(path).exists()) {
-            needDeletes << path;
+    QStringList needDeletes = findMissingPaths(pathlist);
+    DBManager::instance()->removeImgInfos(needDeletes);
+}
+
+/**
+   @brief 目录修改时间未变说明其中的目录项未增删，上次检查时存在的文件及之后导入该目录的文件都仍然存在，
+    因此只需对每个目录获取一次状态，仅对修改时间变化的目录逐个检查文件
+   @return 已不存在的文件
+ */
+QStringList AlbumControl::findMissingPaths(const QStringList &paths)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    //按所在目录分组
+    QHash<QString, QStringList> dirs;
+    for (const QString &path : paths) {
+        dirs[path.left(path.lastIndexOf('/'))] << path;
+    }
+
+    const LibUnionImage_NameSpace::DirSnapshot previous = DBManager::instance()->getDirSnapshot(librarySnapshotKey);
+    LibUnionImage_NameSpace::DirSnapshot current;
+    QStringList missing;
+    int changedCount = 0;
+    for (auto itr = dirs.constBegin(); itr != dirs.constEnd(); ++itr) {
+        qint64 modifyTime = LibUnionImage_NameSpace::dirModifyTime(itr.key());
+        //目录已不存在
+        if (modifyTime < 0) {
+            missing << itr.value();
+            continue;
+        }
+
+        //FAT/exFAT 上目录修改时间不可靠，记录为 0 ，每次逐个检查其中的文件
+        if (modifyTime > 0 && !DeviceScanCache::reliableDirModifyTime(itr.key())) {
+            modifyTime = 0;
+        }
+        current[itr.key()].modifyTime = modifyTime;
+        if (modifyTime > 0 && previous.value(itr.key()).modifyTime == modifyTime) {
+            continue;
+        }
+
+        changedCount++;
+        for (const QString &path : itr.value()) {
+            if (!QFileInfo::exists(path)) {
+                missing << path;
+            }
         }
     }
-    DBManager::instance()->removeImgInfos(needDeletes);
+
+    DBManager::instance()->saveDirSnapshot(librarySnapshotKey, current);
+    qInfo() << "Checked" << paths.size() << "files in" << dirs.size() << "directories, changed:" << changedCount
+            << "missing:" << missing.size() << "elapsed(ms):" << timer.elapsed();
+    return missing;
+}
+
+void AlbumControl::resumeImportJobs()
+{
+    const ImportJobInfoList jobs = DBManager::instance()->getImportJobs();
+    for (const ImportJobInfo &job : jobs) {
+        //目标相册已删除，不再恢复
+        if (job.UID > 0 && TypeCount == DBManager::instance()->getAlbumDBTypeFromUID(job.UID)) {
+            qWarning() << "Album of import job" << job.jobID << "no longer exists, dropping job";
+            DBManager::instance()->removeImportJob(job.jobID);
+            continue;
+        }
+
+        qInfo() << "Resuming import job" << job.jobID << "committed files:" << job.cursor;
+        emit sigImportStart();
+        ImportImagesThread *imagesthread = new ImportImagesThread;
+        imagesthread->setJob(job);
+        QThreadPool::globalInstance()->start(imagesthread);
+    }
 }
 
 bool AlbumControl::checkIfNotified(const QString &dirPath)
@@ -783,6 +981,16 @@ bool AlbumControl::checkIfNotified(const QString &dirPath)
 
 void AlbumControl::slotMonitorChanged(QStringList fileAdd, QStringList fileDelete, QString album, int UID)
 {
+    //文件增删后清除缩略图加载使用的文件状态缓存
+    ImageDataService::instance()->invalidateFileStats(fileAdd);
+    ImageDataService::instance()->invalidateFileStats(fileDelete);
+    //修改(重新上报为新增)或删除的矢量图释放其光栅化缓存
+    for (const QString &path : fileAdd + fileDelete) {
+        if (SvgRasterCache::isSvgFile(path)) {
+            SvgRasterCache::instance()->remove(path);
+        }
+    }
+
     //直接删除图片
     DBManager::instance()->removeImgInfos(fileDelete);
     AlbumDBType atype = AlbumDBType::AutoImport;
@@ -903,6 +1111,8 @@ void AlbumControl::onUnMountedExecute(const QString &deviceKey, DeviceType type)
         return;
 
     QString mountPoint = DeviceHelper::instance()->getMountPointByDeviceId(deviceKey);;
+    //设备已移除，停止从该设备复制导入
+    stopDeviceImports(mountPoint);
     QString strPath = mountPoint;
     if (!strPath.contains("/media/")) {
         findPicturePathByPhone(strPath);
@@ -912,12 +1122,27 @@ void AlbumControl::onUnMountedExecute(const QString &deviceKey, DeviceType type)
 
     DeviceHelper::instance()->loadAllDeviceInfos();
 
-    if (m_PhonePicFileMap.contains(strPath))
-        m_PhonePicFileMap.remove(strPath);
+    removeDeviceAlbumInfo(strPath);
 
     emit sigMountsChange();
 }
 
+void AlbumControl::stopDeviceImports(const QString &mountPoint)
+{
+    if (mountPoint.isEmpty()) {
+        return;
+    }
+
+    const QString prefix = mountPoint.endsWith('/') ? mountPoint : mountPoint + '/';
+    QMutexLocker locker(&m_deviceCopyMutex);
+    for (auto itr = m_deviceCopyEngines.constBegin(); itr != m_deviceCopyEngines.constEnd(); ++itr) {
+        if (itr.key().startsWith(prefix)) {
+            qInfo() << "Stopping import from unmounted device:" << mountPoint;
+            itr.value()->stop();
+        }
+    }
+}
+
 QJsonObject AlbumControl::createShorcutJson()
 {
     //Translations
@@ -1392,25 +1617,10 @@ bool AlbumControl::addCustomAlbumInfos(int albumId, const QList<QUrl> &urls)
     QStringList curAlbumImgPathList = getAllUrlPaths();
     for (QString imagePath : localpaths) {
         if (QDir(imagePath).exists()) {
-            //获取所选文件类型过滤器
-            QStringList filters;
-            for (QString i : LibUnionImage_NameSpace::unionImageSupportFormat()) {
-                filters << "*." + i;
-            }
-
-            for (QString i : LibUnionImage_NameSpace::videoFiletypes()) {
-                filters << "*." + i;
-            }
-            //定义迭代器并设置过滤器，包括子目录：QDirIterator::Subdirectories
-            QDirIterator dir_iterator(imagePath,
-                                      filters,
-                                      QDir::Files/* | QDir::NoSymLinks*/,
-                                      QDirIterator::Subdirectories);
+            //按扩展名遍历目录及子目录中的图片和视频
             QList<QUrl> allfiles;
-            while (dir_iterator.hasNext()) {
-                dir_iterator.next();
-                QFileInfo fileInfo = dir_iterator.fileInfo();
-                allfiles << "file://" + fileInfo.filePath();
+            for (const QString &filePath : LibUnionImage_NameSpace::walkMediaFiles(imagePath)) {
+                allfiles << "file://" + filePath;
             }
             if (!allfiles.isEmpty()) {
                 addCustomAlbumInfos(albumId, allfiles);
@@ -2188,12 +2398,16 @@ QString AlbumControl::getMovieInfo(const QString key, const QString &path)
     QString value = "";
     if (!path.isEmpty()) {
         QString localPath = url2localPath(path);
-        if (!m_movieInfos.keys().contains(localPath)) {
+        QMutexLocker locker(&m_movieInfosMutex);
+        if (!m_movieInfos.contains(localPath)) {
+            locker.unlock();
             MovieInfo movieInfo = MovieService::instance()->getMovieInfo(QUrl::fromLocalFile(localPath));
             //对视频信息缓存
+            locker.relock();
             m_movieInfos[localPath] = movieInfo;
         }
         MovieInfo movieInfo = m_movieInfos.value(localPath);
+        locker.unlock();
         if (QString("Video CodecID").contains(key)) {
             value = movieInfo.vCodecID;
         } else if (QString("Video CodeRate").contains(key)) {
@@ -2309,49 +2523,78 @@ void AlbumControl::loadDeviceAlbumInfoAsync(const QString &devicePath)
         return;
     }
 
-    m_PhonePicFileMap.insert(devicePath, nullptr);
+    DeviceInfoPtr devicePtr = DeviceInfoPtr::create();
+    m_PhonePicFileMap.insert(devicePath, devicePtr);
     QThreadPool::globalInstance()->start([=](){
         // Notify load device info
         Q_EMIT deviceAlbumInfoLoadStart(devicePath);
 
-        //获取所选文件类型过滤器
-        QStringList filters;
-        for (QString i : LibUnionImage_NameSpace::unionImageSupportFormat()) {
-            filters << "*." + i;
-        }
-        for (QString i : LibUnionImage_NameSpace::videoFiletypes()) {
-            filters << "*." + i;
-        }
-
-        //定义迭代器并设置过滤器，包括子目录：QDirIterator::Subdirectories
-        QDirIterator dir_iterator(devicePath,
-                                  filters,
-                                  QDir::Files/* | QDir::NoSymLinks*/,
-                                  QDirIterator::Subdirectories);
-
-        DeviceInfoPtr devicePtr = DeviceInfoPtr::create();
-        while (dir_iterator.hasNext()) {
-            dir_iterator.next();
-
-            ItemType type;
-            QString filePath = dir_iterator.filePath();
-            if (LibUnionImage_NameSpace::isImage(filePath)) {
-                type = ItemTypePic;
-                devicePtr->picCount++;
-            } else if (LibUnionImage_NameSpace::isVideo(filePath)) {
-                type = ItemTypeVideo;
-                devicePtr->videoCount++;
-            } else {
-                continue;
+        //设备曾经扫描过时，修改时间未变的目录直接使用上次的快照；目录修改时间不可靠的文件系统每次完整读取
+        const QString uuid = DeviceScanCache::instance()->deviceKey(devicePath);
+        const bool useSnapshot = !uuid.isEmpty() && DeviceScanCache::reliableDirModifyTime(devicePath);
+        const LibUnionImage_NameSpace::DirSnapshot previous = useSnapshot ? DeviceScanCache::instance()->snapshot(uuid)
+                                                                          : LibUnionImage_NameSpace::DirSnapshot();
+        LibUnionImage_NameSpace::DirSnapshot current;
+        QStringList foundPaths;  // 设备上的全部文件，用于清理缩略图缓存
+
+        //按扩展名并行遍历设备目录，不读取文件内容，每发现一批文件即通知界面追加
+        const bool finished = LibUnionImage_NameSpace::walkMediaFilesBatched(devicePath, [=, &foundPaths](const QStringList &filePaths) {
+            if (devicePtr->cancelled.loadRelaxed()) {
+                return false;
+            }
+            foundPaths << filePaths;
+
+            //按扩展名区分图片和视频，文件内容在加载缩略图时再解析
+            QMap<QString, ItemType> batch;
+            for (const QString &filePath : filePaths) {
+                if (LibUnionImage_NameSpace::imageSupportRead(filePath)) {
+                    batch.insert(filePath, ItemTypePic);
+                } else if (LibUnionImage_NameSpace::isVideo(filePath)) {
+                    batch.insert(filePath, ItemTypeVideo);
+                }
             }
 
-            devicePtr->fileTypeMap.insert(filePath, type);
+            // GUI thread, merge and notify batch
+            QMetaObject::invokeMethod(qApp, [=](){
+                // 设备已卸载
+                if (m_PhonePicFileMap.value(devicePath) != devicePtr) {
+                    return;
+                }
+
+                for (auto itr = batch.begin(); itr != batch.end(); ++itr) {
+                    if (devicePtr->fileTypeMap.contains(itr.key())) {
+                        continue;
+                    }
+                    devicePtr->fileTypeMap.insert(itr.key(), itr.value());
+                    if (ItemTypePic == itr.value()) {
+                        devicePtr->picCount++;
+                    } else {
+                        devicePtr->videoCount++;
+                    }
+                }
+
+                Q_EMIT deviceAlbumInfoBatchLoaded(devicePath, fromDeviceAlbumInfoList(batch, ItemTypeNull));
+                Q_EMIT deviceAlbumInfoCountChanged(devicePath, devicePtr->picCount, devicePtr->videoCount);
+            }, Qt::QueuedConnection);
+            return true;
+        }, true, useSnapshot ? &previous : nullptr, useSnapshot ? &current : nullptr);
+
+        //仅保存完整扫描的快照，并按扫描结果清理缩略图缓存
+        if (finished && !uuid.isEmpty()) {
+            if (useSnapshot) {
+                DeviceScanCache::instance()->save(uuid, current);
+            }
+            DeviceScanCache::instance()->prune(devicePath, foundPaths);
         }
 
         // GUI thread, notify update data
         QMetaObject::invokeMethod(qApp, [=](){
-                m_PhonePicFileMap.insert(devicePath, devicePtr);
-                
+                if (m_PhonePicFileMap.value(devicePath) != devicePtr) {
+                    qDebug() << "Device scan cancelled:" << devicePath;
+                    return;
+                }
+                devicePtr->loading = false;
+
                 Q_EMIT deviceAlbumInfoLoadFinished(devicePath);
                 Q_EMIT deviceAlbumInfoCountChanged(devicePath, devicePtr->picCount, devicePtr->videoCount);
             }, Qt::QueuedConnection);
@@ -2361,20 +2604,18 @@ void AlbumControl::loadDeviceAlbumInfoAsync(const QString &devicePath)
 DBImgInfoList AlbumControl::getDeviceAlbumInfoList(const QString &devicePath, const int &filterType, bool *loading)
 {
     auto itr = m_PhonePicFileMap.find(devicePath);
-    if (itr != m_PhonePicFileMap.end()) {
-        DeviceInfoPtr devicePtr = *(itr);
-        if (!devicePtr.isNull()) {
-            return fromDeviceAlbumInfoList(devicePtr->fileTypeMap, filterType);
-        }
+    if (itr == m_PhonePicFileMap.end()) {
+        // Not load before, mark current device loading.
+        loadDeviceAlbumInfoAsync(devicePath);
+        itr = m_PhonePicFileMap.find(devicePath);
     }
 
-    // Not load before, mark current device loading.
-    loadDeviceAlbumInfoAsync(devicePath);
-
+    // 扫描中返回已发现的部分，其余通过 deviceAlbumInfoBatchLoaded 追加
+    DeviceInfoPtr devicePtr = *(itr);
     if (loading) {
-        *loading = true;
+        *loading = devicePtr->loading;
     }
-    return {};
+    return fromDeviceAlbumInfoList(devicePtr->fileTypeMap, filterType);
 }
 
 void AlbumControl::getDeviceAlbumInfoCountAsync(const QString &devicePath)
@@ -2382,15 +2623,23 @@ void AlbumControl::getDeviceAlbumInfoCountAsync(const QString &devicePath)
     auto itr = m_PhonePicFileMap.find(devicePath);
     if (itr != m_PhonePicFileMap.end()) {
         DeviceInfoPtr devicePtr = *(itr);
-        if (!devicePtr.isNull()) {
-            Q_EMIT deviceAlbumInfoCountChanged(devicePath, devicePtr->picCount, devicePtr->videoCount);
-        }
+        Q_EMIT deviceAlbumInfoCountChanged(devicePath, devicePtr->picCount, devicePtr->videoCount);
+        return;
     }
 
-    // Not load before, mark current device loading.
+    // Not load before, mark current device loading. 扫描过程中按批通知数量
     loadDeviceAlbumInfoAsync(devicePath);
 }
 
+void AlbumControl::removeDeviceAlbumInfo(const QString &devicePath)
+{
+    DeviceInfoPtr devicePtr = m_PhonePicFileMap.take(devicePath);
+    if (devicePtr) {
+        devicePtr->cancelled.storeRelaxed(1);
+    }
+    DeviceScanCache::instance()->forget(devicePath);
+}
+
 QList<int> AlbumControl::getPicVideoCountFromPaths(const QStringList &paths, const QString &devicePath)
 {
     if (paths.isEmpty()) {
@@ -2437,8 +2686,6 @@ void AlbumControl::importFromMountDevice(const QStringList &paths, const int &in
         {
             localPaths << url2localPath(path);
         }
-        QStringList newPathList;
-        DBImgInfoList dbInfos;
         QString strHomePath = QDir::homePath();
         //获取系统现在的时间
         QString strDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
@@ -2448,6 +2695,7 @@ void AlbumControl::importFromMountDevice(const QStringList &paths, const int &in
         {
             dir.mkpath(basePath);
         }
+        QList<FileCopyEngine::Task> tasks;
         for (QString strPath : localPaths)
         {
             //取出文件名称
@@ -2455,48 +2703,59 @@ void AlbumControl::importFromMountDevice(const QStringList &paths, const int &in
             QStringList nameList = pathList.last().split(".", Qt::SkipEmptyParts);
             QString strNewPath = QString("%1%2%3%4%5%6").arg(basePath, "/", nameList.first(),
                                                              QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()), ".", nameList.last());
-            //判断新路径下是否存在目标文件，若不存在，继续循环
+            //判断源文件是否存在，若不存在，继续循环
             if (!dir.exists(strPath)) {
                 continue;
             }
-            //判断新路径下是否存在目标文件，若存在，先删除掉
-            if (dir.exists(strNewPath)) {
-                dir.remove(strNewPath);
-            }
-            newPathList << strNewPath;
-            QFileInfo fi(strNewPath);
-            //复制失败的图片不算在成功导入
-            if (QFile::copy(strPath, strNewPath)) {
-                dbInfos << getDBInfo(strNewPath, LibUnionImage_NameSpace::isVideo(strNewPath));
-            } else {
-                newPathList.removeOne(strNewPath);
-            }
+            //同名文件在同一毫秒内生成的目标路径相同，复制时以独占方式创建目标文件，已存在时追加序号
+            tasks << FileCopyEngine::Task { strPath, strNewPath };
+        }
+        if (tasks.isEmpty()) {
+            return;
+        }
 
+        //并行复制，按字节报告进度，复制失败或校验失败的图片不算在成功导入
+        //复制期间登记复制任务，设备卸载时停止复制
+        emit sigImportStart();
+        FileCopyEngine engine;
+        connect(&engine, &FileCopyEngine::progressChanged, this, &AlbumControl::sigImportBytesProgress, Qt::DirectConnection);
+        const QString sourceKey = tasks.first().source;
+        {
+            QMutexLocker locker(&m_deviceCopyMutex);
+            m_deviceCopyEngines.insert(sourceKey, &engine);
         }
-        if (!dbInfos.isEmpty())
+        const QStringList newPathList = engine.copy(tasks);
         {
-            QStringList pathslist;
-            int idblen = dbInfos.length();
-            for (int i = 0; i < idblen; i++) {
-                if (m_bneedstop) {
-                    return;
-                }
-                pathslist << dbInfos[i].filePath;
-            }
-
+            QMutexLocker locker(&m_deviceCopyMutex);
+            m_deviceCopyEngines.remove(sourceKey, &engine);
+        }
 
+        //停止导入时已读取信息的文件照常写入，始终发送完成或失败信号
+        DBImgInfoList dbInfos;
+        QStringList importedPaths;
+        for (const QString &strNewPath : newPathList) {
+            if (m_bneedstop) {
+                break;
+            }
+            dbInfos << getDBInfo(strNewPath, LibUnionImage_NameSpace::isVideo(strNewPath));
+            importedPaths << strNewPath;
+        }
+        if (!dbInfos.isEmpty())
+        {
             DBManager::instance()->insertImgInfos(dbInfos);
             if (index > 0) {
-                DBManager::instance()->insertIntoAlbum(index, pathslist);
+                DBManager::instance()->insertIntoAlbum(index, importedPaths);
                 emit sigRefreshCustomAlbum(index);
             }
             emit sigRefreshImportAlbum();
             emit sigRefreshAllCollection();
+            emit sigImportFinished();
+        } else {
+            emit sigImportFailed(tasks.size());
         }
     });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
     thread->start();
-    connect(thread, &QThread::destroyed, thread, &QObject::deleteLater);
-
 }
 
 QString AlbumControl::getYearCoverPath(const QString &year)
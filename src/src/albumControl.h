@@ -6,6 +6,8 @@
 #define AlbumControl_H
 
 #include <QObject>
+#include <QMutex>
+#include <QHash>
 #include <QUrl>
 #include "unionimage/unionimage.h"
 #include "dbmanager/dbmanager.h"
@@ -15,6 +17,7 @@
 using namespace dfmmount;
 
 class FileInotifyGroup;
+class FileCopyEngine;
 
 class AlbumControl : public QObject
 {
@@ -54,6 +57,9 @@ public:
     //获得全部导入的路径
     Q_INVOKABLE QVariantList getAlbumAllInfos(const int &filterType = 0);
 
+    //查询内容相同的重复文件分组，需逐字节比较文件，在后台线程执行，通过 sigDuplicateUrlGroups 返回结果
+    Q_INVOKABLE void requestDuplicateUrlGroups();
+
     //导入图片，导入图片接口
     Q_INVOKABLE bool importAllImagesAndVideos(const QStringList &paths, const int UID = -1, const bool notifyUI = true);
 
@@ -248,6 +254,8 @@ public:
     DBImgInfoList getDeviceAlbumInfoList(const QString &devicePath, const int &filterType = 0, bool *loading = nullptr);
     Q_SIGNAL void deviceAlbumInfoLoadStart(const QString &devicePath);
     Q_SIGNAL void deviceAlbumInfoLoadFinished(const QString &devicePath);
+    // 扫描过程中新发现的一批文件，已合并至设备数据
+    Q_SIGNAL void deviceAlbumInfoBatchLoaded(const QString &devicePath, const DBImgInfoList &infos);
 
     Q_INVOKABLE void getDeviceAlbumInfoCountAsync(const QString &devicePath);
     Q_SIGNAL void deviceAlbumInfoCountChanged(const QString &devicePath, int picCount, int videoCount);
@@ -358,6 +366,12 @@ public:
     //启动路径监控
     void startMonitor();
 
+    //找出数据库中已不存在的文件，只检查修改时间变化的目录
+    QStringList findMissingPaths(const QStringList &paths);
+
+    //恢复上次未完成的导入任务，需在界面加载完成后调用
+    void resumeImportJobs();
+
     //是否已经处于监控
     bool checkIfNotified(const QString &dirPath);
 
@@ -395,6 +409,10 @@ private:
     void getAllBlockDeviceName();
     void updateBlockDeviceName(const QString &blks);
     void onUnMountedExecute(const QString &deviceKey, DeviceType type);
+    //取消设备扫描并移除设备数据
+    void removeDeviceAlbumInfo(const QString &devicePath);
+    //停止从挂载点 \a mountPoint 复制导入的任务，未完成的文件被删除
+    void stopDeviceImports(const QString &mountPoint);
 
 signals:
     void sigRefreshAllCollection();
@@ -406,6 +424,8 @@ signals:
     void sigImportStart();
     //导入进度信号
     void sigImportProgress(int value, int max = 100);
+    //按字节的导入进度信号，bytesPerSecond 为平均复制速度
+    void sigImportBytesProgress(qint64 copiedBytes, qint64 totalBytes, qint64 bytesPerSecond);
     //导入完成信号
     void sigImportFinished();
     //导入失败
@@ -428,6 +448,9 @@ signals:
 
     void sigRepeatUrls(const QStringList &urls);
 
+    //重复文件分组查询完成，每组为内容相同的 url 路径列表
+    void sigDuplicateUrlGroups(const QVariantList &groups);
+
     //发送打开看图查看图片信号
     void sigOpenImageFromFiles(const QStringList &paths);
 
@@ -451,6 +474,7 @@ private :
     QMap < QString, DBImgInfoList > m_dayDateMap; //日数据集
     QMap < int, QString > m_customAlbum; //自定义相册
     QMap < QString, MovieInfo> m_movieInfos; //movieInfo的合集
+    QMutex m_movieInfosMutex; //导入时多线程获取文件信息，保护 m_movieInfos
 
     FileInotifyGroup *m_fileInotifygroup {nullptr}; //固定文件夹监控
 
@@ -463,12 +487,16 @@ private :
         int picCount{0};
         int videoCount{0};
         QMap<QString, ItemType> fileTypeMap;
+        bool loading{true};     // 是否正在扫描，以上数据仅在主线程中访问
+        QAtomicInt cancelled;   // 设备卸载时取消扫描
     };
     using DeviceInfoPtr = QSharedPointer<DeviceInfo>;
     QMap<QString, DeviceInfoPtr> m_PhonePicFileMap;   // 外部设备及其全部图片路径
     std::atomic_bool m_couldRun;
     bool m_bneedstop = false;
     QMutex m_mutex;
+    QMultiHash<QString, FileCopyEngine *> m_deviceCopyEngines; // 正在执行的设备导入复制 QMultiHash<首个源文件路径, 复制引擎>
+    QMutex m_deviceCopyMutex; // 保护 m_deviceCopyEngines
 };
 
 #endif // AlbumControl_H
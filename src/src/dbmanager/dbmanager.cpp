@@ -4,6 +4,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "dbmanager.h"
+#include "formatsniffcache.h"
+#include "importbatch.h"
 //#include "application.h"
 //#include "controller/signalmanager.h"
 #include "unionimage/baseutils.h"
@@ -12,8 +14,10 @@
 #include "unionimage/unionimage_global.h"
 #include "../albumControl.h"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -23,6 +27,11 @@
 
 //#include "imageengineapi.h"
 
+// 补充内容标识时每批读取的文件数
+static const int s_backfillBatchSize = 200;
+// 格式嗅探缓存表保留的最大记录数
+static const int s_maxFormatCacheRows = 100000;
+
 DBManager *DBManager::m_dbManager = nullptr;
 std::once_flag DBManager::instanceFlag;
 QReadWriteLock DBManager::m_fileMutex;
@@ -159,6 +168,155 @@ const DBImgInfoList DBManager::getAllInfosByUID(QString UID) const
     return infos;
 }
 
+/**
+   @return 导入标识为 \a UID 的所有文件路径集合，用于导入时以哈希查找过滤已导入的文件
+ */
+const QSet<QString> DBManager::getPathSetByUID(const QString &UID) const
+{
+    QMutexLocker mutex(&m_dbMutex);
+    QSet<QString> paths;
+    m_query->setForwardOnly(true);
+    bool b = m_query->prepare("SELECT FilePath FROM ImageTable3 WHERE UID = :UID");
+    m_query->bindValue(":UID", UID);
+
+    if (!b || !m_query->exec()) {
+        qWarning() << "Failed to query paths by UID:" << UID << m_query->lastError().text();
+        return paths;
+    }
+    while (m_query->next()) {
+        paths.insert(m_query->value(0).toString());
+    }
+    return paths;
+}
+
+/**
+   @return 文件大小为 \a fileSize 且内容标识为 \a contentHash 的已导入文件路径，内容是否相同需调用方逐字节确认
+ */
+const QStringList DBManager::getPathsByContent(qint64 fileSize, quint64 contentHash) const
+{
+    QStringList paths;
+    if (0 == contentHash) {
+        return paths;
+    }
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    bool b = m_query->prepare("SELECT DISTINCT FilePath FROM ImageTable3 WHERE FileSize = :FileSize AND ContentHash = :ContentHash");
+    m_query->bindValue(":FileSize", fileSize);
+    m_query->bindValue(":ContentHash", static_cast<qint64>(contentHash));
+    if (!b || !m_query->exec()) {
+        qWarning() << "Failed to query paths by content:" << m_query->lastError().text();
+        return paths;
+    }
+    while (m_query->next()) {
+        paths << m_query->value(0).toString();
+    }
+    return paths;
+}
+
+/**
+   @brief 为内容标识字段添加前导入的记录补充文件大小和内容标识，分批读取文件，读取期间不持有数据库锁。
+        无法读取的文件将文件大小记为 -1 ，不再重复处理
+ */
+void DBManager::backfillContentHash()
+{
+    QElapsedTimer timer;
+    timer.start();
+    int total = 0;
+    forever {
+        QStringList paths;
+        QMutexLocker mutex(&m_dbMutex);
+        m_query->setForwardOnly(true);
+        if (!m_query->exec(QString("SELECT DISTINCT FilePath FROM ImageTable3 WHERE ContentHash = 0 AND FileSize >= 0 LIMIT %1")
+                           .arg(s_backfillBatchSize))) {
+            qWarning() << "Failed to query rows without content hash:" << m_query->lastError().text();
+            return;
+        }
+        while (m_query->next()) {
+            paths << m_query->value(0).toString();
+        }
+        mutex.unlock();
+
+        if (paths.isEmpty()) {
+            break;
+        }
+
+        QList<std::pair<qint64, quint64>> contents;
+        for (const QString &path : paths) {
+            const quint64 hash = Libutils::base::contentHash(path);
+            contents.append(std::make_pair(0 == hash ? -1 : QFileInfo(path).size(), hash));
+        }
+
+        mutex.relock();
+        if (!m_query->exec("BEGIN IMMEDIATE TRANSACTION")) {
+            qWarning() << "Failed to begin transaction:" << m_query->lastError().text();
+            return;
+        }
+        if (!m_query->prepare("UPDATE ImageTable3 SET FileSize = :FileSize, ContentHash = :ContentHash "
+                              "WHERE FilePath = :FilePath AND ContentHash = 0")) {
+            qWarning() << "Failed to prepare update statement:" << m_query->lastError().text();
+            m_query->exec("ROLLBACK");
+            return;
+        }
+        int updated = 0;
+        for (int i = 0; i < paths.size(); ++i) {
+            m_query->bindValue(":FileSize", contents.at(i).first);
+            m_query->bindValue(":ContentHash", static_cast<qint64>(contents.at(i).second));
+            m_query->bindValue(":FilePath", paths.at(i));
+            if (m_query->exec()) {
+                ++updated;
+            } else {
+                qWarning() << "Failed to update content hash:" << paths.at(i) << m_query->lastError().text();
+            }
+        }
+        if (!m_query->exec("COMMIT")) {
+            qWarning() << "Failed to commit transaction:" << m_query->lastError().text();
+            return;
+        }
+        // 整批更新失败时停止，避免重复查询到同一批记录
+        if (0 == updated) {
+            return;
+        }
+        total += paths.size();
+    }
+
+    if (total > 0) {
+        qInfo() << "Backfilled content hash for" << total << "files, elapsed(ms):" << timer.elapsed();
+    }
+}
+
+/**
+   @return 内容标识相同的已导入文件分组，每组至少包含两个文件路径
+ */
+const QList<QStringList> DBManager::getDuplicateGroups() const
+{
+    QList<QStringList> groups;
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->exec("SELECT DISTINCT i.FileSize, i.ContentHash, i.FilePath FROM ImageTable3 AS i "
+                       "INNER JOIN (SELECT FileSize, ContentHash FROM ImageTable3 WHERE ContentHash != 0 "
+                       "GROUP BY FileSize, ContentHash HAVING COUNT(DISTINCT FilePath) > 1) AS d "
+                       "ON i.FileSize = d.FileSize AND i.ContentHash = d.ContentHash "
+                       "ORDER BY i.FileSize, i.ContentHash")) {
+        qWarning() << "Failed to query duplicate groups:" << m_query->lastError().text();
+        return groups;
+    }
+
+    qint64 lastSize = -1;
+    qint64 lastHash = 0;
+    while (m_query->next()) {
+        const qint64 fileSize = m_query->value(0).toLongLong();
+        const qint64 contentHash = m_query->value(1).toLongLong();
+        if (groups.isEmpty() || fileSize != lastSize || contentHash != lastHash) {
+            groups.append(QStringList());
+            lastSize = fileSize;
+            lastHash = contentHash;
+        }
+        groups.last() << m_query->value(2).toString();
+    }
+    return groups;
+}
+
 const QList<QDateTime> DBManager::getAllTimelines() const
 {
     QMutexLocker mutex(&m_dbMutex);
@@ -301,27 +459,7 @@ void DBManager::insertImgInfos(const DBImgInfoList &infos)
         return;
     }
 
-    QString qs("REPLACE INTO ImageTable3 (PathHash, FilePath, FileName, Time, "
-               "ChangeTime, ImportTime, FileType, UID) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-
-    if (!m_query->prepare(qs)) {
-        qWarning() << "Failed to prepare insert statement:" << m_query->lastError().text();
-        return;
-    }
-
-    for (const auto &info : infos) {
-        m_query->addBindValue(LibUnionImage_NameSpace::hashByString(info.filePath));
-        m_query->addBindValue(info.filePath);
-        m_query->addBindValue(info.getFileNameFromFilePath());
-        m_query->addBindValue(info.time);
-        m_query->addBindValue(info.changeTime);
-        m_query->addBindValue(info.importTime);
-        m_query->addBindValue(info.itemType);
-        m_query->addBindValue(info.albumUID);
-        if (!m_query->exec()) {
-            qWarning() << "Failed to insert image:" << info.filePath << m_query->lastError().text();
-        }
-    }
+    ImportBatch::writeImgInfos(*m_query, infos);
 
     if (!m_query->exec("COMMIT")) {
         qWarning() << "Failed to commit transaction:" << m_query->lastError().text();
@@ -339,6 +477,9 @@ void DBManager::removeImgInfos(const QStringList &paths)
 
     qInfo() << "Removing" << paths.size() << "images from database";
 
+    // 同时清理文件格式嗅探缓存
+    FormatSniffCache::instance()->remove(paths);
+
     // Collect info before removing data
     QStringList pathHashs;
     std::transform(paths.begin(), paths.end(), std::back_inserter(pathHashs), [](const QString & path) {
@@ -399,11 +540,15 @@ void DBManager::removeImgInfos(const QStringList &paths)
 
 void DBManager::removeImgInfosNoSignal(const QStringList &paths)
 {
-    QMutexLocker mutex(&m_dbMutex);
     if (paths.isEmpty()) {
         return;
     }
 
+    // 同时清理文件格式嗅探缓存
+    FormatSniffCache::instance()->remove(paths);
+
+    QMutexLocker mutex(&m_dbMutex);
+
     // Collect info before removing data
     QStringList pathHashs;
     for (QString path : paths) {
@@ -866,15 +1011,7 @@ int DBManager::createAlbum(const QString &album, const QStringList &paths, Album
     if (!m_query->exec("COMMIT")) {
     }
 
-    //FIXME: Don't insert the repeated filepath into the same album
-    //Delete the same data
-    QString ps = "DELETE FROM AlbumTable3 where AlbumId NOT IN"
-                 "(SELECT min(AlbumId) FROM AlbumTable3 GROUP BY"
-                 " UID, PathHash, AlbumDBType) AND PathHash != \"%1\""
-                 " AND AlbumDBType =%2 ";
-    if (!m_query->exec(ps.arg(EMPTY_HASH_STR).arg(atype))) {
-        //   qDebug() << "delete same date failed!";
-    }
+    ImportBatch::removeDuplicateAlbumRows(*m_query, atype, EMPTY_HASH_STR);
 
     //把当前UID传出去
     return currentUID;
@@ -896,32 +1033,18 @@ bool DBManager::insertIntoAlbum(int UID, const QStringList &paths, AlbumDBType a
     if (!m_query->exec("BEGIN IMMEDIATE TRANSACTION")) {
     }
 
-    QString qs = QString("REPLACE INTO AlbumTable3 (AlbumId, AlbumName, AlbumDBType, UID, PathHash)"
-                         " VALUES (null, \"%1\", %2, %3, ?)")
-                 .arg(album).arg(atype).arg(UID);
-    if (!m_query->prepare(qs)) {
-    }
+    QStringList existPaths;
     for (auto &eachPath : paths) {
         if (QFile::exists(eachPath)) { //需要路径存在才能执行添加到相册
-            m_query->addBindValue(LibUnionImage_NameSpace::hashByString(eachPath));
-            if (!m_query->exec()) {
-            }
+            existPaths << eachPath;
         }
     }
+    ImportBatch::writeAlbumPaths(*m_query, album, UID, atype, existPaths);
+    ImportBatch::removeDuplicateAlbumRows(*m_query, atype, EMPTY_HASH_STR);
 
     if (!m_query->exec("COMMIT")) {
     }
 
-    //FIXME: Don't insert the repeated filepath into the same album
-    //Delete the same data
-    QString ps = "DELETE FROM AlbumTable3 where AlbumId NOT IN"
-                 "(SELECT min(AlbumId) FROM AlbumTable3 GROUP BY"
-                 " UID, PathHash, AlbumDBType) AND PathHash != \"%1\""
-                 " AND AlbumDBType = %2 ";
-    if (!m_query->exec(ps.arg(EMPTY_HASH_STR).arg(atype))) {
-        //   qDebug() << "delete same date failed!";
-    }
-
     mutex.unlock();
 
     //发信号通知上层
@@ -930,11 +1053,24 @@ bool DBManager::insertIntoAlbum(int UID, const QStringList &paths, AlbumDBType a
     return true;
 }
 
+/**
+   @brief 删除相册 \a UID 的监控目录(monitor/)及自定义自动导入目录(custom/)快照，调用方持有数据库锁
+ */
+static void removeAlbumDirSnapshots(QSqlQuery &query, int UID)
+{
+    //快照键为前缀 + UID + 目录绝对路径
+    const QString qs = QString("DELETE FROM DirSnapshotTable3 WHERE Key LIKE \"monitor/%1/%\" OR Key LIKE \"custom/%1/%\"").arg(UID);
+    if (!query.exec(qs)) {
+        qWarning() << "Failed to remove dir snapshots of album:" << UID << query.lastError().text();
+    }
+}
+
 void DBManager::removeAlbum(int UID)
 {
     QMutexLocker mutex(&m_dbMutex);
     if (!m_query->exec(QString("DELETE FROM AlbumTable3 WHERE UID=") + QString::number(UID))) {
     }
+    removeAlbumDirSnapshots(*m_query, UID);
 }
 
 void DBManager::removeFromAlbum(int UID, const QStringList &paths, AlbumDBType atype)
@@ -1303,6 +1439,9 @@ void DBManager::removeCustomAutoImportPath(int UID)
     if (!m_query->exec(QString("DELETE FROM AlbumTable3 WHERE UID=") + QString::number(UID))) {
     }
 
+    //4.删除目录快照
+    removeAlbumDirSnapshots(*m_query, UID);
+
     if (!m_query->exec("COMMIT")) {
     }
 
@@ -1385,6 +1524,8 @@ void DBManager::checkDatabase()
                                    "FileType INTEGER, "
                                    "DataHash TEXT, "
                                    "UID TEXT, "
+                                   "FileSize INTEGER default 0, "
+                                   "ContentHash INTEGER default 0, "
                                    "primary key(PathHash, UID))"));
     if (!b) {
         qWarning() << "Failed to create ImageTable3:" << m_query->lastError().text();
@@ -1437,6 +1578,66 @@ void DBManager::checkDatabase()
         qWarning() << "Failed to create CustomAutoImportPathTable3:" << m_query->lastError().text();
     }
 
+    // 文件格式嗅探缓存表
+    // FormatCacheTable3
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //FilePath           | ModifyTime | FileSize | Format | ImageType | FrameCount | IsImage | IsVideo | FrameIndex   //
+    //TEXT primari key   | INTEGER    | INTEGER  | TEXT   | INTEGER   | INTEGER    | INTEGER | INTEGER | BLOB         //
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool f = m_query->exec(QString("CREATE TABLE IF NOT EXISTS FormatCacheTable3 ( "
+                                   "FilePath TEXT primary key, "
+                                   "ModifyTime INTEGER, "
+                                   "FileSize INTEGER, "
+                                   "Format TEXT, "
+                                   "ImageType INTEGER, "
+                                   "FrameCount INTEGER, "
+                                   "IsImage INTEGER, "
+                                   "IsVideo INTEGER, "
+                                   "FrameIndex BLOB)"));
+    if (!f) {
+        qWarning() << "Failed to create FormatCacheTable3:" << m_query->lastError().text();
+    }
+
+    // 判断FormatCacheTable3中是否有FrameIndex字段，多页图/动态图的帧索引
+    if (m_query->exec("select * from sqlite_master where name = 'FormatCacheTable3' and sql like '%FrameIndex%'")) {
+        if (!m_query->next()) {
+            if (m_query->exec(QString("ALTER TABLE \"FormatCacheTable3\" ADD COLUMN \"FrameIndex\" BLOB"))) {
+                qDebug() << "add FrameIndex success";
+            }
+        }
+    }
+
+    // ImportJobTable3
+    ///////////////////////////////////////////////////////////////////////////////////////
+    //JobID                         | UID     | Sources | CheckRepeat | Cursor  | BatchID //
+    //INTEGER primari key           | INTEGER | BLOB    | INTEGER     | INTEGER | INTEGER //
+    ///////////////////////////////////////////////////////////////////////////////////////
+    bool g = m_query->exec(QString("CREATE TABLE IF NOT EXISTS ImportJobTable3 ( "
+                                   "JobID INTEGER primary key AUTOINCREMENT, "
+                                   "UID INTEGER, "
+                                   "Sources BLOB, "
+                                   "CheckRepeat INTEGER, "
+                                   "Cursor INTEGER default 0, "
+                                   "BatchID INTEGER default 0, "
+                                   "CreateTime INTEGER)"));
+    if (!g) {
+        qWarning() << "Failed to create ImportJobTable3:" << m_query->lastError().text();
+    }
+
+    // 目录快照表，保存移动设备、监控目录等的目录修改时间快照，Key 区分快照的用途
+    // DirSnapshotTable3
+    ////////////////////////////////////////////////////
+    //Key                | Snapshot | ScanTime        //
+    //TEXT primari key   | BLOB     | INTEGER         //
+    ////////////////////////////////////////////////////
+    bool h = m_query->exec(QString("CREATE TABLE IF NOT EXISTS DirSnapshotTable3 ( "
+                                   "Key TEXT primary key, "
+                                   "Snapshot BLOB, "
+                                   "ScanTime INTEGER)"));
+    if (!h) {
+        qWarning() << "Failed to create DirSnapshotTable3:" << m_query->lastError().text();
+    }
+
     // 判断ImageTable3中是否有ChangeTime字段
     QString strSqlImage = QString::fromLocal8Bit("select sql from sqlite_master where name = \"ImageTable3\" and sql like \"%ChangeTime%\"");
     bool q = m_query->exec(strSqlImage);
@@ -1473,6 +1674,19 @@ void DBManager::checkDatabase()
         }
     }
 
+    // 判断ImageTable3中是否有ContentHash字段，文件大小和首尾数据块哈希组成的内容标识，用于查找重复文件
+    if (m_query->exec("select * from sqlite_master where name = 'ImageTable3' and sql like '%ContentHash%'")) {
+        if (!m_query->next()) {
+            if (m_query->exec(QString("ALTER TABLE \"ImageTable3\" ADD COLUMN \"FileSize\" INTEGER default 0"))
+                    && m_query->exec(QString("ALTER TABLE \"ImageTable3\" ADD COLUMN \"ContentHash\" INTEGER default 0"))) {
+                qDebug() << "add ContentHash success";
+            }
+        }
+    }
+    if (!m_query->exec("CREATE INDEX IF NOT EXISTS ImageContentIndex ON ImageTable3 (FileSize, ContentHash)")) {
+        qWarning() << "Failed to create content index:" << m_query->lastError().text();
+    }
+
     // 判断ImageTable3中是否有DataHash字段，根据文件内容产生的hash
     QString strDataHash = QString::fromLocal8Bit(
                               "select * from sqlite_master where name = 'ImageTable3' and sql like '%DataHash%'");
@@ -2146,8 +2360,9 @@ QStringList DBManager::recoveryImgFromTrash(const QStringList &paths)
         //3.3把恢复成功的文件数据刷回ImageTable3，这里需要重复利用已经计算好的hash，所以不调用已有的API
         if (!m_query->exec("BEGIN IMMEDIATE TRANSACTION")) {
         }
+        //回收站数据不包含内容标识，按恢复后的文件重新计算，仅读取首尾数据块
         qs = "REPLACE INTO ImageTable3 (PathHash, FilePath, FileName, Time, "
-             "ChangeTime, ImportTime, FileType, UID) VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+             "ChangeTime, ImportTime, FileType, UID, FileSize, ContentHash) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
         if (!m_query->prepare(qs)) {
         }
         for (const auto &info : infos) {
@@ -2159,6 +2374,8 @@ QStringList DBManager::recoveryImgFromTrash(const QStringList &paths)
             m_query->addBindValue(info.importTime);
             m_query->addBindValue(info.itemType);
             m_query->addBindValue(info.albumUID);
+            m_query->addBindValue(QFileInfo(info.filePath).size());
+            m_query->addBindValue(static_cast<qint64>(Libutils::base::contentHash(info.filePath)));
             if (!m_query->exec()) {
             }
         }
@@ -2334,6 +2551,259 @@ QDateTime DBManager::getFileImportTime(const QString &path)
     return result;
 }
 
+bool DBManager::getFormatCache(const QString &path, FormatCacheInfo &info) const
+{
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->prepare("SELECT ModifyTime, FileSize, Format, ImageType, FrameCount, IsImage, IsVideo, FrameIndex "
+                          "FROM FormatCacheTable3 WHERE FilePath = ?")) {
+        qWarning() << "Failed to prepare format cache query:" << m_query->lastError().text();
+        return false;
+    }
+    m_query->addBindValue(path);
+    if (!m_query->exec() || !m_query->next()) {
+        return false;
+    }
+
+    info.filePath = path;
+    info.modifyTime = m_query->value(0).toLongLong();
+    info.fileSize = m_query->value(1).toLongLong();
+    info.format = m_query->value(2).toString();
+    info.imageType = m_query->value(3).toInt();
+    info.frameCount = m_query->value(4).toInt();
+    info.isImage = m_query->value(5).toInt();
+    info.isVideo = m_query->value(6).toInt();
+    info.frameIndex = m_query->value(7).toByteArray();
+    return true;
+}
+
+void DBManager::insertFormatCaches(const FormatCacheInfoList &infos)
+{
+    if (infos.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->exec("BEGIN IMMEDIATE TRANSACTION")) {
+        qWarning() << "Failed to begin transaction:" << m_query->lastError().text();
+        return;
+    }
+
+    QString qs("REPLACE INTO FormatCacheTable3 (FilePath, ModifyTime, FileSize, Format, "
+               "ImageType, FrameCount, IsImage, IsVideo, FrameIndex) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    if (!m_query->prepare(qs)) {
+        qWarning() << "Failed to prepare format cache insert statement:" << m_query->lastError().text();
+        m_query->exec("COMMIT");
+        return;
+    }
+
+    for (const auto &info : infos) {
+        m_query->addBindValue(info.filePath);
+        m_query->addBindValue(info.modifyTime);
+        m_query->addBindValue(info.fileSize);
+        m_query->addBindValue(info.format);
+        m_query->addBindValue(info.imageType);
+        m_query->addBindValue(info.frameCount);
+        m_query->addBindValue(info.isImage);
+        m_query->addBindValue(info.isVideo);
+        m_query->addBindValue(info.frameIndex);
+        if (!m_query->exec()) {
+            qWarning() << "Failed to insert format cache:" << info.filePath << m_query->lastError().text();
+        }
+    }
+
+    //REPLACE 写入的记录获得新的 rowid ，超出上限时删除最久未更新的记录
+    if (!m_query->exec(QString("DELETE FROM FormatCacheTable3 WHERE rowid <= "
+                               "(SELECT max(rowid) FROM FormatCacheTable3) - %1").arg(s_maxFormatCacheRows))) {
+        qWarning() << "Failed to trim format cache:" << m_query->lastError().text();
+    }
+
+    if (!m_query->exec("COMMIT")) {
+        qWarning() << "Failed to commit transaction:" << m_query->lastError().text();
+    } else {
+        qDebug() << "Inserted" << infos.size() << "format cache entries";
+    }
+}
+
+void DBManager::removeFormatCaches(const QStringList &paths)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->exec("BEGIN IMMEDIATE TRANSACTION")) {
+        qWarning() << "Failed to begin transaction:" << m_query->lastError().text();
+        return;
+    }
+
+    if (m_query->prepare("DELETE FROM FormatCacheTable3 WHERE FilePath = ?")) {
+        for (const auto &path : paths) {
+            m_query->addBindValue(path);
+            if (!m_query->exec()) {
+                qWarning() << "Failed to remove format cache:" << path << m_query->lastError().text();
+            }
+        }
+    } else {
+        qWarning() << "Failed to prepare format cache delete statement:" << m_query->lastError().text();
+    }
+
+    if (!m_query->exec("COMMIT")) {
+        qWarning() << "Failed to commit transaction:" << m_query->lastError().text();
+    }
+}
+
+int DBManager::createImportJob(const QStringList &sources, int UID, bool checkRepeat)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << sources;
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->prepare("INSERT INTO ImportJobTable3 (UID, Sources, CheckRepeat, Cursor, BatchID, CreateTime) "
+                          "VALUES (?, ?, ?, 0, 0, ?)")) {
+        qWarning() << "Failed to prepare import job insert statement:" << m_query->lastError().text();
+        return -1;
+    }
+    m_query->addBindValue(UID);
+    m_query->addBindValue(data);
+    m_query->addBindValue(checkRepeat ? 1 : 0);
+    m_query->addBindValue(QDateTime::currentMSecsSinceEpoch());
+    if (!m_query->exec()) {
+        qWarning() << "Failed to create import job:" << m_query->lastError().text();
+        return -1;
+    }
+
+    int jobID = m_query->lastInsertId().toInt();
+    qDebug() << "Created import job" << jobID << "with" << sources.size() << "sources for UID:" << UID;
+    return jobID;
+}
+
+const ImportJobInfoList DBManager::getImportJobs() const
+{
+    ImportJobInfoList jobs;
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->exec("SELECT JobID, UID, Sources, CheckRepeat, Cursor, BatchID FROM ImportJobTable3 ORDER BY JobID")) {
+        qWarning() << "Failed to query import jobs:" << m_query->lastError().text();
+        return jobs;
+    }
+
+    while (m_query->next()) {
+        ImportJobInfo job;
+        job.jobID = m_query->value(0).toInt();
+        job.UID = m_query->value(1).toInt();
+        QByteArray data = m_query->value(2).toByteArray();
+        QDataStream stream(&data, QIODevice::ReadOnly);
+        stream >> job.sources;
+        job.checkRepeat = m_query->value(3).toBool();
+        job.cursor = m_query->value(4).toInt();
+        job.batchID = m_query->value(5).toInt();
+        jobs << job;
+    }
+    return jobs;
+}
+
+void DBManager::removeImportJob(int jobID)
+{
+    if (jobID < 0) {
+        return;
+    }
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->exec(QString("DELETE FROM ImportJobTable3 WHERE JobID = %1").arg(jobID))) {
+        qWarning() << "Failed to remove import job" << jobID << m_query->lastError().text();
+    }
+}
+
+bool DBManager::commitImportBatch(int jobID, int batchID, const DBImgInfoList &infos, int UID, AlbumDBType atype)
+{
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+
+    QString album;
+    if (UID >= 0) {
+        if (m_query->exec(QString("SELECT DISTINCT AlbumName FROM AlbumTable3 WHERE UID=%1").arg(UID)) && m_query->next()) {
+            album = m_query->value(0).toString();
+        } else {
+            qWarning() << "Album not found for UID:" << UID;
+        }
+    }
+
+    return ImportBatch::commit(*m_query, jobID, batchID, infos, album, UID, atype);
+}
+
+bool DBManager::finishImportJob(int jobID, AlbumDBType atype)
+{
+    QMutexLocker mutex(&m_dbMutex);
+    return ImportBatch::finish(*m_query, jobID, atype, EMPTY_HASH_STR);
+}
+
+LibUnionImage_NameSpace::DirSnapshot DBManager::getDirSnapshot(const QString &key) const
+{
+    LibUnionImage_NameSpace::DirSnapshot snapshot;
+    QByteArray data;
+    {
+        QMutexLocker mutex(&m_dbMutex);
+        m_query->setForwardOnly(true);
+        if (!m_query->prepare("SELECT Snapshot FROM DirSnapshotTable3 WHERE Key = ?")) {
+            qWarning() << "Failed to prepare dir snapshot query:" << m_query->lastError().text();
+            return snapshot;
+        }
+        m_query->addBindValue(key);
+        if (!m_query->exec() || !m_query->next()) {
+            return snapshot;
+        }
+        data = m_query->value(0).toByteArray();
+    }
+
+    QDataStream stream(&data, QIODevice::ReadOnly);
+    stream >> snapshot;
+    if (QDataStream::Ok != stream.status()) {
+        qWarning() << "Corrupted dir snapshot:" << key;
+        snapshot.clear();
+    }
+    return snapshot;
+}
+
+void DBManager::saveDirSnapshot(const QString &key, const LibUnionImage_NameSpace::DirSnapshot &snapshot)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << snapshot;
+
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->prepare("REPLACE INTO DirSnapshotTable3 (Key, Snapshot, ScanTime) VALUES (?, ?, ?)")) {
+        qWarning() << "Failed to prepare dir snapshot insert statement:" << m_query->lastError().text();
+        return;
+    }
+    m_query->addBindValue(key);
+    m_query->addBindValue(data);
+    m_query->addBindValue(QDateTime::currentMSecsSinceEpoch());
+    if (!m_query->exec()) {
+        qWarning() << "Failed to save dir snapshot:" << key << m_query->lastError().text();
+    }
+}
+
+void DBManager::removeDirSnapshot(const QString &key)
+{
+    QMutexLocker mutex(&m_dbMutex);
+    m_query->setForwardOnly(true);
+    if (!m_query->prepare("DELETE FROM DirSnapshotTable3 WHERE Key = ?")) {
+        qWarning() << "Failed to prepare dir snapshot delete statement:" << m_query->lastError().text();
+        return;
+    }
+    m_query->addBindValue(key);
+    if (!m_query->exec()) {
+        qWarning() << "Failed to remove dir snapshot:" << key << m_query->lastError().text();
+    }
+}
+
 QStringList DBManager::getYearPaths(const QString &year, int maxCount)
 {
     QMutexLocker mutex(&m_dbMutex);
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QSet>
 #include <QMutex>
 #include <QDebug>
 #include <QSqlDatabase>
@@ -27,6 +28,7 @@
 #include <mutex>
 #include <QReadWriteLock>
 #include "unionimage/unionimage_global.h"
+#include "unionimage/dirwalker.h"
 //#include "connectionpool.h"
 
 
@@ -71,6 +73,10 @@ public:
     const DBImgInfoList     getAllInfos(int loadCount = 0) const;
     const DBImgInfoList     getAllInfosSort(const ItemType &filterType = ItemTypeNull) const;
     const DBImgInfoList     getAllInfosByUID(QString UID) const;
+    const QSet<QString>     getPathSetByUID(const QString &UID) const;
+    const QStringList       getPathsByContent(qint64 fileSize, quint64 contentHash) const;
+    const QList<QStringList> getDuplicateGroups() const;
+    void                    backfillContentHash();
     const QList<QDateTime>  getAllTimelines() const;
     const DBImgInfoList     getInfosByTimeline(const QDateTime &timeline, const ItemType &filterType = ItemTypeNull) const;
     const QList<QDateTime>  getImportTimelines() const;
@@ -143,6 +149,25 @@ public:
     int                     getAlbumImgsCount(int UID) const;
     QDateTime               getFileImportTime(const QString &path);
 
+    // FormatCacheTable3
+    bool                    getFormatCache(const QString &path, FormatCacheInfo &info) const;
+    void                    insertFormatCaches(const FormatCacheInfoList &infos);
+    void                    removeFormatCaches(const QStringList &paths);
+
+    // ImportJobTable3
+    int                     createImportJob(const QStringList &sources, int UID, bool checkRepeat);
+    const ImportJobInfoList getImportJobs() const;
+    void                    removeImportJob(int jobID);
+    //在同一事务中写入一批导入的图片、加入相册并推进任务进度，批次号不大于已提交的批次号时忽略
+    bool                    commitImportBatch(int jobID, int batchID, const DBImgInfoList &infos, int UID, AlbumDBType atype);
+    //导入任务完成，清理相册中重复加入的记录并删除任务记录
+    bool                    finishImportJob(int jobID, AlbumDBType atype);
+
+    // DirSnapshotTable3
+    LibUnionImage_NameSpace::DirSnapshot getDirSnapshot(const QString &key) const;
+    void                    saveDirSnapshot(const QString &key, const LibUnionImage_NameSpace::DirSnapshot &snapshot);
+    void                    removeDirSnapshot(const QString &key);
+
     //年聚合数据
     QStringList             getYearPaths(const QString &year, int maxCount);
     QStringList             getYears();
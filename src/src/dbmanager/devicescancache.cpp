@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicescancache.h"
+#include "dbmanager.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStorageInfo>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+
+// 文件系统UUID到设备节点的符号链接目录
+static const QString s_uuidDir = "/dev/disk/by-uuid";
+// 设备目录快照在 DirSnapshotTable3 中的键前缀
+static const QString s_snapshotKey = "device/";
+// 设备缩略图目录，按UUID划分
+static const QString s_thumbnailDir = albumGlobal::CACHE_PATH + "/devices";
+// 目录修改时间不可靠的文件系统: MSDOS_SUPER_MAGIC(vfat/msdos)、EXFAT_SUPER_MAGIC
+static const QList<quint32> s_unreliableFileSystems = { 0x4d44, 0x2011BAB0 };
+// 超过该天数未接入的设备，删除其缩略图和目录快照
+static const int s_deviceExpireDays = 90;
+
+DeviceScanCache *DeviceScanCache::instance()
+{
+    static DeviceScanCache ins;
+    return &ins;
+}
+
+DeviceScanCache::DeviceScanCache()
+{
+    qDebug() << "Initializing DeviceScanCache";
+}
+
+QString DeviceScanCache::deviceKey(const QString &mountPoint)
+{
+    const QString mount = QDir::cleanPath(mountPoint);
+    {
+        QMutexLocker locker(&m_mutex);
+        auto itr = m_mounts.constFind(mount);
+        if (itr != m_mounts.constEnd()) {
+            return itr.value();
+        }
+    }
+
+    QStorageInfo storage(mount);
+    const QString device = QFileInfo(QString::fromLocal8Bit(storage.device())).canonicalFilePath();
+    if (!storage.isValid() || device.isEmpty() || storage.fileSystemType().startsWith("fuse")) {
+        qDebug() << "No filesystem UUID for mount point:" << mount;
+        return QString();
+    }
+
+    QString uuid;
+    const QFileInfoList links = QDir(s_uuidDir).entryInfoList(QDir::Files | QDir::System | QDir::NoDotAndDotDot);
+    for (const QFileInfo &link : links) {
+        if (link.canonicalFilePath() == device) {
+            uuid = link.fileName();
+            break;
+        }
+    }
+    if (uuid.isEmpty()) {
+        qDebug() << "No filesystem UUID for device:" << device;
+        return uuid;
+    }
+
+    qDebug() << "Mount point" << mount << "has filesystem UUID:" << uuid;
+    QMutexLocker locker(&m_mutex);
+    m_mounts.insert(mount, uuid);
+    return uuid;
+}
+
+LibUnionImage_NameSpace::DirSnapshot DeviceScanCache::snapshot(const QString &uuid) const
+{
+    const LibUnionImage_NameSpace::DirSnapshot result = DBManager::instance()->getDirSnapshot(s_snapshotKey + uuid);
+    qDebug() << "Device scan cache for" << uuid << "has" << result.size() << "directories";
+    return result;
+}
+
+void DeviceScanCache::save(const QString &uuid, const LibUnionImage_NameSpace::DirSnapshot &snapshot)
+{
+    DBManager::instance()->saveDirSnapshot(s_snapshotKey + uuid, snapshot);
+    qDebug() << "Saved device scan cache for" << uuid << "with" << snapshot.size() << "directories";
+}
+
+void DeviceScanCache::forget(const QString &mountPoint)
+{
+    QMutexLocker locker(&m_mutex);
+    m_mounts.remove(QDir::cleanPath(mountPoint));
+}
+
+/**
+   @brief FAT/exFAT 上目录的修改时间不一定随目录项增删更新(相机、Windows 等写入时)，且精度仅为 2s ，
+    修改时间未变不能说明目录未变化。使用 statfs 判断，可对每个目录调用
+ */
+bool DeviceScanCache::reliableDirModifyTime(const QString &path)
+{
+    struct statfs fsInfo;
+    if (0 != statfs(QFile::encodeName(path).constData(), &fsInfo)) {
+        return false;
+    }
+
+    const bool reliable = !s_unreliableFileSystems.contains(static_cast<quint32>(fsInfo.f_type));
+    if (!reliable) {
+        qDebug() << "Directory modify time is unreliable on FAT/exFAT:" << path;
+    }
+    return reliable;
+}
+
+/**
+   @return 文件 \a filePath 所在的已登记挂载点，\a uuid 返回其UUID，不在已登记设备上时返回空
+ */
+QString DeviceScanCache::registeredMount(const QString &filePath, QString *uuid) const
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto itr = m_mounts.constBegin(); itr != m_mounts.constEnd(); ++itr) {
+        if (filePath.startsWith(itr.key() + '/')) {
+            *uuid = itr.value();
+            return itr.key();
+        }
+    }
+    return QString();
+}
+
+/**
+   @brief 缩略图以文件相对挂载点的路径、大小和修改时间命名，同一设备挂载到不同位置时仍可命中，
+    文件内容被修改后大小或修改时间改变，缩略图随之失效
+ */
+QString DeviceScanCache::thumbnailName(const QString &mount, const QString &filePath)
+{
+    QFileInfo info(filePath);
+    const QByteArray key = filePath.mid(mount.size()).toUtf8() + '|' + QByteArray::number(info.size()) + '|'
+                           + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    return QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex()) + ".png";
+}
+
+QString DeviceScanCache::thumbnailPath(const QString &filePath)
+{
+    QString uuid;
+    const QString mount = registeredMount(filePath, &uuid);
+    if (uuid.isEmpty()) {
+        return QString();
+    }
+    return s_thumbnailDir + "/" + uuid + "/" + thumbnailName(mount, filePath);
+}
+
+/**
+   @brief 缩略图数量超过设备上的文件数时，必然存在已删除或已修改文件的缩略图，此时按当前文件重新计算
+    缩略图名称并删除其余的缩略图，设备的缩略图数量因此不超过上次扫描时的文件数；
+    同时删除超过 s_deviceExpireDays 天未接入的设备的缩略图和目录快照
+ */
+void DeviceScanCache::prune(const QString &mountPoint, const QStringList &files)
+{
+    const QString mount = QDir::cleanPath(mountPoint);
+    QString uuid;
+    {
+        QMutexLocker locker(&m_mutex);
+        uuid = m_mounts.value(mount);
+    }
+    if (uuid.isEmpty()) {
+        return;
+    }
+
+    const QString dirPath = s_thumbnailDir + "/" + uuid;
+    // 更新目录修改时间，记录设备最近一次接入的时间
+    ::utimensat(AT_FDCWD, QFile::encodeName(dirPath).constData(), nullptr, 0);
+    removeExpiredDevices(uuid);
+
+    QDir dir(dirPath);
+    const QStringList thumbnails = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+    if (thumbnails.size() <= files.size()) {
+        return;
+    }
+
+    QSet<QString> names;
+    names.reserve(files.size());
+    for (const QString &filePath : files) {
+        names.insert(thumbnailName(mount, filePath));
+    }
+    int removed = 0;
+    for (const QString &thumbnail : thumbnails) {
+        if (!names.contains(thumbnail) && dir.remove(thumbnail)) {
+            removed++;
+        }
+    }
+    qInfo() << "Pruned" << removed << "of" << thumbnails.size() << "device thumbnails for" << uuid;
+}
+
+void DeviceScanCache::removeExpiredDevices(const QString &uuid)
+{
+    const QDateTime expireTime = QDateTime::currentDateTime().addDays(-s_deviceExpireDays);
+    QStringList mounted;
+    {
+        QMutexLocker locker(&m_mutex);
+        mounted = m_mounts.values();
+    }
+    const QFileInfoList dirs = QDir(s_thumbnailDir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo &info : dirs) {
+        if (info.fileName() == uuid || mounted.contains(info.fileName()) || info.lastModified() >= expireTime) {
+            continue;
+        }
+        qInfo() << "Removing cache of device not mounted since" << info.lastModified() << info.fileName();
+        QDir(info.absoluteFilePath()).removeRecursively();
+        DBManager::instance()->removeDirSnapshot(s_snapshotKey + info.fileName());
+    }
+}
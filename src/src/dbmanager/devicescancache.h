@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICESCANCACHE_H
+#define DEVICESCANCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include "unionimage/dirwalker.h"
+
+/**
+ * @brief 移动设备扫描缓存
+ *      按文件系统UUID持久化保存设备的目录快照(数据库 DirSnapshotTable3)，重新接入时
+ *      修改时间未变的目录无需再读取；同时将设备文件的缩略图保存在按UUID划分的目录下，
+ *      以(相对路径, 文件大小, 修改时间)命名，命中时无需读取文件内容计算哈希。
+ *      无UUID的设备(MTP/PTP 等 fuse 挂载)不缓存；FAT/exFAT 的目录修改时间不可靠，不使用目录快照。
+ * @threadsafe
+ */
+class DeviceScanCache
+{
+public:
+    static DeviceScanCache *instance();
+
+    // 获取挂载点 \a mountPoint 所在文件系统的UUID并登记该挂载点，无UUID时返回空
+    QString deviceKey(const QString &mountPoint);
+    // 读取设备 \a uuid 上次扫描完成时的目录快照
+    LibUnionImage_NameSpace::DirSnapshot snapshot(const QString &uuid) const;
+    // 保存设备 \a uuid 的目录快照
+    void save(const QString &uuid, const LibUnionImage_NameSpace::DirSnapshot &snapshot);
+    // 路径 \a path 所在文件系统的目录修改时间是否可靠，不可靠时不能使用目录快照
+    static bool reliableDirModifyTime(const QString &path);
+    // 设备卸载后取消挂载点登记
+    void forget(const QString &mountPoint);
+    // 返回已登记设备上文件 \a filePath 的缩略图路径，不在已登记设备上时返回空
+    QString thumbnailPath(const QString &filePath);
+    // 设备 \a mountPoint 完整扫描得到文件 \a files 后清理缩略图缓存
+    void prune(const QString &mountPoint, const QStringList &files);
+
+private:
+    DeviceScanCache();
+    QString registeredMount(const QString &filePath, QString *uuid) const;
+    static QString thumbnailName(const QString &mount, const QString &filePath);
+    void removeExpiredDevices(const QString &uuid);
+
+private:
+    mutable QMutex m_mutex;
+    QHash<QString, QString> m_mounts;    ///< QHash<挂载点, UUID>
+
+    Q_DISABLE_COPY(DeviceScanCache)
+};
+
+#endif  // DEVICESCANCACHE_H
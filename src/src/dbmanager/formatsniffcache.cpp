@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "formatsniffcache.h"
+#include "dbmanager.h"
+#include "unionimage/baseutils.h"
+
+#include <QDateTime>
+#include <QDebug>
+
+// 未保存的缓存条目达到此数量时批量写入数据库
+static const int FLUSH_THRESHOLD = 200;
+// 内存中保留的最大缓存条目数
+static const int s_maxCacheEntries = 5000;
+
+FormatSniffCache *FormatSniffCache::instance()
+{
+    static FormatSniffCache ins;
+    return &ins;
+}
+
+FormatSniffCache::FormatSniffCache()
+    : m_cache(s_maxCacheEntries)
+{
+    qDebug() << "Initializing FormatSniffCache";
+}
+
+/**
+   @brief 依次从内存缓存、待写入的缓存和数据库中查找 \a path 的记录，从数据库读取时不持有缓存锁
+   @return 是否找到记录
+ */
+bool FormatSniffCache::lookup(const QString &path, FormatCacheInfo &info)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const FormatCacheInfo *cached = m_cache.object(path)) {
+            info = *cached;
+            return true;
+        }
+        auto itr = m_dirty.constFind(path);
+        if (itr != m_dirty.constEnd()) {
+            info = itr.value();
+            m_cache.insert(path, new FormatCacheInfo(info));
+            return true;
+        }
+    }
+
+    if (!DBManager::instance()->getFormatCache(path, info)) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    // 读取数据库期间其它线程已更新时以内存中的为准
+    if (const FormatCacheInfo *cached = m_cache.object(path)) {
+        info = *cached;
+    } else {
+        m_cache.insert(path, new FormatCacheInfo(info));
+    }
+    return true;
+}
+
+bool FormatSniffCache::find(const QString &path, const QFileInfo &fileInfo, FormatCacheInfo &info)
+{
+    if (Libutils::base::onMountDevice(path)) {
+        return false;
+    }
+
+    FormatCacheInfo cached;
+    if (!lookup(path, cached)) {
+        return false;
+    }
+
+    // 文件修改时间或大小变更，缓存失效
+    if (cached.modifyTime != fileInfo.lastModified().toMSecsSinceEpoch() || cached.fileSize != fileInfo.size()) {
+        return false;
+    }
+
+    info = cached;
+    return true;
+}
+
+void FormatSniffCache::update(const QFileInfo &fileInfo, const FormatCacheInfo &info)
+{
+    if (Libutils::base::onMountDevice(info.filePath)) {
+        return;
+    }
+
+    // 仅覆盖已嗅探的字段，先取得已有记录
+    FormatCacheInfo cache;
+    bool found = lookup(info.filePath, cache);
+
+    FormatCacheInfoList flushList;
+    {
+        QMutexLocker locker(&m_mutex);
+        // 查找后其它线程可能已更新
+        if (const FormatCacheInfo *cached = m_cache.object(info.filePath)) {
+            cache = *cached;
+            found = true;
+        }
+
+        qint64 modifyTime = fileInfo.lastModified().toMSecsSinceEpoch();
+        // 文件已变更，丢弃旧的嗅探结果
+        if (!found || cache.modifyTime != modifyTime || cache.fileSize != fileInfo.size()) {
+            cache = FormatCacheInfo();
+            cache.filePath = info.filePath;
+            cache.modifyTime = modifyTime;
+            cache.fileSize = fileInfo.size();
+        }
+
+        if (!info.format.isEmpty()) {
+            cache.format = info.format;
+        }
+        if (-1 != info.imageType) {
+            cache.imageType = info.imageType;
+        }
+        if (-1 != info.frameCount) {
+            cache.frameCount = info.frameCount;
+        }
+        if (-1 != info.isImage) {
+            cache.isImage = info.isImage;
+        }
+        if (-1 != info.isVideo) {
+            cache.isVideo = info.isVideo;
+        }
+        if (!info.frameIndex.isEmpty()) {
+            cache.frameIndex = info.frameIndex;
+        }
+        m_cache.insert(cache.filePath, new FormatCacheInfo(cache));
+        m_dirty.insert(cache.filePath, cache);
+
+        if (m_dirty.size() >= FLUSH_THRESHOLD) {
+            flushList = m_dirty.values();
+            m_dirty.clear();
+        }
+    }
+
+    // 写入数据库时不持有缓存锁
+    if (!flushList.isEmpty()) {
+        DBManager::instance()->insertFormatCaches(flushList);
+    }
+}
+
+void FormatSniffCache::remove(const QStringList &paths)
+{
+    if (paths.isEmpty()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QString &path : paths) {
+            m_cache.remove(path);
+            m_dirty.remove(path);
+        }
+    }
+    DBManager::instance()->removeFormatCaches(paths);
+}
+
+void FormatSniffCache::flush()
+{
+    FormatCacheInfoList flushList;
+    {
+        QMutexLocker locker(&m_mutex);
+        flushList = m_dirty.values();
+        m_dirty.clear();
+    }
+
+    if (!flushList.isEmpty()) {
+        qDebug() << "Flushing" << flushList.size() << "format cache entries";
+        DBManager::instance()->insertFormatCaches(flushList);
+    }
+}
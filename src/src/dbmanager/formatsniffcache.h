@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FORMATSNIFFCACHE_H
+#define FORMATSNIFFCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QFileInfo>
+
+#include "unionimage/unionimage_global.h"
+
+/**
+ * @brief 文件格式嗅探缓存
+ *      缓存 isImage/isVideo/getImageType 按内容嗅探得到的格式、类型、帧数及多页图/动态图的帧索引，
+ *      以(路径, 修改时间, 文件大小)校验有效性，持久化保存在数据库 FormatCacheTable3 中，
+ *      命中时只需一次 stat ，无需打开文件。
+ *      内存中按最近使用保留有限条目，未命中时按路径从数据库读取单条记录；
+ *      移动设备上的文件不缓存，避免为拔出后不再访问的文件积累记录。
+ * @threadsafe
+ */
+class FormatSniffCache
+{
+public:
+    static FormatSniffCache *instance();
+
+    // 查找 \a path 对应的有效缓存，\a fileInfo 用于校验文件修改时间和大小
+    bool find(const QString &path, const QFileInfo &fileInfo, FormatCacheInfo &info);
+    // 更新缓存，仅覆盖 \a info 中已嗅探(不为-1)的字段
+    void update(const QFileInfo &fileInfo, const FormatCacheInfo &info);
+    // 移除文件对应的缓存
+    void remove(const QStringList &paths);
+    // 将未保存的缓存写入数据库
+    void flush();
+
+private:
+    FormatSniffCache();
+    bool lookup(const QString &path, FormatCacheInfo &info);
+
+private:
+    QMutex m_mutex;
+    QCache<QString, FormatCacheInfo> m_cache;   ///< 最近使用的缓存 QCache<文件路径, 缓存信息>
+    QHash<QString, FormatCacheInfo> m_dirty;    ///< 待写入数据库的缓存
+
+    Q_DISABLE_COPY(FormatSniffCache)
+};
+
+#endif  // FORMATSNIFFCACHE_H
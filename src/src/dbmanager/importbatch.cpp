@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "importbatch.h"
+#include "unionimage/unionimage.h"
+
+#include <QDebug>
+#include <QSqlError>
+
+void ImportBatch::writeImgInfos(QSqlQuery &query, const DBImgInfoList &infos)
+{
+    if (!query.prepare("REPLACE INTO ImageTable3 (PathHash, FilePath, FileName, Time, "
+                       "ChangeTime, ImportTime, FileType, UID, FileSize, ContentHash) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)")) {
+        qWarning() << "Failed to prepare insert statement:" << query.lastError().text();
+        return;
+    }
+
+    for (const auto &info : infos) {
+        query.addBindValue(LibUnionImage_NameSpace::hashByString(info.filePath));
+        query.addBindValue(info.filePath);
+        query.addBindValue(info.getFileNameFromFilePath());
+        query.addBindValue(info.time);
+        query.addBindValue(info.changeTime);
+        query.addBindValue(info.importTime);
+        query.addBindValue(info.itemType);
+        query.addBindValue(info.albumUID);
+        query.addBindValue(info.fileSize);
+        // SQLite 仅支持有符号 64 位整数
+        query.addBindValue(static_cast<qint64>(info.contentHash));
+        if (!query.exec()) {
+            qWarning() << "Failed to insert image:" << info.filePath << query.lastError().text();
+        }
+    }
+}
+
+void ImportBatch::writeAlbumPaths(QSqlQuery &query, const QString &album, int UID, AlbumDBType atype, const QStringList &paths)
+{
+    QString qs = QString("REPLACE INTO AlbumTable3 (AlbumId, AlbumName, AlbumDBType, UID, PathHash)"
+                         " VALUES (null, \"%1\", %2, %3, ?)")
+                 .arg(album).arg(atype).arg(UID);
+    if (!query.prepare(qs)) {
+        qWarning() << "Failed to prepare album insert statement:" << query.lastError().text();
+        return;
+    }
+
+    for (const auto &path : paths) {
+        query.addBindValue(LibUnionImage_NameSpace::hashByString(path));
+        if (!query.exec()) {
+            qWarning() << "Failed to insert into album:" << path << query.lastError().text();
+        }
+    }
+}
+
+void ImportBatch::removeDuplicateAlbumRows(QSqlQuery &query, AlbumDBType atype, const QString &emptyHash)
+{
+    //FIXME: Don't insert the repeated filepath into the same album
+    //Delete the same data
+    QString ps = "DELETE FROM AlbumTable3 where AlbumId NOT IN"
+                 "(SELECT min(AlbumId) FROM AlbumTable3 GROUP BY"
+                 " UID, PathHash, AlbumDBType) AND PathHash != \"%1\""
+                 " AND AlbumDBType = %2 ";
+    if (!query.exec(ps.arg(emptyHash).arg(atype))) {
+        qWarning() << "Failed to remove duplicate album rows:" << query.lastError().text();
+    }
+}
+
+bool ImportBatch::commit(QSqlQuery &query, int jobID, int batchID, const DBImgInfoList &infos,
+                         const QString &album, int UID, AlbumDBType atype)
+{
+    query.setForwardOnly(true);
+    if (!query.exec("BEGIN IMMEDIATE TRANSACTION")) {
+        qWarning() << "Failed to begin transaction:" << query.lastError().text();
+        return false;
+    }
+
+    //批次已提交过，不再重复写入
+    if (jobID >= 0) {
+        if (query.exec(QString("SELECT BatchID FROM ImportJobTable3 WHERE JobID = %1").arg(jobID))
+                && query.next() && query.value(0).toInt() >= batchID) {
+            qDebug() << "Import batch" << batchID << "of job" << jobID << "already committed";
+            query.exec("ROLLBACK");
+            return true;
+        }
+    }
+
+    //导入图片数据库ImageTable3
+    writeImgInfos(query, infos);
+
+    //导入图片数据库AlbumTable3，重复记录在任务完成时统一清理
+    if (!album.isEmpty()) {
+        QStringList paths;
+        for (const auto &info : infos) {
+            paths << info.filePath;
+        }
+        writeAlbumPaths(query, album, UID, atype, paths);
+    }
+
+    //推进导入任务进度，与数据一同提交
+    if (jobID >= 0 && !query.exec(QString("UPDATE ImportJobTable3 SET Cursor = Cursor + %1, BatchID = %2 WHERE JobID = %3")
+                                  .arg(infos.size()).arg(batchID).arg(jobID))) {
+        qWarning() << "Failed to update import job" << jobID << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+
+    if (!query.exec("COMMIT")) {
+        qWarning() << "Failed to commit import batch:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+
+    qInfo() << "Committed import batch" << batchID << "of job" << jobID << "with" << infos.size() << "images";
+    return true;
+}
+
+bool ImportBatch::finish(QSqlQuery &query, int jobID, AlbumDBType atype, const QString &emptyHash)
+{
+    query.setForwardOnly(true);
+    if (!query.exec("BEGIN IMMEDIATE TRANSACTION")) {
+        qWarning() << "Failed to begin transaction:" << query.lastError().text();
+        return false;
+    }
+
+    removeDuplicateAlbumRows(query, atype, emptyHash);
+
+    if (jobID >= 0 && !query.exec(QString("DELETE FROM ImportJobTable3 WHERE JobID = %1").arg(jobID))) {
+        qWarning() << "Failed to remove import job" << jobID << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+
+    if (!query.exec("COMMIT")) {
+        qWarning() << "Failed to commit import job" << jobID << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IMPORTBATCH_H
+#define IMPORTBATCH_H
+
+#include <QSqlQuery>
+#include <QStringList>
+
+#include "dbmanager.h"
+
+/**
+ * @brief 导入数据的写入语句
+ *      DBManager 的图片、相册写入接口与导入任务的批次提交共用。调用方持有数据库锁；
+ *      write/remove 系列在调用方开启的事务中执行，commit/finish 自行开启并提交事务。
+ */
+class ImportBatch
+{
+public:
+    // 写入图片数据 ImageTable3
+    static void writeImgInfos(QSqlQuery &query, const DBImgInfoList &infos);
+    // 将 \a paths 加入 \a UID 对应的相册 \a album (AlbumTable3)
+    static void writeAlbumPaths(QSqlQuery &query, const QString &album, int UID, AlbumDBType atype, const QStringList &paths);
+    // 删除 \a atype 类型相册中重复加入的图片记录，\a emptyHash 为相册占位记录的哈希
+    static void removeDuplicateAlbumRows(QSqlQuery &query, AlbumDBType atype, const QString &emptyHash);
+
+    // 在同一事务中写入一批导入的图片、加入相册并推进任务进度，批次号不大于已提交的批次号时忽略
+    static bool commit(QSqlQuery &query, int jobID, int batchID, const DBImgInfoList &infos,
+                       const QString &album, int UID, AlbumDBType atype);
+    // 导入任务完成，在同一事务中清理相册重复记录并删除任务记录
+    static bool finish(QSqlQuery &query, int jobID, AlbumDBType atype, const QString &emptyHash);
+};
+
+#endif  // IMPORTBATCH_H
@@ -5,44 +5,50 @@
 
 #include "fileinotify.h"
 #include "unionimage/unionimage.h"
+#include "unionimage/dirwalker.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/devicescancache.h"
 
 #include <sys/inotify.h>
-#include <dirent.h>
+#include <errno.h>
+#include <string.h>
 #include <unistd.h>
-#include <sys/types.h>
-#include <unistd.h>
-#include <stdio.h>
 
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QElapsedTimer>
+
+//监控目录需要的事件：文件写入完成、移入移出、创建删除，以及目录自身被删除或移走
+enum {MASK = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR};
+//父级目录只需知道子目录的创建，追加到已有监听上，避免覆盖该目录已有的事件
+enum {PARENT_MASK = IN_CREATE | IN_MOVED_TO | IN_ONLYDIR | IN_MASK_ADD};
 
-enum {MASK = IN_MODIFY | IN_CREATE | IN_DELETE};
+//单次读取事件的缓冲区大小，可容纳数百个事件
+static const int s_eventBufferSize = 64 * 1024;
 
 FileInotify::FileInotify(QObject *parent)
     : QObject(parent)
-    , m_Supported(LibUnionImage_NameSpace::unionImageSupportFormat() + LibUnionImage_NameSpace::videoFiletypes()) //图片+视频
 {
-    qDebug() << "Initializing FileInotify with supported formats:" << m_Supported;
+    //图片+视频
+    const QStringList supported = LibUnionImage_NameSpace::unionImageSupportFormat() + LibUnionImage_NameSpace::videoFiletypes();
+    qDebug() << "Initializing FileInotify with supported formats:" << supported;
 
-    for (auto &eachData : m_Supported) {
-        eachData = eachData.toUpper();
+    for (const auto &eachData : supported) {
+        m_Supported.insert(eachData.toUpper());
     }
 
     m_timer = new QTimer();
     connect(m_timer, &QTimer::timeout, this, &FileInotify::onNeedSendPictures);
 
-    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString & path) {
-        qDebug() << "Directory change detected in:" << path;
-
-        // 检查是否有待创建的目录已经被创建
-        checkPendingDirectories(path);
-
-        // 启动定时器处理其他变化
-        m_timer->start(500);
-    });
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        qWarning() << "Failed to initialize inotify:" << strerror(errno);
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &FileInotify::onInotifyEvents);
 }
 
 FileInotify::~FileInotify()
@@ -51,25 +57,16 @@ FileInotify::~FileInotify()
     clear();
 }
 
+/**
+   @brief 重新为监控目录添加监听，事件队列溢出时可能遗漏了新建的子目录；同时检查待创建目录是否已经存在
+ */
 void FileInotify::checkNewPath()
 {
     qDebug() << "Checking for new paths in monitored directories";
 
-    // 检查现有监控目录的子目录
+    // 为现有监控目录及其子目录添加监听，已监听的目录不受影响
     for (const auto &currentDir : m_currentDirs) {
-        QDir dir(currentDir);
-        QFileInfoList list;
-        LibUnionImage_NameSpace::getAllDirInDir(dir, list);
-
-        QStringList dirs;
-        std::transform(list.begin(), list.end(), std::back_inserter(dirs), [](const QFileInfo & info) {
-            return info.absoluteFilePath();
-        });
-
-        if (!dirs.isEmpty()) {
-            qDebug() << "Adding new subdirectories to watch:" << dirs;
-            m_watcher.addPaths(dirs);
-        }
+        addWatchTree(currentDir);
     }
 
     // 检查待创建目录是否已经存在
@@ -112,9 +109,17 @@ void FileInotify::addWather(const QStringList &paths, const QString &album, int
     // 设置当前监控的直接路径
     m_currentDirs = existingPaths;
 
-    // 为存在的路径添加直接监听
+    // 为存在的路径及其子目录添加监听，上次同步后未变化的目录不再读取
+    //FAT/exFAT 上目录修改时间不可靠，不使用快照，完整读取
+    for (const QString &path : existingPaths) {
+        LibUnionImage_NameSpace::DirSnapshot snapshot;
+        if (DeviceScanCache::reliableDirModifyTime(path)) {
+            snapshot = DBManager::instance()->getDirSnapshot(snapshotKey(path));
+        }
+        auto itr = m_snapshots.insert(path, snapshot);
+        addWatchTree(path, &itr.value());
+    }
     if (!existingPaths.isEmpty()) {
-        m_watcher.addPaths(existingPaths);
         qDebug() << "Added direct monitoring for existing paths:" << existingPaths;
     }
 
@@ -133,6 +138,8 @@ void FileInotify::addWather(const QStringList &paths, const QString &album, int
         }
     }
 
+    // 启动时与数据库同步一次
+    m_needRescan = true;
     m_timer->start(1500);
 }
 
@@ -154,10 +161,23 @@ void FileInotify::clear()
     m_Supported.clear();
     m_newFile.clear();
     m_deleteFile.clear();
+    m_removedDirs.clear();
     m_currentDirs.clear();
     m_pendingDirs.clear();
     m_parentDirs.clear();
     m_parentToChildren.clear();
+    m_watches.clear();
+    m_parentWatches.clear();
+    m_snapshots.clear();
+    m_pendingSnapshots.clear();
+
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
 
     if (m_timer && m_timer->isActive()) {
         m_timer->stop();
@@ -169,7 +189,7 @@ void FileInotify::clear()
 void FileInotify::getAllPicture(bool isFirst)
 {
     qDebug() << "Getting all pictures, isFirst:" << isFirst;
-    QFileInfoList list;
+    QStringList list;
     for (int i = 0; i != m_currentDirs.size(); ++i) {
         QDir dir(m_currentDirs[i]);
         if (!dir.exists()) {
@@ -179,33 +199,33 @@ void FileInotify::getAllPicture(bool isFirst)
             continue;
         }
 
-        //获取监控目录的所有文件
-        LibUnionImage_NameSpace::getAllFileInDir(dir, list);
+        //获取监控目录中支持格式的文件，与目录监听一致，不进入链接至目录的符号链接
+        list << LibUnionImage_NameSpace::walkFiles(dir.absolutePath(), [this](const QString &fileName) {
+            return isSupported(fileName);
+        });
     }
 
     if (m_currentDirs.isEmpty()) { //文件夹被删除，清理数据库
         qWarning() << "All monitored directories were removed, cleaning up database for UID:" << m_currentUID;
         DBManager::instance()->removeCustomAutoImportPath(m_currentUID);
-        m_deleteFile = DBManager::instance()->getPathsByAlbum(m_currentUID);
+        const QStringList paths = DBManager::instance()->getPathsByAlbum(m_currentUID);
+        m_deleteFile = QSet<QString>(paths.begin(), paths.end());
         m_newFile.clear();
         emit pathDestroyed(m_currentUID);
         return;
     }
 
-    //移除不支持的文件
-    auto removeIter = std::remove_if(list.begin(), list.end(), [this](const QFileInfo & info) {
-        return !m_Supported.contains(info.suffix().toUpper());
-    });
-    list.erase(removeIter, list.end());
-
-    //提取文件路径
-    QStringList filePaths;
-    std::transform(list.begin(), list.end(), std::back_inserter(filePaths), [](const QFileInfo & info) {
-        return info.isSymLink() ? info.readSymLink() : info.absoluteFilePath();
-    });
+    //提取文件路径，符号链接使用其指向的路径
+    QSet<QString> filePaths;
+    filePaths.reserve(list.size());
+    for (const QString &path : list) {
+        QFileInfo info(path);
+        filePaths.insert(info.isSymLink() ? info.readSymLink() : path);
+    }
 
     //获取当前已导入的全部文件
-    auto allPaths = DBManager::instance()->getPathsByAlbum(m_currentUID);
+    const QStringList albumPaths = DBManager::instance()->getPathsByAlbum(m_currentUID);
+    const QSet<QString> allPaths(albumPaths.begin(), albumPaths.end());
 
     //筛选出新增图片文件
     for (auto path : filePaths) {
@@ -254,30 +274,45 @@ void FileInotify::getAllPicture(bool isFirst)
 void FileInotify::onNeedSendPictures()
 {
     qDebug() << "Processing file changes";
-    checkNewPath();
-    getAllPicture(false);
+    //增删的文件已由 inotify 事件直接得到，仅在启动或事件丢失时重新扫描
+    if (m_needRescan) {
+        m_needRescan = false;
+        if (!m_reconciled) {
+            m_reconciled = true;
+            reconcile();
+        } else {
+            checkNewPath();
+            getAllPicture(false);
+        }
+    }
 
     //发送导入
     if (!m_newFile.isEmpty() || !m_deleteFile.isEmpty()) {
         qInfo() << "Emitting monitor changed signal - New files:" << m_newFile.size()
                 << "Deleted files:" << m_deleteFile.size();
-        emit sigMonitorChanged(m_newFile, m_deleteFile, m_currentAlbum, m_currentUID);
+        emit sigMonitorChanged(m_newFile.values(), m_deleteFile.values(), m_currentAlbum, m_currentUID);
 
         if (m_newFile.size() > 100) {
             qDebug() << "Clearing large new file list";
-            QStringList().swap(m_newFile); //强制清理内存
+            QSet<QString>().swap(m_newFile); //强制清理内存
         } else {
             m_newFile.clear();
         }
 
         if (m_deleteFile.size() > 100) {
             qDebug() << "Clearing large delete file list";
-            QStringList().swap(m_deleteFile); //强制清理内存
+            QSet<QString>().swap(m_deleteFile); //强制清理内存
         } else {
             m_deleteFile.clear();
         }
     }
 
+    //sigMonitorChanged 为直接连接，返回时同步得到的增删已写入数据库，此时保存快照与数据库一致
+    for (auto itr = m_pendingSnapshots.constBegin(); itr != m_pendingSnapshots.constEnd(); ++itr) {
+        DBManager::instance()->saveDirSnapshot(itr.key(), itr.value());
+    }
+    m_pendingSnapshots.clear();
+
     m_timer->stop();
 }
 
@@ -286,10 +321,15 @@ void FileInotify::addParentWatcher(const QString &parentPath, const QString &tar
     qDebug() << "Adding parent watcher for:" << parentPath << "target child:" << targetChild;
 
     // 检查是否已经监听了这个父级目录
-    if (!m_parentDirs.contains(parentPath)) {
-        m_parentDirs.append(parentPath);
-        m_watcher.addPath(parentPath);
-        qDebug() << "Started monitoring parent directory:" << parentPath;
+    if (!m_parentDirs.contains(parentPath) && m_inotifyFd >= 0) {
+        const int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(parentPath).constData(), PARENT_MASK);
+        if (wd < 0) {
+            qWarning() << "Failed to watch parent directory:" << parentPath << strerror(errno);
+        } else {
+            m_parentDirs.append(parentPath);
+            m_parentWatches.insert(wd, parentPath);
+            qDebug() << "Started monitoring parent directory:" << parentPath;
+        }
     }
 
     // 建立父级目录到子目录的映射
@@ -328,7 +368,7 @@ void FileInotify::checkPendingDirectories(const QString &changedPath)
         m_currentDirs.append(foundDir);
 
         // 添加直接监听
-        m_watcher.addPath(foundDir);
+        addNewDir(foundDir);
         qInfo() << "Added direct monitoring for newly created directory:" << foundDir;
 
         // 检查是否可以移除父级监听
@@ -340,7 +380,12 @@ void FileInotify::checkPendingDirectories(const QString &changedPath)
             if (m_parentToChildren[parentPath].isEmpty()) {
                 m_parentToChildren.remove(parentPath);
                 m_parentDirs.removeAll(parentPath);
-                m_watcher.removePath(parentPath);
+                const int wd = m_parentWatches.key(parentPath, -1);
+                m_parentWatches.remove(wd);
+                // 父级目录同时是监控目录时保留监听
+                if (wd >= 0 && !m_watches.contains(wd)) {
+                    inotify_rm_watch(m_inotifyFd, wd);
+                }
                 qDebug() << "Removed parent monitoring for:" << parentPath;
             }
         }
@@ -349,3 +394,307 @@ void FileInotify::checkPendingDirectories(const QString &changedPath)
         m_timer->start(500);
     }
 }
+
+void FileInotify::onInotifyEvents()
+{
+    alignas(struct inotify_event) char buffer[s_eventBufferSize];
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && EINTR == errno) {
+                continue;
+            }
+            break;  //EAGAIN，事件已读完
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            auto event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+            handleEvent(event);
+        }
+    }
+    removeDirFiles();
+
+    //合并短时间内的多次变化后再发送
+    if (m_needRescan || !m_newFile.isEmpty() || !m_deleteFile.isEmpty()) {
+        m_timer->start(500);
+    }
+}
+
+void FileInotify::handleEvent(const struct inotify_event *event)
+{
+    //事件队列溢出，无法得知丢失了哪些变化，重新扫描本相册的监控目录
+    if (event->mask & IN_Q_OVERFLOW) {
+        qWarning() << "Inotify event queue overflowed, rescanning album:" << m_currentAlbum;
+        m_needRescan = true;
+        return;
+    }
+
+    //监听已被移除(目录被删除或主动移除)
+    if (event->mask & IN_IGNORED) {
+        m_watches.remove(event->wd);
+        m_parentWatches.remove(event->wd);
+        return;
+    }
+
+    //待创建目录的父级目录中有目录创建
+    auto parentItr = m_parentWatches.constFind(event->wd);
+    if (parentItr != m_parentWatches.constEnd() && (event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+        checkPendingDirectories(parentItr.value());
+    }
+
+    const QString dir = m_watches.value(event->wd);
+    if (dir.isEmpty()) {
+        return;
+    }
+
+    //监控的根目录被删除或移走，由扫描处理
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        if (m_currentDirs.contains(dir)) {
+            qWarning() << "Monitored directory removed:" << dir;
+            m_needRescan = true;
+        }
+        return;
+    }
+
+    // 跳过隐藏文件，与扫描时一致
+    if (0 == event->len || '.' == event->name[0]) {
+        return;
+    }
+    const QString path = dir + '/' + QFile::decodeName(event->name);
+
+    if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            //先处理此前移走的目录，同名目录移回时其中的文件仍记为新增
+            removeDirFiles();
+            addNewDir(path);
+        } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+            //目录移走时不会产生其中文件的事件，按数据库中的记录删除，同一批事件中的目录合并查询
+            removeWatchTree(path);
+            m_removedDirs.insert(path);
+        }
+        return;
+    }
+
+    if (!isSupported(path)) {
+        return;
+    }
+
+    if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        //写入完成或移入，已导入的文件被修改时重新上报以更新信息
+        addFile(path);
+    } else if (event->mask & IN_CREATE) {
+        //符号链接不会产生 IN_CLOSE_WRITE 事件
+        if (QFileInfo(path).isSymLink()) {
+            addFile(path);
+        }
+    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        removeFile(path);
+    }
+}
+
+/**
+   @brief 为目录 \a dir 及其全部子目录(不含隐藏目录和链接至目录的符号链接)添加监听，
+    已监听的目录重复添加时监听描述符不变
+ */
+void FileInotify::addWatchTree(const QString &dir, const LibUnionImage_NameSpace::DirSnapshot *previous)
+{
+    if (m_inotifyFd < 0) {
+        return;
+    }
+
+    //只遍历目录，不收集文件
+    LibUnionImage_NameSpace::DirSnapshot tree;
+    LibUnionImage_NameSpace::walkFilesBatched(dir, [](const QString &) {
+        return false;
+    }, [](const QStringList &) {
+        return true;
+    }, true, previous, &tree);
+
+    QString base = QDir(dir).absolutePath();
+    if (base.endsWith('/')) {
+        base.chop(1);
+    }
+
+    for (auto itr = tree.constBegin(); itr != tree.constEnd(); ++itr) {
+        const QString path = itr.key().isEmpty() ? QDir(dir).absolutePath() : base + itr.key();
+        const int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(path).constData(), MASK);
+        if (wd < 0) {
+            //超出 max_user_watches 时该目录下的变化只能在重新扫描时发现
+            qWarning() << "Failed to watch directory:" << path << strerror(errno);
+            continue;
+        }
+        m_watches.insert(wd, path);
+    }
+    qDebug() << "Watching" << tree.size() << "directories in" << dir << "total watches:" << m_watches.size();
+}
+
+QString FileInotify::snapshotKey(const QString &root) const
+{
+    return QString("monitor/%1%2").arg(m_currentUID).arg(QDir(root).absolutePath());
+}
+
+void FileInotify::reconcile()
+{
+    // 监控目录被删除时按原有逻辑全量处理
+    for (const QString &root : m_currentDirs) {
+        if (!QFileInfo(root).isDir()) {
+            getAllPicture(false);
+            return;
+        }
+    }
+
+    for (const QString &root : m_currentDirs) {
+        reconcileDir(root);
+    }
+    m_snapshots.clear();
+}
+
+/**
+   @brief 快照记录了上次同步时各目录的修改时间，目录修改时间未变说明其中的目录项未增删，
+    数据库中的记录仍与之一致。只重新读取修改时间变化的目录，并按目录与数据库比较；
+    已不存在的目录中的记录全部删除。没有快照时所有目录均视为变化，等同于全量扫描
+ */
+void FileInotify::reconcileDir(const QString &root)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const LibUnionImage_NameSpace::DirSnapshot previous = m_snapshots.value(root);
+    LibUnionImage_NameSpace::DirSnapshot current;
+    QHash<QString, QStringList> found;  // 重新读取的目录中的文件 QHash<目录, 文件>
+    LibUnionImage_NameSpace::walkMediaFilesBatched(root, [&found](const QStringList &files) {
+        for (const QString &file : files) {
+            found[file.left(file.lastIndexOf('/'))] << file;
+        }
+        return true;
+    }, true, &previous, &current);
+
+    QString base = QDir(root).absolutePath();
+    if (base.endsWith('/')) {
+        base.chop(1);
+    }
+
+    //找出重新读取过的目录和已不存在的目录
+    QSet<QString> changedDirs;
+    QSet<QString> currentDirs;
+    const bool changed = LibUnionImage_NameSpace::diffDirSnapshot(root, previous, current, changedDirs, currentDirs);
+    //快照只需记录目录结构
+    for (auto itr = current.begin(); itr != current.end(); ++itr) {
+        itr->files.clear();
+    }
+
+    if (changed) {
+        //数据库中本相册位于该监控目录下的记录，按目录分组
+        QHash<QString, QStringList> recorded;
+        const QString prefix = base + '/';
+        const QStringList albumPaths = DBManager::instance()->getPathsByAlbum(m_currentUID);
+        for (const QString &path : albumPaths) {
+            if (path.startsWith(prefix)) {
+                recorded[path.left(path.lastIndexOf('/'))] << path;
+            }
+        }
+
+        for (const QString &dir : changedDirs) {
+            const QStringList dbFiles = recorded.value(dir);
+            const QSet<QString> dbSet(dbFiles.begin(), dbFiles.end());
+            QSet<QString> diskSet;
+            for (const QString &file : found.value(dir)) {
+                QFileInfo info(file);
+                const QString filePath = info.isSymLink() ? info.readSymLink() : file;
+                diskSet.insert(filePath);
+                if (!dbSet.contains(filePath)) {
+                    addFile(filePath);
+                }
+            }
+            for (const QString &path : dbFiles) {
+                //符号链接指向其它目录时记录不在本目录的读取结果中
+                if (!diskSet.contains(path) && !QFileInfo::exists(path)) {
+                    removeFile(path);
+                }
+            }
+        }
+
+        for (auto itr = recorded.constBegin(); itr != recorded.constEnd(); ++itr) {
+            if (!currentDirs.contains(itr.key())) {
+                for (const QString &path : itr.value()) {
+                    removeFile(path);
+                }
+            }
+        }
+    }
+
+    //新增文件由 onNeedSendPictures 发送并写入数据库后才保存快照，写入前退出时下次启动重新比较
+    if (DeviceScanCache::reliableDirModifyTime(root)) {
+        m_pendingSnapshots.insert(snapshotKey(root), current);
+    }
+    qInfo() << "Reconciled" << root << "directories:" << current.size() << "changed:" << changedDirs.size()
+             << "new files:" << m_newFile.size() << "deleted files:" << m_deleteFile.size() << "elapsed(ms):" << timer.elapsed();
+}
+
+void FileInotify::removeWatchTree(const QString &dir)
+{
+    const QString prefix = dir + '/';
+    for (auto itr = m_watches.begin(); itr != m_watches.end();) {
+        if (itr.value() == dir || itr.value().startsWith(prefix)) {
+            //已删除目录的监听已被内核移除，此处失败可忽略
+            inotify_rm_watch(m_inotifyFd, itr.key());
+            itr = m_watches.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+}
+
+/**
+   @brief 先为新目录添加监听再遍历其中的文件，监听生效前写入的文件由遍历得到，之后的由事件得到
+ */
+void FileInotify::addNewDir(const QString &dir)
+{
+    addWatchTree(dir);
+    const QStringList files = LibUnionImage_NameSpace::walkFiles(dir, [this](const QString &fileName) {
+        return isSupported(fileName);
+    });
+    for (const QString &file : files) {
+        addFile(file);
+    }
+}
+
+void FileInotify::addFile(const QString &path)
+{
+    //符号链接使用其指向的路径
+    QFileInfo info(path);
+    const QString filePath = info.isSymLink() ? info.readSymLink() : path;
+    m_deleteFile.remove(filePath);
+    m_newFile.insert(filePath);
+}
+
+void FileInotify::removeFile(const QString &path)
+{
+    m_newFile.remove(path);
+    m_deleteFile.insert(path);
+}
+
+void FileInotify::removeDirFiles()
+{
+    if (m_removedDirs.isEmpty()) {
+        return;
+    }
+
+    //逐级查找记录的上级目录，耗时与记录数成线性关系
+    const QStringList albumPaths = DBManager::instance()->getPathsByAlbum(m_currentUID);
+    for (const QString &albumPath : albumPaths) {
+        for (int index = albumPath.lastIndexOf('/'); index > 0; index = albumPath.lastIndexOf('/', index - 1)) {
+            if (m_removedDirs.contains(albumPath.left(index))) {
+                removeFile(albumPath);
+                break;
+            }
+        }
+    }
+    m_removedDirs.clear();
+}
+
+bool FileInotify::isSupported(const QString &fileName) const
+{
+    return m_Supported.contains(QFileInfo(fileName).suffix().toUpper());
+}
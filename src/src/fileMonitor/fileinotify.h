@@ -7,9 +7,15 @@
 #define FILEINOTIFY_H
 
 #include <QObject>
+#include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QTimer>
-#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+
+#include "unionimage/dirwalker.h"
+
+struct inotify_event;
 
 class FileInotify : public QObject
 {
@@ -38,8 +44,32 @@ public slots:
     //发送插入
     void onNeedSendPictures();
 
+private slots:
+    //读取并处理 inotify 事件
+    void onInotifyEvents();
+
 private:
-    //检查是否新建了子文件夹
+    //处理单个 inotify 事件，直接得到增删的文件
+    void handleEvent(const struct inotify_event *event);
+    //为目录及其全部子目录添加监听，\a previous 中未变化的目录不再读取
+    void addWatchTree(const QString &dir, const LibUnionImage_NameSpace::DirSnapshot *previous = nullptr);
+    //移除目录及其全部子目录的监听
+    void removeWatchTree(const QString &dir);
+    //监听新出现的目录，并将其中已有的文件记为新增
+    void addNewDir(const QString &dir);
+    //记录新增、删除的文件
+    void addFile(const QString &path);
+    void removeFile(const QString &path);
+    //删除数据库中位于已移走目录下的记录
+    void removeDirFiles();
+    //文件名是否为支持的格式
+    bool isSupported(const QString &fileName) const;
+    //启动时与数据库同步，仅重新读取修改时间变化的目录
+    void reconcile();
+    void reconcileDir(const QString &root);
+    //监控目录的快照在数据库中的键
+    QString snapshotKey(const QString &root) const;
+    //重新为监控目录添加监听并检查待创建的目录
     void checkNewPath();
     //检查待创建的目录是否已经创建
     void checkPendingDirectories(const QString &changedPath);
@@ -47,17 +77,25 @@ private:
     void addParentWatcher(const QString &parentPath, const QString &targetChild);
 
     bool m_running = false;
-    QStringList m_newFile;      //当前新添加的
-    QStringList m_deleteFile;   //当前删除的
+    bool m_needRescan = false;  //事件丢失或监控目录被删除，需要重新扫描
+    bool m_reconciled = false;  //启动时是否已与数据库同步
+    QSet<QString> m_newFile;    //当前新添加的
+    QSet<QString> m_deleteFile; //当前删除的
+    QSet<QString> m_removedDirs; //当前批次事件中删除或移走的目录
     QStringList m_currentDirs;  //给定的当前监控路径
     QStringList m_pendingDirs;  //等待创建的目标目录
     QStringList m_parentDirs;   //当前监听的父级目录
     QMap<QString, QStringList> m_parentToChildren; //父级目录到子目录的映射
     QString m_currentAlbum;     //给定当前的相册
     int m_currentUID;           //给定当前的相册的UID
-    QStringList  m_Supported;   //支持的格式
+    QSet<QString> m_Supported;  //支持的格式
     QTimer *m_timer;
-    QFileSystemWatcher m_watcher; //实际执行监控的类
+    int m_inotifyFd = -1;       //实际执行监控的 inotify 实例
+    QSocketNotifier *m_notifier = nullptr;
+    QHash<int, QString> m_watches;        //监控目录的监听 QHash<wd, 目录>
+    QHash<int, QString> m_parentWatches;  //父级目录的监听 QHash<wd, 目录>
+    QHash<QString, LibUnionImage_NameSpace::DirSnapshot> m_snapshots; //上次同步时的监控目录快照 QHash<监控目录, 快照>
+    QHash<QString, LibUnionImage_NameSpace::DirSnapshot> m_pendingSnapshots; //同步结果写入数据库后保存的快照 QHash<快照键, 快照>
 };
 
 #endif // FILEINOTIFY_H
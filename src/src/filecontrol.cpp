@@ -9,6 +9,7 @@
 #include "printdialog/printhelper.h"
 #include "ocr/ocrinterface.h"
 #include "imagedata/imageinfo.h"
+#include "imagedata/imagetileprovider.h"
 
 #include <DSysInfo>
 
@@ -19,6 +20,8 @@
 #include <QUrl>
 #include <QDBusInterface>
 #include <QThread>
+#include <QThreadPool>
+#include <QPointer>
 #include <QProcess>
 #include <QGuiApplication>
 #include <QScreen>
@@ -387,6 +390,57 @@ bool FileControl::isRotatable(const QString &path)
     return bRet;
 }
 
+/**
+   @brief 判断 \a path 是否为分块加载的超大图像，已有判断结果时直接通知，
+        否则在线程中读取文件头信息，避免阻塞界面线程，完成后通过 tiledImageChecked() 通知
+ */
+void FileControl::checkTiledImage(const QString &path)
+{
+    QString localPath = LibUnionImage_NameSpace::localPath(path);
+    bool tiled = false;
+    if (ImageTileProvider::cachedTiledImage(localPath, tiled)) {
+        Q_EMIT tiledImageChecked(path, tiled);
+        return;
+    }
+
+    // QPointer 只在界面线程中检查，结果经由 qApp 投递，对象已销毁时丢弃
+    QPointer<FileControl> self(this);
+    QThreadPool::globalInstance()->start([self, path, localPath]() {
+        bool tiled = ImageTileProvider::isTiledImage(localPath);
+        QMetaObject::invokeMethod(qApp, [self, path, tiled]() {
+            if (self) {
+                Q_EMIT self->tiledImageChecked(path, tiled);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+int FileControl::imageTileSize()
+{
+    return ImageTileProvider::tileSize();
+}
+
+void FileControl::checkSvgTiledSize(const QString &path)
+{
+    QString localPath = LibUnionImage_NameSpace::localPath(path);
+    QSize size;
+    if (ImageTileProvider::cachedSvgTiledSize(localPath, size)) {
+        Q_EMIT svgTiledSizeChecked(path, size);
+        return;
+    }
+
+    // 解析矢量图文件耗时较长，在线程池中执行，结果投递方式同 checkTiledImage
+    QPointer<FileControl> self(this);
+    QThreadPool::globalInstance()->start([self, path, localPath]() {
+        QSize size = ImageTileProvider::svgTiledSize(localPath);
+        QMetaObject::invokeMethod(qApp, [self, path, size]() {
+            if (self) {
+                Q_EMIT self->svgTiledSizeChecked(path, size);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
 bool FileControl::isCanWrite(const QString &path)
 {
     QString localPath = LibUnionImage_NameSpace::localPath(path);
@@ -437,9 +491,11 @@ void FileControl::ocrImage(const QString &path, int index)
     if (Types::MultiImage != info.type()) {  // 非多页图使用路径直接进行识别
         m_ocrInterface->openFile(localPath);
     } else {  // 多页图需要确定识别哪一页
-        QImageReader imageReader(localPath);
-        imageReader.jumpToImage(index);
-        auto image = imageReader.read();
+        QImage image;
+        QString errMsg;
+        if (!LibUnionImage_NameSpace::loadImageFrame(localPath, index, image, errMsg)) {
+            qWarning() << "Failed to read image frame for ocr:" << localPath << index << errMsg;
+        }
         auto tempDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
         QDir dir(tempDir);
         if (!dir.exists()) {
@@ -1143,7 +1199,7 @@ bool FileControl::checkMimeUrls(const QList<QUrl> &urls)
         const QString path = LibUnionImage_NameSpace::localPath(url);
         QFileInfo fileinfo(path);
         if (fileinfo.isDir()) {
-            auto finfos = LibUnionImage_NameSpace::getImagesAndVideoInfo(path, false);
+            auto finfos = LibUnionImage_NameSpace::getImagesAndVideoInfo(path, true);
             for (auto finfo : finfos) {
                 if (LibUnionImage_NameSpace::imageSupportRead(finfo.absoluteFilePath()) || LibUnionImage_NameSpace::isVideo(finfo.absoluteFilePath())) {
                     return true;
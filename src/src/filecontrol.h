@@ -55,6 +55,9 @@ public:
     Q_INVOKABLE bool isCanRename(const QString &path);
     Q_INVOKABLE bool isCanReadable(const QString &path);
     Q_INVOKABLE bool isRotatable(const QString &path);  // 是否可以被选旋转
+    Q_INVOKABLE void checkTiledImage(const QString &path);  // 判断是否为分块加载的超大图像，通过 tiledImageChecked() 通知结果
+    Q_INVOKABLE int imageTileSize();                      // 超大图像分块大小
+    Q_INVOKABLE void checkSvgTiledSize(const QString &path);  // 获取矢量图分块加载时对应的光栅图像大小，通过 svgTiledSizeChecked() 通知结果
     Q_INVOKABLE bool isCanWrite(const QString &path);   // 是否可以被写入
     Q_INVOKABLE bool isCanDelete(const QString &path);  // 是否可以被删除
     Q_INVOKABLE bool isCanDelete(const QStringList &pathList);
@@ -103,6 +106,10 @@ public:
     Q_SIGNAL void imageRenamed(const QUrl &oldName, const QUrl &newName);
     // 文件变更通知信号，文件被移动、删除、覆盖等操作时触发
     Q_SIGNAL void imageFileChanged(const QString &fileName);
+    // 超大图像判断完成，\a tiled 表示 \a path 是否需要分块加载
+    Q_SIGNAL void tiledImageChecked(const QString &path, bool tiled);
+    // 矢量图解析完成，\a size 为 \a path 分块加载时对应的光栅图像大小，解析失败时为无效大小
+    Q_SIGNAL void svgTiledSizeChecked(const QString &path, const QSize &size);
 
 signals:
     // 通知相册刷新缩略图内容
@@ -0,0 +1,553 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "animationplayer.h"
+#include "unionimage/unionimage.h"
+#include "unionimage/mappedfile.h"
+
+#include <QBuffer>
+#include <QImageReader>
+#include <QMutex>
+#include <QPainter>
+#include <QQueue>
+#include <QThread>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <QDebug>
+
+static const qint64 s_ringBytes = 64LL * 1024 * 1024;        // 预解码环形缓冲区的内存上限 64MB
+static const qint64 s_keepFramesBytes = 32LL * 1024 * 1024;  // 全部帧不超过此大小时保留所有帧 32MB
+static const int s_minRingSize = 2;                          // 环形缓冲区最少帧数
+static const int s_maxRingSize = 16;                         // 环形缓冲区最多帧数
+static const int s_minFrameDelay = 20;                       // 最小帧时长(ms)，避免帧时长为 0 的动图占满 CPU
+static const int s_pollInterval = 5;                         // 等待解码线程时的检查间隔(ms)
+
+/**
+   @class AnimationFrameQueue
+   @brief 解码线程和界面线程间的帧队列，容量按内存预算计算，解码线程在队列满时等待，
+        限制预解码帧占用的内存
+   @threadsafe
+ */
+class AnimationFrameQueue
+{
+public:
+    explicit AnimationFrameQueue(int capacity)
+        : capacity(capacity)
+    {
+    }
+
+    /**
+       @brief 等待队列存在空闲位置
+       @return 队列已停止时返回 false
+     */
+    bool waitForSpace()
+    {
+        QMutexLocker _locker(&mutex);
+        while (!stopped && frames.size() >= capacity) {
+            notFull.wait(&mutex);
+        }
+        return !stopped;
+    }
+
+    /**
+       @brief 添加解码完成的帧 \a frame ，\a decodeTime 为解码耗时
+     */
+    void push(const AnimationFrame &frame, qint64 decodeTime)
+    {
+        QMutexLocker _locker(&mutex);
+        frames.enqueue(frame);
+        decodeStat.decodedFrames++;
+        decodeStat.decodeTime += decodeTime;
+        decodeStat.maxDecodeTime = qMax(decodeStat.maxDecodeTime, decodeTime);
+    }
+
+    /**
+       @return 取出待显示的帧至 \a frame ，队列为空时返回 false
+     */
+    bool take(AnimationFrame &frame)
+    {
+        QMutexLocker _locker(&mutex);
+        if (frames.isEmpty()) {
+            return false;
+        }
+        frame = frames.dequeue();
+        notFull.wakeAll();
+        return true;
+    }
+
+    /**
+       @brief 解码结束，\a error 标识是否因解码错误结束
+     */
+    void finish(bool error)
+    {
+        QMutexLocker _locker(&mutex);
+        finished = true;
+        hasError = error;
+    }
+
+    bool isFinished()
+    {
+        QMutexLocker _locker(&mutex);
+        return finished;
+    }
+
+    bool isError()
+    {
+        QMutexLocker _locker(&mutex);
+        return hasError;
+    }
+
+    void stop()
+    {
+        QMutexLocker _locker(&mutex);
+        stopped = true;
+        notFull.wakeAll();
+    }
+
+    bool isStopped()
+    {
+        QMutexLocker _locker(&mutex);
+        return stopped;
+    }
+
+    AnimationPlayer::Statistics statistics()
+    {
+        QMutexLocker _locker(&mutex);
+        return decodeStat;
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition notFull;
+    QQueue<AnimationFrame> frames;  ///< 已解码待显示的帧
+    const int capacity;
+    bool stopped { false };
+    bool finished { false };
+    bool hasError { false };
+    AnimationPlayer::Statistics decodeStat;  ///< 仅使用解码相关的统计字段
+};
+
+/**
+   @class AnimationDecodeThread
+   @brief 动态图解码线程，按顺序解码帧数据至帧队列，播放至末尾后从首帧重新解码。
+        保留所有帧时解码一轮后结束
+ */
+class AnimationDecodeThread : public QThread
+{
+public:
+    AnimationDecodeThread(const QString &path, int frameCount, const QSharedPointer<AnimationFrameQueue> &queue, bool keepFrames)
+        : filePath(path)
+        , frameCount(frameCount)
+        , queue(queue)
+        , keepFrames(keepFrames)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        // 解码共享文件映射，循环播放时无需重新读取文件
+        LibUnionImage_NameSpace::MappedFile mapped(filePath);
+        QBuffer buffer;
+        if (mapped.isValid()) {
+            buffer.setData(mapped.data());
+            buffer.open(QIODevice::ReadOnly);
+        }
+
+        QImageReader reader;
+        auto resetReader = [&]() {
+            reader.setDevice(nullptr);
+            if (mapped.isValid()) {
+                buffer.seek(0);
+                reader.setDevice(&buffer);
+            } else {
+                reader.setFileName(filePath);
+            }
+        };
+        resetReader();
+
+        int index = 0;
+        while (!queue->isStopped()) {
+            // 播放至末尾
+            if ((frameCount > 0 && index >= frameCount) || !reader.canRead()) {
+                if (0 == index) {
+                    qWarning() << "Failed to decode animation:" << filePath << reader.errorString();
+                    queue->finish(true);
+                    return;
+                }
+                if (keepFrames) {
+                    break;
+                }
+                resetReader();
+                index = 0;
+                continue;
+            }
+
+            if (!queue->waitForSpace()) {
+                break;
+            }
+
+            QImage image;
+            QElapsedTimer decodeTimer;
+            decodeTimer.start();
+            if (!reader.read(&image)) {
+                qWarning() << "Failed to decode animation frame:" << filePath << "frame:" << index << reader.errorString();
+                if (0 == index) {
+                    queue->finish(true);
+                    return;
+                }
+                // 后续帧数据异常时按已解码的帧循环播放
+                frameCount = index;
+                continue;
+            }
+
+            AnimationFrame frame;
+            // 在解码线程中转换为显示格式，绘制时无需再转换
+            frame.image = LibUnionImage_NameSpace::toDisplayFormat(image);
+            frame.index = index++;
+            frame.delay = reader.nextImageDelay();
+            queue->push(frame, decodeTimer.elapsed());
+        }
+
+        queue->finish(false);
+    }
+
+private:
+    QString filePath;
+    int frameCount;
+    QSharedPointer<AnimationFrameQueue> queue;
+    bool keepFrames;
+};
+
+AnimationPlayer::AnimationPlayer(QQuickItem *parent)
+    : QQuickPaintedItem(parent)
+{
+    frameTimer.setSingleShot(true);
+    connect(&frameTimer, &QTimer::timeout, this, &AnimationPlayer::showNextFrame);
+}
+
+AnimationPlayer::~AnimationPlayer()
+{
+    stopDecode();
+}
+
+/**
+   @return 动态图文件地址
+ */
+QUrl AnimationPlayer::source() const
+{
+    return sourceUrl;
+}
+
+/**
+   @brief 设置动态图文件地址 \a source ，停止当前播放并重新开始解码
+ */
+void AnimationPlayer::setSource(const QUrl &source)
+{
+    if (sourceUrl == source) {
+        return;
+    }
+
+    stopDecode();
+    sourceUrl = source;
+    Q_EMIT sourceChanged();
+
+    if (sourceUrl.isEmpty()) {
+        setStatus(Null);
+        update();
+        return;
+    }
+    startDecode();
+}
+
+/**
+   @return 是否正在播放
+ */
+bool AnimationPlayer::playing() const
+{
+    return isPlaying;
+}
+
+/**
+   @brief 设置是否播放 \a playing ，暂停时解码线程填满缓冲区后等待
+ */
+void AnimationPlayer::setPlaying(bool playing)
+{
+    if (isPlaying == playing) {
+        return;
+    }
+
+    isPlaying = playing;
+    if (isPlaying) {
+        if (frameQueue) {
+            nextFrameTime = playClock.elapsed();
+            frameTimer.start(0);
+        }
+    } else {
+        frameTimer.stop();
+    }
+    Q_EMIT playingChanged();
+}
+
+/**
+   @return 加载状态，首帧显示前为 Loading
+ */
+AnimationPlayer::Status AnimationPlayer::status() const
+{
+    return loadStatus;
+}
+
+/**
+   @return 按比例适应组件大小后的显示宽度，同 Image.paintedWidth
+ */
+qreal AnimationPlayer::paintedWidth() const
+{
+    return paintedRect().width();
+}
+
+/**
+   @return 按比例适应组件大小后的显示高度，同 Image.paintedHeight
+ */
+qreal AnimationPlayer::paintedHeight() const
+{
+    return paintedRect().height();
+}
+
+/**
+   @return 动态图总帧数
+ */
+int AnimationPlayer::frameCount() const
+{
+    return totalFrames;
+}
+
+/**
+   @return 当前显示的帧索引
+ */
+int AnimationPlayer::currentFrame() const
+{
+    return frameIndex;
+}
+
+/**
+   @return 当前播放的统计信息，包含解码线程的统计
+ */
+AnimationPlayer::Statistics AnimationPlayer::statistics() const
+{
+    Statistics ret = stat;
+    if (frameQueue) {
+        const Statistics decodeStat = frameQueue->statistics();
+        ret.decodedFrames = decodeStat.decodedFrames;
+        ret.decodeTime = decodeStat.decodeTime;
+        ret.maxDecodeTime = decodeStat.maxDecodeTime;
+    }
+    return ret;
+}
+
+/**
+   @return 当前播放的统计信息，提供给 QML 使用
+ */
+QVariantMap AnimationPlayer::statisticsMap() const
+{
+    const Statistics ret = statistics();
+    QVariantMap map;
+    map.insert("decodedFrames", ret.decodedFrames);
+    map.insert("averageDecodeTime", ret.decodedFrames > 0 ? qreal(ret.decodeTime) / ret.decodedFrames : 0);
+    map.insert("maxDecodeTime", ret.maxDecodeTime);
+    map.insert("displayedFrames", ret.displayedFrames);
+    map.insert("cachedFrames", ret.cachedFrames);
+    map.insert("lateFrames", ret.lateFrames);
+    map.insert("maxLateness", ret.maxLateness);
+    return map;
+}
+
+/**
+   @brief 打印播放统计信息
+ */
+void AnimationPlayer::dumpStatistics() const
+{
+    const Statistics ret = statistics();
+    if (0 == ret.displayedFrames) {
+        return;
+    }
+
+    qInfo() << QString("[AnimationPlayer] %1 decoded: %2 (avg: %3 ms, max: %4 ms), displayed: %5 (cached: %6), late: %7 (max: %8 ms)")
+                   .arg(sourceUrl.toString())
+                   .arg(ret.decodedFrames)
+                   .arg(ret.decodedFrames > 0 ? qreal(ret.decodeTime) / ret.decodedFrames : 0, 0, 'f', 1)
+                   .arg(ret.maxDecodeTime)
+                   .arg(ret.displayedFrames)
+                   .arg(ret.cachedFrames)
+                   .arg(ret.lateFrames)
+                   .arg(ret.maxLateness);
+}
+
+/**
+   @brief 按比例适应组件大小绘制当前帧
+ */
+void AnimationPlayer::paint(QPainter *painter)
+{
+    if (currentImage.isNull()) {
+        return;
+    }
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth());
+    painter->drawImage(paintedRect(), currentImage);
+}
+
+void AnimationPlayer::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickPaintedItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        notifyPaintedGeometry();
+    }
+}
+
+/**
+   @brief 启动解码线程，根据单帧数据大小计算缓冲区容量，帧数据较小时保留所有帧
+ */
+void AnimationPlayer::startDecode()
+{
+    const QString path = LibUnionImage_NameSpace::localPath(sourceUrl);
+    imageSize = QImageReader(path).size();
+    totalFrames = LibUnionImage_NameSpace::getFrameCount(path);
+    setImplicitSize(imageSize.width(), imageSize.height());
+    Q_EMIT frameCountChanged();
+    notifyPaintedGeometry();
+
+    // 解码输出为 32 位图像
+    const qint64 frameBytes = qMax<qint64>(1, qint64(imageSize.width()) * imageSize.height() * 4);
+    keepFrames = totalFrames > 0 && totalFrames * frameBytes <= s_keepFramesBytes;
+    const int capacity = keepFrames ? totalFrames : int(qBound<qint64>(s_minRingSize, s_ringBytes / frameBytes, s_maxRingSize));
+    qDebug() << "Start animation decode:" << path << "frames:" << totalFrames << "size:" << imageSize
+             << "ring capacity:" << capacity << "keep frames:" << keepFrames;
+
+    stat = Statistics();
+    frameQueue.reset(new AnimationFrameQueue(capacity));
+    decodeThread = new AnimationDecodeThread(path, totalFrames, frameQueue, keepFrames);
+    decodeThread->start();
+
+    setStatus(Loading);
+    playClock.start();
+    nextFrameTime = 0;
+    waitingFrame = false;
+    frameTimer.start(0);
+}
+
+/**
+   @brief 停止解码线程，清理帧数据
+ */
+void AnimationPlayer::stopDecode()
+{
+    frameTimer.stop();
+    if (frameQueue) {
+        dumpStatistics();
+        frameQueue->stop();
+    }
+    if (decodeThread) {
+        // 解码线程仅需完成当前帧的解码即可退出
+        decodeThread->wait();
+        delete decodeThread;
+        decodeThread = nullptr;
+    }
+
+    frameQueue.reset();
+    currentImage = QImage();
+    cachedFrames.clear();
+    cachedIndex = 0;
+    frameIndex = 0;
+}
+
+/**
+   @brief 显示下一帧，依次从解码队列或已保留的帧中获取，解码未完成时稍后重试
+ */
+void AnimationPlayer::showNextFrame()
+{
+    // 暂停时仍显示首帧
+    if (!frameQueue || (!isPlaying && !currentImage.isNull())) {
+        return;
+    }
+
+    AnimationFrame frame;
+    if (frameQueue->take(frame)) {
+        if (keepFrames) {
+            cachedFrames.append(frame);
+        }
+    } else if (keepFrames && !cachedFrames.isEmpty() && frameQueue->isFinished()) {
+        frame = cachedFrames.at(cachedIndex);
+        cachedIndex = (cachedIndex + 1) % cachedFrames.size();
+        stat.cachedFrames++;
+    } else if (frameQueue->isError()) {
+        setStatus(Error);
+        return;
+    } else if (frameQueue->isFinished() && !currentImage.isNull()) {
+        // 仅有单帧数据，无需继续播放
+        return;
+    } else {
+        // 解码未跟上播放进度，记录一次延迟并稍后重试
+        if (!waitingFrame && Ready == loadStatus) {
+            waitingFrame = true;
+            stat.lateFrames++;
+        }
+        frameTimer.start(s_pollInterval);
+        return;
+    }
+
+    const qint64 now = playClock.elapsed();
+    if (Ready == loadStatus) {
+        stat.maxLateness = qMax(stat.maxLateness, now - nextFrameTime);
+    }
+    waitingFrame = false;
+
+    currentImage = frame.image;
+    if (imageSize != currentImage.size()) {
+        imageSize = currentImage.size();
+        setImplicitSize(imageSize.width(), imageSize.height());
+        notifyPaintedGeometry();
+    }
+    if (frameIndex != frame.index) {
+        frameIndex = frame.index;
+        Q_EMIT currentFrameChanged();
+    }
+    stat.displayedFrames++;
+    setStatus(Ready);
+    update();
+
+    const int delay = qMax(frame.delay, s_minFrameDelay);
+    nextFrameTime = now + delay;
+    if (isPlaying) {
+        frameTimer.start(delay);
+    }
+}
+
+/**
+   @brief 通知绘制区域变更，信号同 Image 的 paintedGeometryChanged
+ */
+void AnimationPlayer::notifyPaintedGeometry()
+{
+    Q_EMIT paintedWidthChanged();
+    Q_EMIT paintedHeightChanged();
+    Q_EMIT paintedGeometryChanged();
+}
+
+void AnimationPlayer::setStatus(Status status)
+{
+    if (loadStatus != status) {
+        loadStatus = status;
+        Q_EMIT statusChanged();
+    }
+}
+
+/**
+   @return 图像按比例适应组件大小并居中的绘制区域
+ */
+QRectF AnimationPlayer::paintedRect() const
+{
+    if (imageSize.isEmpty() || width() <= 0 || height() <= 0) {
+        return QRectF();
+    }
+
+    QSizeF painted = QSizeF(imageSize).scaled(QSizeF(width(), height()), Qt::KeepAspectRatio);
+    return QRectF(QPointF((width() - painted.width()) / 2, (height() - painted.height()) / 2), painted);
+}
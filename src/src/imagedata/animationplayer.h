@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ANIMATIONPLAYER_H
+#define ANIMATIONPLAYER_H
+
+#include <QQuickPaintedItem>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QImage>
+#include <QTimer>
+#include <QUrl>
+
+class AnimationFrameQueue;
+class AnimationDecodeThread;
+
+// 动态图帧数据
+struct AnimationFrame
+{
+    QImage image;
+    int index { 0 };  // 帧索引
+    int delay { 0 };  // 显示时长(ms)
+};
+
+// 动态图播放组件，后台线程预先解码帧数据至环形缓冲区，界面线程仅按帧时长切换显示
+class AnimationPlayer : public QQuickPaintedItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(bool playing READ playing WRITE setPlaying NOTIFY playingChanged)
+    Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(qreal paintedWidth READ paintedWidth NOTIFY paintedWidthChanged)
+    Q_PROPERTY(qreal paintedHeight READ paintedHeight NOTIFY paintedHeightChanged)
+    Q_PROPERTY(int frameCount READ frameCount NOTIFY frameCountChanged)
+    Q_PROPERTY(int currentFrame READ currentFrame NOTIFY currentFrameChanged)
+
+public:
+    // 取值与 Image.Status 一致，可直接与 Image.Ready 等比较
+    enum Status { Null, Ready, Loading, Error };
+    Q_ENUM(Status)
+
+    // 播放统计信息
+    struct Statistics
+    {
+        qint64 decodedFrames { 0 };     // 解码帧数
+        qint64 decodeTime { 0 };        // 解码总耗时(ms)
+        qint64 maxDecodeTime { 0 };     // 单帧最大解码耗时(ms)
+        qint64 displayedFrames { 0 };   // 显示帧数
+        qint64 cachedFrames { 0 };      // 从缓存显示的帧数(无需解码)
+        qint64 lateFrames { 0 };        // 解码未及时完成导致延迟显示的帧数
+        qint64 maxLateness { 0 };       // 单帧最大延迟(ms)
+    };
+
+    explicit AnimationPlayer(QQuickItem *parent = nullptr);
+    ~AnimationPlayer() override;
+
+    QUrl source() const;
+    void setSource(const QUrl &source);
+    Q_SIGNAL void sourceChanged();
+
+    bool playing() const;
+    void setPlaying(bool playing);
+    Q_SIGNAL void playingChanged();
+
+    Status status() const;
+    Q_SIGNAL void statusChanged();
+
+    qreal paintedWidth() const;
+    Q_SIGNAL void paintedWidthChanged();
+    qreal paintedHeight() const;
+    Q_SIGNAL void paintedHeightChanged();
+    Q_SIGNAL void paintedGeometryChanged();
+
+    int frameCount() const;
+    Q_SIGNAL void frameCountChanged();
+    int currentFrame() const;
+    Q_SIGNAL void currentFrameChanged();
+
+    Statistics statistics() const;
+    Q_INVOKABLE QVariantMap statisticsMap() const;
+    void dumpStatistics() const;
+
+    void paint(QPainter *painter) override;
+
+protected:
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    void startDecode();
+    void stopDecode();
+    void showNextFrame();
+    void setStatus(Status status);
+    void notifyPaintedGeometry();
+    QRectF paintedRect() const;
+
+private:
+    QUrl sourceUrl;
+    bool isPlaying { true };
+    Status loadStatus { Null };
+    QSize imageSize;
+    int totalFrames { 0 };
+    int frameIndex { 0 };
+
+    QImage currentImage;
+    bool keepFrames { false };          ///< 帧数据较小时保留所有帧，循环播放无需重复解码
+    QList<AnimationFrame> cachedFrames;
+    int cachedIndex { 0 };
+
+    QSharedPointer<AnimationFrameQueue> frameQueue;
+    AnimationDecodeThread *decodeThread { nullptr };
+
+    QTimer frameTimer;
+    QElapsedTimer playClock;
+    qint64 nextFrameTime { 0 };         ///< 下一帧预期显示的时间
+    bool waitingFrame { false };        ///< 等待解码线程提供帧数据
+    Statistics stat;
+};
+
+#endif  // ANIMATIONPLAYER_H
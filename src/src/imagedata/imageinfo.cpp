@@ -158,12 +158,11 @@ void LoadImageInfoRunnable::run()
         return;
     }
 
-    QImageReader reader(loadPath);
     if (Types::MultiImage == data->type) {
         qDebug() << "Loading multi-page image:" << loadPath << "frame:" << frameIndex;
-        reader.jumpToImage(frameIndex);
-        QImage image = reader.read();
-        if (image.isNull()) {
+        QImage image;
+        QString error;
+        if (!LibUnionImage_NameSpace::loadImageFrame(loadPath, frameIndex, image, error)) {
             qWarning() << "Failed to read multi-page image frame:" << loadPath << "frame:" << frameIndex;
             // 数据获取异常
             data->type = Types::DamagedImage;
@@ -172,10 +171,11 @@ void LoadImageInfoRunnable::run()
         }
 
         data->size = image.size();
-        data->frameCount = reader.imageCount();
+        // 帧数取自持久化的帧索引，无需遍历所有页
+        data->frameCount = LibUnionImage_NameSpace::getFrameCount(loadPath);
         qDebug() << "Multi-page image loaded successfully:" << loadPath << "size:" << data->size << "total frames:" << data->frameCount;
-        // 保存图片比例缩放
-        image = image.scaled(100, 100, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        // 保存图片比例缩放，在加载线程中转换为显示格式
+        image = LibUnionImage_NameSpace::toDisplayFormat(image.scaled(100, 100, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
         // 缓存缩略图信息
         ThumbnailCache::instance()->add(data->path, frameIndex, image);
 
@@ -215,8 +215,8 @@ bool LoadImageInfoRunnable::loadImage(QImage &image, QSize &sourceSize) const
     if (ret) {
         sourceSize = image.size();
         qDebug() << "Static image loaded successfully:" << loadPath << "size:" << sourceSize;
-        // 保存图片比例缩放
-        image = image.scaled(100, 100, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        // 保存图片比例缩放，在加载线程中转换为显示格式
+        image = LibUnionImage_NameSpace::toDisplayFormat(image.scaled(100, 100, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
     } else {
         qWarning() << "Failed to load static image:" << loadPath << "error:" << error;
     }
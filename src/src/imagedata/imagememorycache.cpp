@@ -0,0 +1,236 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "imagememorycache.h"
+
+#include <QDebug>
+
+#include <unistd.h>
+
+static const qint64 s_minCacheBytes = 256LL * 1024 * 1024;  // 最小缓存 256MB
+static const qint64 s_maxCacheBytes = 2048LL * 1024 * 1024;  // 最大缓存 2GB
+static const int s_memoryRatio = 8;  // 缓存占物理内存的比例 1/8
+static const int s_maxCacheCount = 64;  // 最大缓存数量，限制异常图片(空图像)等小数据的累积
+static const qint64 s_minImageCost = 4 * 1024;  // 单张图像的最小计算数据量
+
+/**
+   @class ImageMemoryCache
+   @brief 图像内存缓存，按 QImage::sizeInBytes() 计算占用，超出容量时淘汰最近最少使用的图像。
+        固定的图片(当前显示及相邻的图片)不会被淘汰，即使缓存已超出容量。
+   @threadsafe
+ */
+ImageMemoryCache::ImageMemoryCache()
+{
+    stat.maxBytes = defaultMaxBytes();
+    qDebug() << "ImageMemoryCache initialized with max bytes:" << stat.maxBytes;
+}
+
+ImageMemoryCache::~ImageMemoryCache()
+{
+    qDebug() << "ImageMemoryCache destroyed";
+}
+
+/**
+   @return 返回缓存中是否存在文件路径为 \a path 和图片帧索引为 \a frameIndex 的图像
+ */
+bool ImageMemoryCache::contains(const QString &path, int frameIndex)
+{
+    QMutexLocker _locker(&mutex);
+    return cache.contains(qMakePair(path, frameIndex));
+}
+
+/**
+   @return 返回缓存中文件路径为 \a path 和图片帧索引为 \a frameIndex 的图像，并更新访问记录
+ */
+QImage ImageMemoryCache::get(const QString &path, int frameIndex)
+{
+    QMutexLocker _locker(&mutex);
+    auto itr = cache.find(qMakePair(path, frameIndex));
+    if (itr == cache.end()) {
+        stat.misses++;
+        return QImage();
+    }
+
+    stat.hits++;
+    itr->lastUsed = ++useCounter;
+    return itr->image;
+}
+
+/**
+   @brief 添加文件路径为 \a path 和图片帧索引为 \a frameIndex 的图像，超出容量时淘汰旧的图像
+ */
+void ImageMemoryCache::add(const QString &path, int frameIndex, const QImage &image)
+{
+    QMutexLocker _locker(&mutex);
+    Key key = qMakePair(path, frameIndex);
+    auto itr = cache.find(key);
+    if (itr != cache.end()) {
+        stat.usedBytes -= itr->cost;
+        cache.erase(itr);
+    }
+
+    Entry entry;
+    entry.image = image;
+    entry.cost = imageCost(image);
+    entry.lastUsed = ++useCounter;
+    cache.insert(key, entry);
+    stat.usedBytes += entry.cost;
+    qDebug() << "Added image to memory cache:" << path << "frame:" << frameIndex << "bytes:" << entry.cost << "used:" << stat.usedBytes;
+
+    trim();
+}
+
+/**
+   @brief 移除文件路径为 \a path 和图片帧索引为 \a frameIndex 的图像
+ */
+void ImageMemoryCache::remove(const QString &path, int frameIndex)
+{
+    QMutexLocker _locker(&mutex);
+    auto itr = cache.find(qMakePair(path, frameIndex));
+    if (itr != cache.end()) {
+        stat.usedBytes -= itr->cost;
+        cache.erase(itr);
+    }
+}
+
+/**
+   @brief 清空缓存的图像
+ */
+void ImageMemoryCache::clear()
+{
+    QMutexLocker _locker(&mutex);
+    cache.clear();
+    stat.usedBytes = 0;
+}
+
+/**
+   @return 返回缓存的图像索引
+ */
+QList<ImageMemoryCache::Key> ImageMemoryCache::keys()
+{
+    QMutexLocker _locker(&mutex);
+    return cache.keys();
+}
+
+/**
+   @brief 设置缓存容量为 \a maxBytes 字节
+ */
+void ImageMemoryCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker _locker(&mutex);
+    stat.maxBytes = maxBytes;
+    qDebug() << "Set image memory cache max bytes to:" << maxBytes;
+    trim();
+}
+
+/**
+   @brief 设置固定的图片路径为 \a paths ，固定的图片不会被淘汰，之前固定的图片恢复为可淘汰状态
+ */
+void ImageMemoryCache::setPinnedPaths(const QStringList &paths)
+{
+    QMutexLocker _locker(&mutex);
+    pinnedPaths = QSet<QString>(paths.begin(), paths.end());
+    trim();
+}
+
+/**
+   @return 文件路径为 \a path 、数据量为 \a bytes 的图像加入缓存后是否能保留，
+        固定的图片已占满容量时，未固定的图像加入后将立即被淘汰
+ */
+bool ImageMemoryCache::canHold(const QString &path, qint64 bytes)
+{
+    QMutexLocker _locker(&mutex);
+    if (pinnedPaths.contains(path)) {
+        return true;
+    }
+
+    qint64 pinnedBytes = 0;
+    for (auto itr = cache.constBegin(); itr != cache.constEnd(); ++itr) {
+        if (pinnedPaths.contains(itr.key().first)) {
+            pinnedBytes += itr->cost;
+        }
+    }
+    return pinnedBytes + qMax(s_minImageCost, bytes) <= stat.maxBytes;
+}
+
+/**
+   @return 返回缓存统计信息
+ */
+ImageMemoryCache::Statistics ImageMemoryCache::statistics()
+{
+    QMutexLocker _locker(&mutex);
+    Statistics ret = stat;
+    ret.count = cache.size();
+    return ret;
+}
+
+/**
+   @brief 打印缓存统计信息
+ */
+void ImageMemoryCache::dumpStatistics()
+{
+    Statistics ret = statistics();
+    qInfo() << QString("[ImageMemoryCache] hits: %1, misses: %2, evictions: %3, evicted bytes: %4, used: %5/%6 bytes, count: %7")
+                   .arg(ret.hits)
+                   .arg(ret.misses)
+                   .arg(ret.evictions)
+                   .arg(ret.evictedBytes)
+                   .arg(ret.usedBytes)
+                   .arg(ret.maxBytes)
+                   .arg(ret.count);
+}
+
+/**
+   @return 根据物理内存计算默认的缓存容量，取物理内存的 1/8 ，限制在 256MB ~ 2GB 之间
+ */
+qint64 ImageMemoryCache::defaultMaxBytes()
+{
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0) {
+        qWarning() << "Failed to get physical memory size, using minimum cache size";
+        return s_minCacheBytes;
+    }
+
+    qint64 physicalBytes = static_cast<qint64>(pages) * pageSize;
+    return qBound(s_minCacheBytes, physicalBytes / s_memoryRatio, s_maxCacheBytes);
+}
+
+/**
+   @return 返回图像 \a image 计入缓存的数据量
+ */
+qint64 ImageMemoryCache::imageCost(const QImage &image)
+{
+    return qMax(s_minImageCost, static_cast<qint64>(image.sizeInBytes()));
+}
+
+/**
+   @brief 淘汰最近最少使用且未固定的图像，直至缓存占用不超过容量
+   @note 调用前需持有锁
+ */
+void ImageMemoryCache::trim()
+{
+    while (stat.usedBytes > stat.maxBytes || cache.size() > s_maxCacheCount) {
+        auto oldest = cache.end();
+        for (auto itr = cache.begin(); itr != cache.end(); ++itr) {
+            if (pinnedPaths.contains(itr.key().first)) {
+                continue;
+            }
+            if (oldest == cache.end() || itr->lastUsed < oldest->lastUsed) {
+                oldest = itr;
+            }
+        }
+
+        // 剩余均为固定的图像
+        if (oldest == cache.end()) {
+            break;
+        }
+
+        qDebug() << "Evicting image from memory cache:" << oldest.key().first << "frame:" << oldest.key().second << "bytes:" << oldest->cost;
+        stat.usedBytes -= oldest->cost;
+        stat.evictions++;
+        stat.evictedBytes += oldest->cost;
+        cache.erase(oldest);
+    }
+}
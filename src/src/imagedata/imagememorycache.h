@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IMAGEMEMORYCACHE_H
+#define IMAGEMEMORYCACHE_H
+
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QImage>
+
+// 按图像数据字节数计算容量的图像缓存，用于缓存完整分辨率的图像
+class ImageMemoryCache
+{
+public:
+    typedef QPair<QString, int> Key;
+
+    // 缓存统计信息
+    struct Statistics
+    {
+        qint64 hits { 0 };          // 命中次数
+        qint64 misses { 0 };        // 未命中次数
+        qint64 evictions { 0 };     // 淘汰次数
+        qint64 evictedBytes { 0 };  // 淘汰的数据量
+        qint64 usedBytes { 0 };     // 当前占用的数据量
+        qint64 maxBytes { 0 };      // 缓存容量
+        int count { 0 };            // 当前缓存的图像数量
+    };
+
+    ImageMemoryCache();
+    ~ImageMemoryCache();
+
+    bool contains(const QString &path, int frameIndex = 0);
+    QImage get(const QString &path, int frameIndex = 0);
+    void add(const QString &path, int frameIndex, const QImage &image);
+    void remove(const QString &path, int frameIndex);
+    void clear();
+    QList<Key> keys();
+
+    void setMaxBytes(qint64 maxBytes);
+    void setPinnedPaths(const QStringList &paths);
+    bool canHold(const QString &path, qint64 bytes);
+
+    Statistics statistics();
+    void dumpStatistics();
+
+    static qint64 defaultMaxBytes();
+
+private:
+    struct Entry
+    {
+        QImage image;
+        qint64 cost { 0 };
+        quint64 lastUsed { 0 };
+    };
+
+    static qint64 imageCost(const QImage &image);
+    void trim();
+
+private:
+    QMutex mutex;
+    QHash<Key, Entry> cache;
+    QSet<QString> pinnedPaths;  ///< 固定的图片路径，当前显示及相邻的图片不会被淘汰
+    quint64 useCounter { 0 };   ///< 访问计数，用于判断最近最少使用的图像
+    Statistics stat;
+};
+
+#endif  // IMAGEMEMORYCACHE_H
@@ -5,13 +5,21 @@
 #include "imageprovider.h"
 #include "unionimage/unionimage.h"
 #include "imagedata/thumbnailcache.h"
+#include "imagedata/imagetileprovider.h"
+#include "imagedata/svgrastercache.h"
+#include "imageengine/imagedataservice.h"
 
 #include <QThread>
 #include <QThreadPool>
 #include <QRunnable>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImageReader>
 #include <QDebug>
 
 static const QString s_tagFrame = "#frame_";
+// 超大图像预览图的缓存帧索引，与完整图像(帧索引 0)区分
+static const int s_tiledPreviewFrame = -1;
 
 /**
    @brief 解析图像处理器 \a id , 取得请求的文件路径 \a filePath 和 \a frameIndex
@@ -47,7 +55,8 @@ static QImage readNormalImage(const QString &imagePath)
     } else {
         qDebug() << "Successfully loaded image:" << imagePath << "size:" << image.size();
     }
-    return image;
+    // 在解码线程中统一转换为显示格式，缓存及上传纹理时无需再转换
+    return LibUnionImage_NameSpace::toDisplayFormat(image);
 }
 
 /**
@@ -56,23 +65,83 @@ static QImage readNormalImage(const QString &imagePath)
 static QImage readMultiImage(const QString &imagePath, int frameIndex)
 {
     qDebug() << "Reading multi-page image:" << imagePath << "frame:" << frameIndex;
-    // 重新设置图像读取类
-    QImageReader reader(imagePath);
+    // 通过帧索引读取指定页，无需从首页逐页查找
+    QImage image;
+    QString error;
+    if (LibUnionImage_NameSpace::loadImageFrame(imagePath, frameIndex, image, error)) {
+        qDebug() << "Successfully loaded multi-page image frame:" << imagePath << "frame:" << frameIndex << "size:" << image.size();
+    } else {
+        qWarning() << "Failed to read multi-page image frame:" << imagePath << "frame:" << frameIndex << "error:" << error;
+    }
+    return LibUnionImage_NameSpace::toDisplayFormat(image);
+}
 
-    if (reader.jumpToImage(frameIndex)) {
-        // 读取图像数据
-        QImage image = reader.read();
+// 快速预览图大小
+static const int s_previewSize = 256;
+
+/**
+   @brief 快速读取 \a imagePath 的预览图，用于完整图像解码完成前的占位显示
+        优先使用相册已生成的等比例缩略图文件，其次使用解码器支持缩放解码的格式(如 JPEG DCT 缩放)直接解码小图
+   @return 预览图，无法快速获取时返回空图像
+ */
+static QImage readFastPreview(const QString &imagePath)
+{
+    // 相册已加载过的等比例缩略图，未加载过时不读取文件计算缩略图路径
+    QString thumbnailPath = ImageDataService::instance()->knownThumbnailPath(imagePath);
+    if (!thumbnailPath.isEmpty()) {
+        thumbnailPath = ImageDataService::instance()->getScaledPath(thumbnailPath);
+    }
+    if (!thumbnailPath.isEmpty() && QFile::exists(thumbnailPath)) {
+        QImage image(thumbnailPath, "PNG");
         if (!image.isNull()) {
-            qDebug() << "Successfully loaded multi-page image frame:" << imagePath << "frame:" << frameIndex << "size:" << image.size();
-        } else {
-            qWarning() << "Failed to read multi-page image frame:" << imagePath << "frame:" << frameIndex;
+            qDebug() << "Using album thumbnail as preview:" << thumbnailPath;
+            return LibUnionImage_NameSpace::toDisplayFormat(image);
+        }
+    }
+
+    // 矢量图按预览大小光栅化，相近大小的请求复用缓存
+    if (SvgRasterCache::isSvgFile(imagePath)) {
+        return SvgRasterCache::instance()->image(imagePath, QSize(s_previewSize, s_previewSize));
+    }
+
+    // 解码器原生支持缩放解码时，直接解码小图
+    QImageReader reader(imagePath);
+    if (reader.supportsOption(QImageIOHandler::ScaledSize)) {
+        QSize imageSize = reader.size();
+        if (imageSize.isValid()) {
+            reader.setAutoTransform(true);
+            reader.setScaledSize(imageSize.scaled(s_previewSize, s_previewSize, Qt::KeepAspectRatio));
+            QImage image = reader.read();
+            if (!image.isNull()) {
+                qDebug() << "Using scaled decode as preview:" << imagePath << image.size();
+                return LibUnionImage_NameSpace::toDisplayFormat(image);
+            }
         }
-        return image;
     }
-    qWarning() << "Failed to jump to frame:" << frameIndex << "in image:" << imagePath;
+
     return QImage();
 }
 
+/**
+   @brief 超大图像按请求大小 \a requestedSize 解码预览图并缓存至 \a cache ，放大后的细节由 ImageTileProvider 分块提供
+   @return 是否为分块加载的超大图像，非超大图像返回 false ，使用完整加载流程
+ */
+static bool readTiledPreview(ImageMemoryCache &cache, const QString &imagePath, const QSize &requestedSize, QImage &image)
+{
+    if (!requestedSize.isValid() || !ImageTileProvider::isTiledImage(imagePath)) {
+        return false;
+    }
+
+    // 缓存的预览图不小于请求大小时直接使用
+    image = cache.get(imagePath, s_tiledPreviewFrame);
+    if (image.isNull() || (image.width() < requestedSize.width() && image.height() < requestedSize.height())) {
+        qDebug() << "Reading scaled preview for large image:" << imagePath << "requested size:" << requestedSize;
+        image = ImageTileProvider::readScaledImage(imagePath, requestedSize);
+        cache.add(imagePath, s_tiledPreviewFrame, image);
+    }
+    return true;
+}
+
 /**
    @class AsyncImageResponse
    @brief 异步图像加载应答，在子线程完成图像加载后，通过 finished() 信号报告加载状态。
@@ -90,6 +159,7 @@ public:
     QString providerId;
     QSize requestedSize;
     QImage image;
+    QElapsedTimer elapsedTimer;  ///< 记录请求到加载完成的耗时
 };
 
 AsyncImageResponse::AsyncImageResponse(AsyncImageProvider *p, const QString &i, const QSize &r)
@@ -99,6 +169,7 @@ AsyncImageResponse::AsyncImageResponse(AsyncImageProvider *p, const QString &i,
 {
     qDebug() << "Creating async image response for:" << i << "requested size:" << r;
     setAutoDelete(false);
+    elapsedTimer.start();
 }
 
 AsyncImageResponse::~AsyncImageResponse() 
@@ -122,9 +193,16 @@ void AsyncImageResponse::run()
     int frameIndex;
     parseProviderID(providerId, tempPath, frameIndex);
 
-    // 判断缓存中是否存在图片
-    image = provider->imageCache.get(tempPath, frameIndex);
-    if (image.isNull()) {
+    // 图片正在预加载时等待完成，避免重复解码
+    if (0 == frameIndex) {
+        provider->waitForPreload(tempPath);
+    }
+
+    // 判断缓存中是否存在图片，超大图像仅解码预览图
+    bool tiledPreview = (0 == frameIndex && readTiledPreview(provider->imageCache, tempPath, requestedSize, image));
+    if (tiledPreview) {
+        qDebug() << "Using tiled preview for:" << tempPath;
+    } else if ((image = provider->imageCache.get(tempPath, frameIndex)).isNull()) {
         qDebug() << "Image not found in cache, loading from file:" << tempPath;
         if (frameIndex) {
             image = readMultiImage(tempPath, frameIndex);
@@ -138,13 +216,15 @@ void AsyncImageResponse::run()
         qDebug() << "Using cached image for:" << tempPath << "frame:" << frameIndex;
     }
 
-    // 调整图像大小
-    if (!image.isNull() && image.size() != requestedSize && requestedSize.isValid()) {
+    // 调整图像大小，超大图像预览图已按比例缩放
+    if (!tiledPreview && !image.isNull() && image.size() != requestedSize && requestedSize.isValid()) {
         qDebug() << "Resizing image from" << image.size() << "to" << requestedSize;
         image = image.scaled(requestedSize);
     }
 
-    qDebug() << "Async image load completed for:" << providerId;
+    // 缓存中的图像可能经过旋转等处理，在应答前统一为显示格式，已是显示格式时不复制数据
+    image = LibUnionImage_NameSpace::toDisplayFormat(image);
+    qDebug() << "Async image load completed for:" << providerId << "elapsed(ms):" << elapsedTimer.elapsed();
     emit finished();
 }
 
@@ -160,6 +240,7 @@ ProviderCache::ProviderCache()
 ProviderCache::~ProviderCache() 
 {
     qDebug() << "Cleaning up provider cache";
+    imageCache.dumpStatistics();
 }
 
 /**
@@ -219,12 +300,12 @@ void ProviderCache::removeImageCache(const QString &imagePath)
 {
     qDebug() << "Removing image from cache:" << imagePath;
     // 直接缓存的图像信息较少，遍历查询是否包含对应的图片
-    QList<ThumbnailCache::Key> keys;
+    QList<ImageMemoryCache::Key> keys;
     QMutexLocker _locker(&mutex);
     keys = imageCache.keys();
     _locker.unlock();
 
-    for (const ThumbnailCache::Key &key : keys) {
+    for (const ImageMemoryCache::Key &key : keys) {
         if (key.first == imagePath) {
             _locker.relock();
             imageCache.remove(key.first, key.second);
@@ -239,6 +320,7 @@ void ProviderCache::removeImageCache(const QString &imagePath)
 void ProviderCache::clearCache()
 {
     qDebug() << "Clearing provider cache";
+    imageCache.dumpStatistics();
     QMutexLocker _locker(&mutex);
     imageCache.clear();
     lastRotatePath.clear();
@@ -253,6 +335,23 @@ void ProviderCache::preloadImage(const QString &)
     // Nothing
 }
 
+/**
+   @brief 固定当前显示及相邻的图片 \a visiblePaths 的缓存，预载图片列表 \a filePaths 数据并缓存，
+        列表按加载优先级排列。同步加载器不执行预加载
+ */
+void ProviderCache::preloadImages(const QStringList &visiblePaths, const QStringList &)
+{
+    imageCache.setPinnedPaths(visiblePaths);
+}
+
+/**
+   @return 返回图像缓存的统计信息，包含命中、淘汰次数和内存占用等
+ */
+ImageMemoryCache::Statistics ProviderCache::cacheStatistics()
+{
+    return imageCache.statistics();
+}
+
 /**
    @class AsyncImageProvider
    @brief 异步图像加载器，提供主要图像的并行加载，主要用于展示图像的加载，会缓存最近的图像信息。
@@ -261,13 +360,16 @@ void ProviderCache::preloadImage(const QString &)
 AsyncImageProvider::AsyncImageProvider()
 {
     qDebug() << "Initializing async image provider";
-    // 缓存最近 3 张图片 + 1 张切换之前的图片
-    imageCache.setMaxCost(4);
+    // 预加载仅使用少量线程，保证当前图片的加载
+    preloadPool.setMaxThreadCount(2);
 }
 
 AsyncImageProvider::~AsyncImageProvider() 
 {
     qDebug() << "Cleaning up async image provider";
+    preloadPool.clear();
+    preloadGeneration.fetchAndAddRelaxed(1);
+    preloadPool.waitForDone();
 }
 
 /**
@@ -295,6 +397,83 @@ void AsyncImageProvider::preloadImage(const QString &filePath)
     QThreadPool::globalInstance()->start(response, QThread::TimeCriticalPriority);
 }
 
+/**
+   @brief 预加载当前图片附近的图片列表 \a filePaths 并缓存，列表按距离当前图片由近至远排列。
+        每次调用将取消上一批次尚未执行的预加载任务，用于快速切换或跳转图片时丢弃过期的请求
+ */
+void AsyncImageProvider::preloadImages(const QStringList &visiblePaths, const QStringList &filePaths)
+{
+    qDebug() << "Preloading images:" << filePaths;
+    ProviderCache::preloadImages(visiblePaths, filePaths);
+
+    // 移除尚未执行的任务，已执行的任务在解码前通过批次判断是否取消
+    preloadPool.clear();
+    int generation = preloadGeneration.fetchAndAddRelaxed(1) + 1;
+
+    for (int i = 0; i < filePaths.size(); ++i) {
+        const QString filePath = filePaths.at(i);
+        if (imageCache.contains(filePath, 0)) {
+            continue;
+        }
+
+        // 靠近当前图片的任务优先执行
+        preloadPool.start(QRunnable::create([this, filePath, generation]() { loadPreloadImage(filePath, generation); }),
+                          filePaths.size() - i);
+    }
+}
+
+/**
+   @brief 线程中预加载图片 \a filePath ，若预加载批次 \a generation 已过期则取消加载
+ */
+void AsyncImageProvider::loadPreloadImage(const QString &filePath, int generation)
+{
+    if (generation != preloadGeneration.loadRelaxed()) {
+        qDebug() << "Preload canceled for:" << filePath;
+        return;
+    }
+
+    // 超大图像按显示大小解码预览图，无需预加载完整图像
+    if (ImageTileProvider::isTiledImage(filePath)) {
+        return;
+    }
+
+    // 缓存已被固定的图片占满时，预加载的图像将被立即淘汰，跳过解码
+    const QSize imageSize = QImageReader(filePath).size();
+    if (imageSize.isValid() && !imageCache.canHold(filePath, qint64(imageSize.width()) * imageSize.height() * 4)) {
+        qDebug() << "Preload skipped, cache is full of pinned images:" << filePath << imageSize;
+        return;
+    }
+
+    QMutexLocker _locker(&mutex);
+    if (preloadingPaths.contains(filePath) || imageCache.contains(filePath, 0)) {
+        return;
+    }
+    preloadingPaths.insert(filePath);
+    _locker.unlock();
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    QImage image = readNormalImage(filePath);
+    imageCache.add(filePath, 0, image);
+    qDebug() << "Preload completed for:" << filePath << "elapsed(ms):" << elapsedTimer.elapsed();
+
+    _locker.relock();
+    preloadingPaths.remove(filePath);
+    preloadCondition.wakeAll();
+}
+
+/**
+   @brief 若图片 \a filePath 正在预加载，等待预加载完成，避免重复解码
+ */
+void AsyncImageProvider::waitForPreload(const QString &filePath)
+{
+    QMutexLocker _locker(&mutex);
+    while (preloadingPaths.contains(filePath)) {
+        qDebug() << "Waiting for preloading image:" << filePath;
+        preloadCondition.wait(&mutex);
+    }
+}
+
 /**
    @class ImageProvider
    @brief 图片加载类，读取图像信息并加载。
@@ -328,9 +507,12 @@ QImage ImageProvider::requestImage(const QString &id, QSize *size, const QSize &
     int frameIndex;
     parseProviderID(id, tempPath, frameIndex);
 
-    // 判断缓存中是否存在图片
-    QImage image = imageCache.get(tempPath, frameIndex);
-    if (image.isNull()) {
+    // 判断缓存中是否存在图片，超大图像仅解码预览图
+    QImage image;
+    bool tiledPreview = (0 == frameIndex && readTiledPreview(imageCache, tempPath, requestedSize, image));
+    if (tiledPreview) {
+        qDebug() << "Using tiled preview for:" << tempPath;
+    } else if ((image = imageCache.get(tempPath, frameIndex)).isNull()) {
         qDebug() << "Image not found in cache, loading from file:" << tempPath;
         if (frameIndex) {
             image = readMultiImage(tempPath, frameIndex);
@@ -348,13 +530,13 @@ QImage ImageProvider::requestImage(const QString &id, QSize *size, const QSize &
         qDebug() << "Using cached image for:" << tempPath << "frame:" << frameIndex;
     }
 
-    // 调整图像大小
-    if (!image.isNull() && image.size() != requestedSize && requestedSize.isValid()) {
+    // 调整图像大小，超大图像预览图已按比例缩放
+    if (!tiledPreview && !image.isNull() && image.size() != requestedSize && requestedSize.isValid()) {
         qDebug() << "Resizing image from" << image.size() << "to" << requestedSize;
         image = image.scaled(requestedSize);
     }
 
-    return image;
+    return LibUnionImage_NameSpace::toDisplayFormat(image);
 }
 
 /**
@@ -400,16 +582,23 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     // 判断缓存中是否存在缩略图
     if (ThumbnailCache::instance()->contains(tempPath, frameIndex)) {
         qDebug() << "Using cached thumbnail for:" << tempPath << "frame:" << frameIndex;
-        return ThumbnailCache::instance()->get(tempPath, frameIndex);
+        return LibUnionImage_NameSpace::toDisplayFormat(ThumbnailCache::instance()->get(tempPath, frameIndex));
     }
 
     qDebug() << "Thumbnail not found in cache, loading from file:" << tempPath;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
     QImage image;
     if (frameIndex) {
         image = readMultiImage(tempPath, frameIndex);
     } else {
-        image = readNormalImage(tempPath);
+        // 缩略图用于大图加载前的预览，优先快速获取，避免完整解码
+        image = readFastPreview(tempPath);
+        if (image.isNull()) {
+            image = readNormalImage(tempPath);
+        }
     }
+    qDebug() << "Thumbnail load for:" << tempPath << "elapsed(ms):" << elapsedTimer.elapsed();
     // 不存在缩略图信息，缓存图片
     QImage tmpImage = image.scaled(100, 100, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
     ThumbnailCache::instance()->add(tempPath, frameIndex, tmpImage);
@@ -422,7 +611,7 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
         qDebug() << "Resizing thumbnail from" << image.size() << "to" << requestedSize;
         image = image.scaled(requestedSize);
     }
-    return image;
+    return LibUnionImage_NameSpace::toDisplayFormat(image);
 }
 
 /**
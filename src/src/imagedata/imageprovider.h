@@ -5,12 +5,16 @@
 #ifndef IMAGEPROVIDER_H
 #define IMAGEPROVIDER_H
 
-#include "thumbnailcache.h"
+#include "imagememorycache.h"
 
 #include <QQuickImageProvider>
 #include <QImageReader>
 #include <QImage>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QSet>
 
 class ProviderCache
 {
@@ -23,10 +27,13 @@ public:
     void clearCache();
 
     virtual void preloadImage(const QString &filePath);
+    virtual void preloadImages(const QStringList &visiblePaths, const QStringList &filePaths);
+
+    ImageMemoryCache::Statistics cacheStatistics();
 
 protected:
     QMutex mutex;
-    ThumbnailCache imageCache;  ///< 图像数据缓存(已存在锁保护)
+    ImageMemoryCache imageCache;  ///< 图像数据缓存(已存在锁保护)
     QString lastRotatePath;     ///< 缓存的旋转文件路径
     QImage lastRotateImage;     ///< 缓存的旋转图像信息
     int lastRotation { 0 };     ///< 缓存的旋转角度
@@ -43,8 +50,18 @@ public:
 
     virtual QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
     void preloadImage(const QString &filePath) override;
+    void preloadImages(const QStringList &visiblePaths, const QStringList &filePaths) override;
+
+private:
+    void loadPreloadImage(const QString &filePath, int generation);
+    void waitForPreload(const QString &filePath);
 
 private:
+    QThreadPool preloadPool;         ///< 预加载线程池，限制线程数避免抢占当前图片的加载
+    QAtomicInt preloadGeneration;    ///< 预加载批次，批次变更后未执行的预加载任务将取消
+    QSet<QString> preloadingPaths;   ///< 正在预加载的图片路径
+    QWaitCondition preloadCondition; ///< 等待图片预加载完成
+
     friend class AsyncImageResponse;
 };
 
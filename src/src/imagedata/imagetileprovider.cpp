@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "imagetileprovider.h"
+#include "unionimage/unionimage.h"
+#include "svgrastercache.h"
+
+#include <QImageReader>
+#include <QHash>
+#include <QRunnable>
+#include <QThread>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QDebug>
+
+#include <atomic>
+
+static const QString s_tagTile = "#tile_";
+static const QString s_tagSvg = "#svg";
+// 分块大小(像素)
+static const int s_tileSize = 512;
+// 超过此像素数的图像使用分块加载
+static const qint64 s_tiledImageMinPixels = 50 * 1000 * 1000;
+// 单边超过此像素的图像同样分块加载(超出多数显卡纹理大小限制)
+static const int s_tiledImageMaxSide = 16384;
+// 分块缓存大小(KB)
+static const int s_tileCacheMaxCost = 256 * 1024;
+// 矢量图分块时对应的光栅图像长边像素，决定可放大查看的最大清晰度
+static const int s_svgTiledSide = 16384;
+// 超大图像判断结果的最大缓存数量
+static const int s_tiledStateMaxCount = 4096;
+
+// 超大图像判断结果缓存，避免界面线程重复读取文件头
+static QMutex s_tiledStateMutex;
+static QHash<QString, bool> s_tiledStates;
+
+/**
+   @brief 解析分块 \a id ，取得请求的文件路径 \a filePath 和分块层级 \a level 、列 \a column 、行 \a row
+   @return 是否为合法的分块 id
+ */
+static bool parseTileID(const QString &id, QString &filePath, int &level, int &column, int &row)
+{
+    static const QRegularExpression s_tileExp(QString("%1(\\d+)_(\\d+)_(\\d+)$").arg(s_tagTile));
+    QRegularExpressionMatch match = s_tileExp.match(id);
+    if (!match.hasMatch()) {
+        qWarning() << "Invalid tile ID format:" << id;
+        return false;
+    }
+
+    filePath = QUrl(id.left(match.capturedStart())).toLocalFile();
+    level = match.captured(1).toInt();
+    column = match.captured(2).toInt();
+    row = match.captured(3).toInt();
+    return !filePath.isEmpty();
+}
+
+/**
+   @class ImageTileResponse
+   @brief 异步分块加载应答，在分块线程池中完成解码后通过 finished() 信号报告加载状态。
+        界面不再需要分块时(快速缩放、拖拽)，cancel() 将跳过尚未开始的解码。
+ */
+class ImageTileResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    ImageTileResponse(ImageTileProvider *p, const QString &i, const QSize &r)
+        : provider(p)
+        , providerId(i)
+        , requestedSize(r)
+    {
+        setAutoDelete(false);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(image);
+    }
+
+    void cancel() override
+    {
+        canceled = true;
+    }
+
+    void run() override
+    {
+        if (!canceled && providerId.endsWith(s_tagSvg)) {
+            // 矢量图按请求大小所属的档位光栅化，相近大小复用缓存
+            const QString filePath = QUrl(providerId.chopped(s_tagSvg.size())).toLocalFile();
+            image = SvgRasterCache::instance()->image(filePath, requestedSize);
+        } else if (!canceled) {
+            QString filePath;
+            int level = 0;
+            int column = 0;
+            int row = 0;
+            if (parseTileID(providerId, filePath, level, column, row)) {
+                image = provider->readTile(filePath, level, column, row);
+            }
+        }
+        emit finished();
+    }
+
+    ImageTileProvider *provider = nullptr;
+    QString providerId;
+    QSize requestedSize;
+    QImage image;
+    std::atomic_bool canceled { false };
+};
+
+ImageTileProvider::ImageTileProvider()
+{
+    qDebug() << "Initializing image tile provider";
+    tileCache.setMaxCost(s_tileCacheMaxCost);
+    tilePool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+ImageTileProvider::~ImageTileProvider()
+{
+    qDebug() << "Cleaning up image tile provider";
+    tilePool.clear();
+    tilePool.waitForDone();
+}
+
+QQuickImageResponse *ImageTileProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    ImageTileResponse *response = new ImageTileResponse(this, id, requestedSize);
+    tilePool.start(response);
+    return response;
+}
+
+/**
+   @brief 读取 \a filePath 在层级 \a level 下第 \a column 列 \a row 行的图像分块，优先从缓存读取
+ */
+QImage ImageTileProvider::readTile(const QString &filePath, int level, int column, int row)
+{
+    const QString key = filePath + s_tagTile + QString("%1_%2_%3").arg(level).arg(column).arg(row);
+    QMutexLocker _locker(&mutex);
+    if (QImage *cached = tileCache.object(key)) {
+        return *cached;
+    }
+    _locker.unlock();
+
+    const bool isSvg = SvgRasterCache::isSvgFile(filePath);
+    QImageReader reader;
+    QSize imageSize;
+    if (isSvg) {
+        imageSize = svgTiledSize(filePath);
+    } else {
+        reader.setFileName(filePath);
+        imageSize = reader.size();
+    }
+    const int scaleFactor = 1 << qBound(0, level, 16);
+    const int tileSourceSize = s_tileSize * scaleFactor;
+
+    // 分块在原图中的区域
+    QRect clipRect = QRect(column * tileSourceSize, row * tileSourceSize, tileSourceSize, tileSourceSize)
+                     & QRect(QPoint(0, 0), imageSize);
+    if (clipRect.isEmpty()) {
+        qWarning() << "Tile out of image bounds:" << filePath << level << column << row;
+        return QImage();
+    }
+
+    const QSize scaledSize(qMax(1, (clipRect.width() + scaleFactor - 1) / scaleFactor),
+                           qMax(1, (clipRect.height() + scaleFactor - 1) / scaleFactor));
+    QImage tile;
+    if (isSvg) {
+        // 矢量图仅光栅化分块区域
+        tile = SvgRasterCache::instance()->renderRegion(filePath, imageSize, clipRect, scaledSize);
+    } else {
+        // 支持区域解码的格式(如 JPEG)仅解码分块区域，同时在解码时完成缩放
+        reader.setClipRect(clipRect);
+        reader.setScaledSize(scaledSize);
+        tile = reader.read();
+    }
+    if (tile.isNull()) {
+        qWarning() << "Failed to read tile:" << filePath << level << column << row << reader.errorString();
+        return tile;
+    }
+    // 在解码线程中转换为显示格式，上传纹理时无需再转换
+    tile = LibUnionImage_NameSpace::toDisplayFormat(tile);
+
+    _locker.relock();
+    tileCache.insert(key, new QImage(tile), qMax(1, int(tile.sizeInBytes() / 1024)));
+    return tile;
+}
+
+/**
+   @brief 移除缓存的 \a filePath 文件图像分块
+ */
+void ImageTileProvider::removeImageCache(const QString &filePath)
+{
+    QMutexLocker _stateLocker(&s_tiledStateMutex);
+    s_tiledStates.remove(filePath);
+    _stateLocker.unlock();
+
+    const QString prefix = filePath + s_tagTile;
+    QMutexLocker _locker(&mutex);
+    const QList<QString> keys = tileCache.keys();
+    for (const QString &key : keys) {
+        if (key.startsWith(prefix)) {
+            tileCache.remove(key);
+        }
+    }
+}
+
+int ImageTileProvider::tileSize()
+{
+    return s_tileSize;
+}
+
+/**
+   @return 矢量图 \a filePath 分块加载时对应的光栅图像大小，分块按此大小划分，放大时仅光栅化可见的分块
+ */
+QSize ImageTileProvider::svgTiledSize(const QString &filePath)
+{
+    return SvgRasterCache::instance()->defaultSize(filePath).scaled(s_svgTiledSide, s_svgTiledSide, Qt::KeepAspectRatio);
+}
+
+/**
+   @brief 查询已解析的矢量图 \a filePath 分块加载时对应的光栅图像大小至 \a size ，不解析文件，可在界面线程调用
+   @return 矢量图未解析过或已变更时返回 false
+ */
+bool ImageTileProvider::cachedSvgTiledSize(const QString &filePath, QSize &size)
+{
+    QSize defaultSize;
+    if (!SvgRasterCache::instance()->cachedDefaultSize(filePath, defaultSize)) {
+        return false;
+    }
+    size = defaultSize.scaled(s_svgTiledSide, s_svgTiledSide, Qt::KeepAspectRatio);
+    return true;
+}
+
+/**
+   @return \a filePath 是否为需要分块加载的超大图像，仅读取文件头信息，判断结果将被缓存。
+   @note 带方向信息的图像区域解码坐标与显示坐标不一致，使用完整加载流程
+ */
+bool ImageTileProvider::isTiledImage(const QString &filePath)
+{
+    bool tiled = false;
+    if (cachedTiledImage(filePath, tiled)) {
+        return tiled;
+    }
+
+    tiled = checkTiledImage(filePath);
+    QMutexLocker _locker(&s_tiledStateMutex);
+    if (s_tiledStates.size() >= s_tiledStateMaxCount) {
+        s_tiledStates.clear();
+    }
+    s_tiledStates.insert(filePath, tiled);
+    return tiled;
+}
+
+/**
+   @brief 查询缓存的 \a filePath 超大图像判断结果，通过 \a tiled 传出，不读取文件
+   @return 是否存在缓存的判断结果
+ */
+bool ImageTileProvider::cachedTiledImage(const QString &filePath, bool &tiled)
+{
+    QMutexLocker _locker(&s_tiledStateMutex);
+    auto itr = s_tiledStates.constFind(filePath);
+    if (itr == s_tiledStates.constEnd()) {
+        return false;
+    }
+
+    tiled = itr.value();
+    return true;
+}
+
+/**
+   @return 读取 \a filePath 文件头信息，判断是否为需要分块加载的超大图像
+ */
+bool ImageTileProvider::checkTiledImage(const QString &filePath)
+{
+    QImageReader reader(filePath);
+    const QSize imageSize = reader.size();
+    if (!imageSize.isValid()) {
+        return false;
+    }
+
+    bool isLarge = qint64(imageSize.width()) * imageSize.height() >= s_tiledImageMinPixels
+                   || qMax(imageSize.width(), imageSize.height()) > s_tiledImageMaxSide;
+    if (!isLarge) {
+        return false;
+    }
+
+    if (!reader.supportsOption(QImageIOHandler::ClipRect) || LibUnionImage_NameSpace::getFrameCount(filePath) > 1
+            || QImageIOHandler::TransformationNone != reader.transformation()) {
+        qDebug() << "Large image not support region decode:" << filePath << imageSize;
+        return false;
+    }
+    return true;
+}
+
+/**
+   @brief 按请求大小 \a requestedSize 解码 \a filePath 的预览图，解码器支持时(如 JPEG)在解码阶段完成缩放
+ */
+QImage ImageTileProvider::readScaledImage(const QString &filePath, const QSize &requestedSize)
+{
+    QImageReader reader(filePath);
+    QSize scaledSize = reader.size().scaled(requestedSize, Qt::KeepAspectRatio);
+    if (scaledSize.isValid()) {
+        reader.setScaledSize(scaledSize);
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Failed to read scaled image:" << filePath << reader.errorString();
+    }
+    return LibUnionImage_NameSpace::toDisplayFormat(image);
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IMAGETILEPROVIDER_H
+#define IMAGETILEPROVIDER_H
+
+#include <QQuickImageProvider>
+#include <QThreadPool>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+
+/**
+   @brief 超大图像分块加载器，按显示层级和区域解码图像分块，用于放大查看超大图像时只解码可见区域。
+        在 QML 中注册的标识为 "ImageTile" ，\a id 格式为 \b{图像路径#tile_层级_列_行} ，
+        例如 "/home/tmp.jpg#tile_1_3_2" ，层级 1 表示原图缩小 1/2 ，分块大小为 tileSize() 像素。
+        矢量图按 svgTiledSize() 大小划分分块，\a id 为 \b{图像路径#svg} 时返回按请求大小光栅化的完整图像。
+   @threadsafe
+ */
+class ImageTileProvider : public QQuickAsyncImageProvider
+{
+public:
+    explicit ImageTileProvider();
+    ~ImageTileProvider() override;
+
+    virtual QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    // 移除 \a filePath 对应的分块缓存，用于文件变更时
+    void removeImageCache(const QString &filePath);
+
+    static int tileSize();
+    // 是否为需要分块加载的超大图像(格式需支持区域解码)
+    static bool isTiledImage(const QString &filePath);
+    // 查询缓存的超大图像判断结果，不读取文件，可在界面线程调用
+    static bool cachedTiledImage(const QString &filePath, bool &tiled);
+    // 按请求大小直接解码超大图像的预览图，避免解码完整图像
+    static QImage readScaledImage(const QString &filePath, const QSize &requestedSize);
+    // 矢量图分块加载时对应的光栅图像大小
+    static QSize svgTiledSize(const QString &filePath);
+    // 查询已解析的矢量图分块加载时对应的光栅图像大小，不解析文件，可在界面线程调用
+    static bool cachedSvgTiledSize(const QString &filePath, QSize &size);
+
+private:
+    static bool checkTiledImage(const QString &filePath);
+    QImage readTile(const QString &filePath, int level, int column, int row);
+
+    friend class ImageTileResponse;
+
+    QMutex mutex;
+    QCache<QString, QImage> tileCache;  ///< 分块缓存(LRU)，以 KB 计算开销
+    QThreadPool tilePool;               ///< 分块解码线程池，限制并发解码数量
+
+    Q_DISABLE_COPY(ImageTileProvider)
+};
+
+#endif  // IMAGETILEPROVIDER_H
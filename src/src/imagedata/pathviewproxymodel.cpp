@@ -6,6 +6,7 @@
 #include "types.h"
 #include "imageinfo.h"
 #include "imagesourcemodel.h"
+#include "configsetter.h"
 
 #include <QDebug>
 
@@ -35,6 +36,10 @@ PathViewProxyModel::PathViewProxyModel(ImageSourceModel *srcModel, QObject *pare
     // 设置默认的环长度
     const int defaultCount = 5;
     setQueueCount(defaultCount);
+
+    // 预加载半径，可通过配置文件调整
+    const int defaultPreloadRadius = 2;
+    setPreloadRadius(LibConfigSetter::instance()->value("MAINWINDOW", "PreloadRadius", defaultPreloadRadius).toInt());
 }
 
 PathViewProxyModel::~PathViewProxyModel() 
@@ -178,6 +183,8 @@ void PathViewProxyModel::movePrevoius()
     int changeIndex = (currentProxyIdx + radius + 1) % maxCount;
     const IndexInfoPtr &baseInfo = indexQueue[nextProxyIdx(changeIndex)];
     updateIndexInfo(changeIndex, createPreviousIndexInfo(baseInfo));
+
+    requestPreload(Previous);
 }
 
 /**
@@ -193,6 +200,8 @@ void PathViewProxyModel::moveNext()
     const IndexInfoPtr &baseInfo = indexQueue[previousPorxyIdx(changeIndex)];
 
     updateIndexInfo(changeIndex, createNextIndexInfo(baseInfo));
+
+    requestPreload(Next);
 }
 
 /**
@@ -229,6 +238,8 @@ void PathViewProxyModel::resetModel(int sourceIndex, int frameIndex)
 
     endResetModel();
     qDebug() << "Model reset complete, queue size:" << indexQueue.size();
+
+    requestPreload(Current);
 }
 
 /**
@@ -301,6 +312,15 @@ void PathViewProxyModel::setQueueCount(int count)
     radius = qFloor(maxCount / 2);
 }
 
+/**
+   @brief 设置预加载半径为 \a count ，即沿浏览方向预加载的图片数量，为 0 时不预加载
+ */
+void PathViewProxyModel::setPreloadRadius(int count)
+{
+    qDebug() << "Setting preload radius to:" << count;
+    preloadRadius = qMax(0, count);
+}
+
 /**
    @brief 打印当前的队列缓存信息
  */
@@ -355,6 +375,9 @@ void PathViewProxyModel::jumpToIndex(int sourceIndex, int frameIndex)
     // currentIndex 的变更会判断 jumpFlag 触发 jumpFinished() ，
     // 因此 jumpFlag 的变更在 currentIndexChanged() 之后触发
     jumpFlag = flag;
+
+    // 跳转后取消原位置附近的预加载
+    requestPreload(Current);
 }
 
 /**
@@ -601,3 +624,50 @@ void PathViewProxyModel::updateIndexInfo(int proxyIndex, const IndexInfoPtr &inf
     QModelIndex changeModelIndex = index(proxyIndex);
     Q_EMIT dataChanged(changeModelIndex, changeModelIndex, { Types::ImageUrlRole, Types::FrameIndexRole });
 }
+
+/**
+   @brief 根据浏览方向 \a direction 请求预加载当前图片附近的图片，
+    浏览方向预加载 preloadRadius 张图片，反方向预加载一半，无方向(跳转/重置)时两侧相同。
+    图片列表由近至远排列，同距离时浏览方向优先。当前及相邻的图片同时请求固定在缓存中
+ */
+void PathViewProxyModel::requestPreload(DistanceType direction)
+{
+    if (indexQueue.isEmpty()) {
+        return;
+    }
+
+    const IndexInfoPtr &current = indexQueue[currentProxyIdx];
+    if (!current) {
+        qWarning() << "Cannot request preload - current index info is null";
+        return;
+    }
+
+    const int step = (Previous == direction) ? -1 : 1;
+    const int forwardCount = preloadRadius;
+    const int backwardCount = (Current == direction || preloadRadius <= 0) ? preloadRadius : qMax(1, preloadRadius / 2);
+    const int sourceCount = sourceModel->rowCount();
+
+    QStringList visiblePaths;
+    QStringList filePaths;
+    auto appendSourcePath = [&](QStringList &paths, int sourceIndex) {
+        if (0 <= sourceIndex && sourceIndex < sourceCount) {
+            paths.append(sourcePath(sourceIndex).toLocalFile());
+        }
+    };
+
+    for (int i = -1; i <= 1; ++i) {
+        appendSourcePath(visiblePaths, current->index + i);
+    }
+
+    for (int i = 1; i <= qMax(forwardCount, backwardCount); ++i) {
+        if (i <= forwardCount) {
+            appendSourcePath(filePaths, current->index + step * i);
+        }
+        if (i <= backwardCount) {
+            appendSourcePath(filePaths, current->index - step * i);
+        }
+    }
+
+    qDebug() << "Request preload around source index:" << current->index << "direction:" << direction << "count:" << filePaths.size();
+    Q_EMIT preloadRequested(visiblePaths, filePaths);
+}
@@ -42,6 +42,9 @@ public:
     void deleteCurrent();
 
     void setQueueCount(int count);
+    void setPreloadRadius(int count);
+    // 请求固定当前显示及相邻的图片 visiblePaths 的缓存，并预加载附近的图片，列表按加载优先级排列
+    Q_SIGNAL void preloadRequested(const QStringList &visiblePaths, const QStringList &filePaths);
 
     void dumpInfo();
 
@@ -81,10 +84,12 @@ private:
     IndexInfoPtr createNextIndexInfo(const IndexInfoPtr &baseInfo);
 
     void updateIndexInfo(int proxyIndex, const IndexInfoPtr &info);
+    void requestPreload(DistanceType direction);
 
 private:
     int maxCount { 0 };  // 固定索引区间长度，即便图片数量小于此长度
     int radius { 0 };    // 区间半径
+    int preloadRadius { 0 };  // 预加载半径，浏览方向预加载的图片数量
 
     QPointer<ImageSourceModel> sourceModel;  // 源数据模型
     QList<IndexInfoPtr> indexQueue;          // 当前图片之前的队列区间  [左侧，当前图片，右侧]
@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "svgrastercache.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPainter>
+#include <QDebug>
+
+// 光栅化尺寸档位(长边或短边像素)，相邻档位约 1.5 倍
+static const int s_bucketSizes[] = { 64, 128, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096 };
+// 光栅化图像最大像素数，超出时按 KeepAspectRatio 计算
+static const qint64 s_maxRasterPixels = 4096LL * 4096;
+// 缓存大小(KB)
+static const int s_cacheMaxCost = 64 * 1024;
+// 无法获取矢量图默认大小时使用的大小
+static const int s_fallbackSize = 512;
+// 缓存的矢量图文档数量
+static const int s_maxDocuments = 8;
+
+SvgRasterCache *SvgRasterCache::instance()
+{
+    static SvgRasterCache ins;
+    return &ins;
+}
+
+SvgRasterCache::SvgRasterCache()
+{
+    cache.setMaxCost(s_cacheMaxCost);
+    documents.setMaxCost(s_maxDocuments);
+}
+
+/**
+   @return 矢量图 \a renderer 的默认大小，未指定大小时取 viewBox 大小
+ */
+static QSize rendererSize(const QSvgRenderer &renderer)
+{
+    QSize size = renderer.defaultSize();
+    if (size.isEmpty()) {
+        size = renderer.viewBox().size();
+    }
+    return size.isEmpty() ? QSize(s_fallbackSize, s_fallbackSize) : size;
+}
+
+/**
+   @return 将 \a renderer 按整体大小 \a fullSize 光栅化时，\a region 区域输出为 \a outputSize 大小的图像
+ */
+static QImage renderToImage(QSvgRenderer &renderer, const QSize &fullSize, const QRect &region, const QSize &outputSize)
+{
+    QImage image(outputSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setClipRect(QRect(QPoint(0, 0), outputSize));
+    painter.scale(qreal(outputSize.width()) / region.width(), qreal(outputSize.height()) / region.height());
+    painter.translate(-region.topLeft());
+    renderer.render(&painter, QRectF(QPointF(0, 0), fullSize));
+    painter.end();
+    return image;
+}
+
+/**
+   @brief 获取 \a path 矢量图按 \a requestedSize 光栅化的图像，请求大小归入尺寸档位后以 \a mode 方式缩放，
+        返回图像大小为档位大小而非精确的请求大小，由调用方按需缩放
+   @return 光栅化的图像，读取失败时返回空图像
+   @threadsafe
+ */
+QImage SvgRasterCache::image(const QString &path, const QSize &requestedSize, Qt::AspectRatioMode mode)
+{
+    // 未指定请求大小时按默认大小光栅化
+    const int side = requestedSize.isValid() ? qMax(requestedSize.width(), requestedSize.height()) : 0;
+    const QString key = QString("%1#%2_%3").arg(path).arg(side > 0 ? bucketSize(side) : 0).arg(int(mode));
+    const QDateTime lastModified = QFileInfo(path).lastModified();
+
+    QMutexLocker _locker(&mutex);
+    if (Entry *entry = cache.object(key)) {
+        if (entry->lastModified == lastModified) {
+            return entry->image;
+        }
+        cache.remove(key);
+    }
+    _locker.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+    DocumentPtr doc = document(path);
+    if (!doc) {
+        return QImage();
+    }
+
+    const QSize svgSize = doc->size;
+    const int bucket = side > 0 ? bucketSize(side) : bucketSize(qMax(svgSize.width(), svgSize.height()));
+    QSize rasterSize = svgSize.scaled(bucket, bucket, mode);
+    if (qint64(rasterSize.width()) * rasterSize.height() > s_maxRasterPixels) {
+        rasterSize = svgSize.scaled(bucket, bucket, Qt::KeepAspectRatio);
+    }
+    if (rasterSize.isEmpty()) {
+        return QImage();
+    }
+
+    QMutexLocker _docLocker(&doc->mutex);
+    QImage raster = renderToImage(doc->renderer, rasterSize, QRect(QPoint(0, 0), rasterSize), rasterSize);
+    _docLocker.unlock();
+    qDebug() << "Rasterized svg:" << path << "size:" << rasterSize << "elapsed(ms):" << timer.elapsed();
+
+    _locker.relock();
+    cache.insert(key, new Entry { raster, lastModified }, qMax(1, int(raster.sizeInBytes() / 1024)));
+    return raster;
+}
+
+/**
+   @brief 移除 \a path 矢量图的所有光栅化缓存
+ */
+void SvgRasterCache::remove(const QString &path)
+{
+    const QString prefix = path + "#";
+    QMutexLocker _locker(&mutex);
+    documents.remove(path);
+    const QList<QString> keys = cache.keys();
+    for (const QString &key : keys) {
+        if (key.startsWith(prefix)) {
+            cache.remove(key);
+        }
+    }
+}
+
+/**
+   @return \a path 是否为矢量图文件
+ */
+bool SvgRasterCache::isSvgFile(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return "svg" == suffix || "svgz" == suffix;
+}
+
+/**
+   @return \a path 矢量图的默认大小，未指定大小时取 viewBox 大小
+ */
+QSize SvgRasterCache::defaultSize(const QString &path)
+{
+    DocumentPtr doc = document(path);
+    return doc ? doc->size : QSize();
+}
+
+/**
+   @brief 查询已解析的 \a path 矢量图的默认大小至 \a size ，不解析文件，可在界面线程调用
+   @return 矢量图文档未缓存或已变更时返回 false
+ */
+bool SvgRasterCache::cachedDefaultSize(const QString &path, QSize &size)
+{
+    const QDateTime lastModified = QFileInfo(path).lastModified();
+    QMutexLocker _locker(&mutex);
+    DocumentPtr *doc = documents.object(path);
+    if (!doc || (*doc)->lastModified != lastModified) {
+        return false;
+    }
+    size = (*doc)->size;
+    return true;
+}
+
+/**
+   @brief 将 \a path 矢量图按整体大小 \a fullSize 光栅化时，仅绘制其中 \a region 区域，输出大小为 \a outputSize ，
+        用于放大查看时只光栅化可见区域
+   @return 光栅化的区域图像，读取失败时返回空图像
+ */
+QImage SvgRasterCache::renderRegion(const QString &path, const QSize &fullSize, const QRect &region, const QSize &outputSize)
+{
+    if (fullSize.isEmpty() || region.isEmpty() || outputSize.isEmpty()) {
+        return QImage();
+    }
+
+    DocumentPtr doc = document(path);
+    if (!doc) {
+        return QImage();
+    }
+
+    // 同一文档的分块依次绘制
+    QMutexLocker _locker(&doc->mutex);
+    return renderToImage(doc->renderer, fullSize, region, outputSize);
+}
+
+/**
+   @return \a path 解析后的矢量图文档，优先从缓存读取，解析失败时返回空指针
+   @threadsafe
+ */
+SvgRasterCache::DocumentPtr SvgRasterCache::document(const QString &path)
+{
+    const QDateTime lastModified = QFileInfo(path).lastModified();
+    QMutexLocker _locker(&mutex);
+    if (DocumentPtr *cached = documents.object(path)) {
+        if ((*cached)->lastModified == lastModified) {
+            return *cached;
+        }
+        documents.remove(path);
+    }
+    _locker.unlock();
+
+    // 解析文件耗时较长，不持有缓存锁
+    DocumentPtr doc(new Document);
+    if (!doc->renderer.load(path)) {
+        qWarning() << "Failed to load svg:" << path;
+        return DocumentPtr();
+    }
+    doc->size = rendererSize(doc->renderer);
+    doc->lastModified = lastModified;
+
+    _locker.relock();
+    documents.insert(path, new DocumentPtr(doc));
+    return doc;
+}
+
+/**
+   @return 边长 \a side 所属的尺寸档位，超出最大档位时返回最大档位
+ */
+int SvgRasterCache::bucketSize(int side)
+{
+    for (int bucket : s_bucketSizes) {
+        if (side <= bucket) {
+            return bucket;
+        }
+    }
+    return s_bucketSizes[sizeof(s_bucketSizes) / sizeof(s_bucketSizes[0]) - 1];
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SVGRASTERCACHE_H
+#define SVGRASTERCACHE_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QSvgRenderer>
+
+// 矢量图光栅化缓存，按请求大小归入固定的尺寸档位缓存光栅化结果，相近大小的请求复用同一图像。
+// 解析后的矢量图文档同样被缓存，分块光栅化时无需每次重新解析文件
+class SvgRasterCache
+{
+public:
+    static SvgRasterCache *instance();
+
+    QImage image(const QString &path, const QSize &requestedSize, Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+    void remove(const QString &path);
+
+    static bool isSvgFile(const QString &path);
+    QSize defaultSize(const QString &path);
+    bool cachedDefaultSize(const QString &path, QSize &size);
+    QImage renderRegion(const QString &path, const QSize &fullSize, const QRect &region, const QSize &outputSize);
+
+private:
+    SvgRasterCache();
+    static int bucketSize(int side);
+
+    struct Entry
+    {
+        QImage image;
+        QDateTime lastModified;  // 文件修改时间，文件变更后缓存失效
+    };
+
+    // 解析后的矢量图文档，同一文档的绘制需持有 mutex
+    struct Document
+    {
+        QMutex mutex;
+        QSvgRenderer renderer;
+        QSize size;              // 默认大小
+        QDateTime lastModified;  // 文件修改时间，文件变更后缓存失效
+    };
+    typedef QSharedPointer<Document> DocumentPtr;
+
+    DocumentPtr document(const QString &path);
+
+    QMutex mutex;
+    QCache<QString, Entry> cache;  ///< 光栅化图像缓存(LRU)，以 KB 计算开销
+    QCache<QString, DocumentPtr> documents;  ///< 矢量图文档缓存(LRU)，以文档数量计算开销
+
+    Q_DISABLE_COPY(SvgRasterCache)
+};
+
+#endif  // SVGRASTERCACHE_H
@@ -0,0 +1,334 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filecopyengine.h"
+#include "unionimage/baseutils.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QStorageInfo>
+#include <QThreadPool>
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+// 固态存储(SSD、SD卡、U盘)并发复制的最大文件数
+static const int s_copyMaxConcurrent = 4;
+// 无法识别设备类型时的并发复制文件数
+static const int s_copyDefaultConcurrent = 2;
+// 单次内核拷贝的最大数据量，同时决定进度更新和响应停止的粒度
+static const qint64 s_copyChunkSize = 16LL * 1024 * 1024;
+// 累计写入超过该数据量后同步一次文件系统，避免逐个文件 fsync
+static const qint64 s_syncBatchBytes = 256LL * 1024 * 1024;
+// 进度更新间隔(ms)
+static const int s_progressInterval = 200;
+// 目标文件已存在时追加序号重命名的最大尝试次数
+static const int s_maxRenameCount = 1000;
+
+/**
+   @return 在目标路径 \a target 的文件名后追加序号 \a index 得到的路径，如 a.jpg -> a_1.jpg
+ */
+static QString numberedPath(const QString &target, int index)
+{
+    const QFileInfo info(target);
+    const QString suffix = info.suffix();
+    return QString("%1/%2_%3%4").arg(info.absolutePath(), info.completeBaseName(), QString::number(index),
+                                     suffix.isEmpty() ? QString() : "." + suffix);
+}
+
+/**
+   @return 目标文件 \a target 落盘后与源文件 \a source 的大小和内容标识是否一致。
+    先丢弃目标文件在页缓存中的数据，使校验读取的是设备上的数据。
+   @note 仅为部分校验：内容标识只覆盖首尾各 64KB 数据，可发现截断、未写入等错误，不能发现中间数据的损坏；
+    完整比较需要再次读取整个源文件，从相机、手机等慢速设备导入时耗时加倍，因此不做
+ */
+static bool verifyCopiedFile(const QString &source, const QString &target)
+{
+    const int fd = ::open(QFile::encodeName(target).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+
+    return QFileInfo(target).size() == QFileInfo(source).size()
+           && Libutils::base::contentHash(source) == Libutils::base::contentHash(target);
+}
+
+FileCopyEngine::FileCopyEngine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FileCopyEngine::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = count;
+}
+
+void FileCopyEngine::stop()
+{
+    qDebug() << "File copy stop requested";
+    m_stopped.storeRelaxed(1);
+}
+
+/**
+   @return 路径 \a path 所在设备适合的并发复制文件数。
+    通过 fuse 挂载的设备(MTP/PTP 手机、相机)只能顺序传输，机械硬盘并发访问会增加寻道，均不并发；
+    其它块设备按 /sys/class/block 中的 rotational 属性判断
+ */
+int FileCopyEngine::concurrencyFor(const QString &path)
+{
+    static QMutex mutex;
+    static QHash<QByteArray, int> cache;
+
+    QStorageInfo storage(path);
+    const QByteArray device = storage.device();
+    QMutexLocker locker(&mutex);
+    auto itr = cache.constFind(device);
+    if (itr != cache.constEnd()) {
+        return itr.value();
+    }
+
+    int concurrent = s_copyDefaultConcurrent;
+    if (storage.fileSystemType().startsWith("fuse")) {
+        concurrent = 1;
+    } else {
+        // 分区的队列属性位于其所属磁盘目录下
+        const QString blockName = QFileInfo(QString::fromLocal8Bit(device)).fileName();
+        const QStringList candidates = {
+            QString("/sys/class/block/%1/queue/rotational").arg(blockName),
+            QString("/sys/class/block/%1/../queue/rotational").arg(blockName)
+        };
+        for (const QString &candidate : candidates) {
+            QFile file(candidate);
+            if (file.open(QIODevice::ReadOnly)) {
+                concurrent = file.readAll().trimmed() == "1" ? 1 : s_copyMaxConcurrent;
+                break;
+            }
+        }
+    }
+
+    qDebug() << "Copy concurrency for device" << device << storage.fileSystemType() << "is" << concurrent;
+    cache.insert(device, concurrent);
+    return concurrent;
+}
+
+QStringList FileCopyEngine::copy(const QList<Task> &tasks)
+{
+    QStringList copied;
+    if (tasks.isEmpty()) {
+        return copied;
+    }
+
+    qint64 totalBytes = 0;
+    for (const Task &task : tasks) {
+        totalBytes += QFileInfo(task.source).size();
+    }
+
+    int concurrent = m_maxConcurrent;
+    if (concurrent < 1) {
+        concurrent = qMin(concurrencyFor(tasks.first().source), concurrencyFor(QFileInfo(tasks.first().target).absolutePath()));
+    }
+    concurrent = qBound(1, concurrent, tasks.size());
+    qInfo() << "Copying" << tasks.size() << "files," << totalBytes << "bytes with" << concurrent << "concurrent copies";
+
+    m_copiedBytes.storeRelaxed(0);
+    m_unsyncedBytes.storeRelaxed(0);
+    m_stopped.storeRelaxed(0);
+
+    QMutex resultMutex;
+    std::vector<bool> succeeded(static_cast<size_t>(tasks.size()), false);
+    // 实际写入的目标路径，目标文件已存在时重命名
+    std::vector<QString> targets(static_cast<size_t>(tasks.size()));
+    QAtomicInt next;
+
+    QElapsedTimer timer;
+    timer.start();
+    auto reportProgress = [this, &timer, totalBytes]() {
+        const qint64 copiedBytes = m_copiedBytes.loadRelaxed();
+        const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+        emit progressChanged(copiedBytes, totalBytes, copiedBytes * 1000 / elapsed);
+    };
+
+    // 每个复制线程依次领取下一个文件，进度由当前线程定时汇报
+    QThreadPool pool;
+    pool.setMaxThreadCount(concurrent);
+    for (int i = 0; i < concurrent; ++i) {
+        pool.start([this, &tasks, &next, &succeeded, &targets, &resultMutex]() {
+            for (int index = next.fetchAndAddRelaxed(1); index < tasks.size(); index = next.fetchAndAddRelaxed(1)) {
+                if (m_stopped.loadRelaxed()) {
+                    break;
+                }
+                QString target;
+                if (copyFile(tasks.at(index), target)) {
+                    QMutexLocker locker(&resultMutex);
+                    succeeded[static_cast<size_t>(index)] = true;
+                    targets[static_cast<size_t>(index)] = target;
+                }
+            }
+        });
+    }
+    while (!pool.waitForDone(s_progressInterval)) {
+        reportProgress();
+    }
+
+    // 统一同步剩余未落盘的数据
+    if (m_unsyncedBytes.loadRelaxed() > 0) {
+        const int dirFd = ::open(QFile::encodeName(QFileInfo(tasks.first().target).absolutePath()).constData(),
+                                 O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::syncfs(dirFd);
+            ::close(dirFd);
+        }
+    }
+    reportProgress();
+
+    //数据落盘后校验目标文件的大小和内容标识，校验失败的文件删除
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (!succeeded[static_cast<size_t>(i)]) {
+            continue;
+        }
+        const QString &target = targets[static_cast<size_t>(i)];
+        if (!verifyCopiedFile(tasks.at(i).source, target)) {
+            qWarning() << "Copied file verification failed:" << target;
+            QFile::remove(target);
+            continue;
+        }
+        copied << target;
+    }
+    qInfo() << "Copied" << copied.size() << "of" << tasks.size() << "files, elapsed(ms):" << timer.elapsed();
+    return copied;
+}
+
+/**
+   @brief 复制单个文件。优先使用 copy_file_range (同一文件系统时可由文件系统直接克隆或服务端复制)，
+    跨文件系统不支持时回退为 sendfile ，均不支持时回退为普通读写。
+    目标文件以独占方式创建，已存在时在文件名后追加序号，不覆盖已有文件
+   @return 是否复制成功，\a targetPath 返回实际写入的目标路径，失败时删除目标文件
+ */
+bool FileCopyEngine::copyFile(const Task &task, QString &targetPath)
+{
+    const QByteArray source = QFile::encodeName(task.source);
+
+    const int in = ::open(source.constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        qWarning() << "Failed to open source file:" << task.source << strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (0 != ::fstat(in, &st)) {
+        qWarning() << "Failed to stat source file:" << task.source << strerror(errno);
+        ::close(in);
+        return false;
+    }
+    targetPath = task.target;
+    QByteArray target = QFile::encodeName(targetPath);
+    int out = ::open(target.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    for (int i = 1; out < 0 && EEXIST == errno && i <= s_maxRenameCount; ++i) {
+        targetPath = numberedPath(task.target, i);
+        target = QFile::encodeName(targetPath);
+        out = ::open(target.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    }
+    if (out < 0) {
+        qWarning() << "Failed to create target file:" << targetPath << strerror(errno);
+        ::close(in);
+        return false;
+    }
+
+    ::posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    // 预分配空间，空间不足时尽早失败
+    if (st.st_size > 0 && 0 != ::fallocate(out, 0, 0, st.st_size) && ENOSPC == errno) {
+        qWarning() << "No space left for target file:" << targetPath;
+        ::close(in);
+        ::close(out);
+        ::unlink(target.constData());
+        return false;
+    }
+
+    enum { CopyFileRange, SendFile, ReadWrite } method = CopyFileRange;
+    std::vector<char> buffer;
+    qint64 copied = 0;
+    bool ok = true;
+    while (copied < st.st_size) {
+        if (m_stopped.loadRelaxed()) {
+            ok = false;
+            break;
+        }
+
+        const size_t length = static_cast<size_t>(qMin(s_copyChunkSize, static_cast<qint64>(st.st_size) - copied));
+        ssize_t bytes = -1;
+        if (CopyFileRange == method) {
+            bytes = ::copy_file_range(in, nullptr, out, nullptr, length, 0);
+            // 部分文件系统不支持时返回 0 而非报错
+            if (0 == copied && (0 == bytes || (bytes < 0 && (EXDEV == errno || ENOSYS == errno || EINVAL == errno || EOPNOTSUPP == errno)))) {
+                method = SendFile;
+                continue;
+            }
+        } else if (SendFile == method) {
+            bytes = ::sendfile(out, in, nullptr, length);
+            if (bytes < 0 && 0 == copied && (EINVAL == errno || ENOSYS == errno)) {
+                method = ReadWrite;
+                continue;
+            }
+        } else {
+            buffer.resize(static_cast<size_t>(s_copyChunkSize));
+            bytes = ::read(in, buffer.data(), length);
+            for (ssize_t written = 0; bytes > 0 && written < bytes;) {
+                const ssize_t count = ::write(out, buffer.data() + written, static_cast<size_t>(bytes - written));
+                if (count < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    bytes = -1;
+                    break;
+                }
+                written += count;
+            }
+        }
+
+        if (bytes < 0 && EINTR == errno) {
+            continue;
+        }
+        if (bytes <= 0) {
+            // 文件在复制过程中被截断或读写出错
+            qWarning() << "Failed to copy file:" << task.source << "to:" << targetPath << strerror(errno);
+            ok = false;
+            break;
+        }
+        copied += bytes;
+        m_copiedBytes.fetchAndAddRelaxed(bytes);
+    }
+
+    if (ok) {
+        syncIfNeeded(out, copied);
+    }
+    ::close(in);
+    ::close(out);
+
+    if (!ok) {
+        ::unlink(target.constData());
+    }
+    return ok;
+}
+
+void FileCopyEngine::syncIfNeeded(int fd, qint64 bytes)
+{
+    // 多个线程同时超过阈值时仅由一个线程执行同步
+    const qint64 unsynced = m_unsyncedBytes.fetchAndAddRelaxed(bytes) + bytes;
+    if (unsynced >= s_syncBatchBytes && m_unsyncedBytes.testAndSetRelaxed(unsynced, 0)) {
+        qDebug() << "Syncing" << unsynced << "copied bytes to disk";
+        ::syncfs(fd);
+    }
+}
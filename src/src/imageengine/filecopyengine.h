@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILECOPYENGINE_H
+#define FILECOPYENGINE_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+//批量复制文件，数据在内核中直接拷贝，不经过用户态缓冲区
+class FileCopyEngine : public QObject
+{
+    Q_OBJECT
+public:
+    struct Task {
+        QString source;
+        QString target;
+    };
+
+    explicit FileCopyEngine(QObject *parent = nullptr);
+
+    //设置并发复制的文件数，小于1时按源和目标设备自动选择
+    void setMaxConcurrent(int count);
+    //执行复制，阻塞至全部完成，返回复制并在落盘后校验成功的目标路径，目标文件已存在时重命名，返回重命名后的路径
+    //落盘后仅校验文件大小及首尾数据块，不逐字节比较
+    QStringList copy(const QList<Task> &tasks);
+    //停止复制，未完成的文件会被删除，可在其它线程调用(如设备卸载时)
+    void stop();
+
+    //按设备类型选择并发复制的文件数
+    static int concurrencyFor(const QString &path);
+
+signals:
+    //复制进度，bytesPerSecond 为从开始复制至今的平均速度
+    void progressChanged(qint64 copiedBytes, qint64 totalBytes, qint64 bytesPerSecond);
+
+private:
+    bool copyFile(const Task &task, QString &targetPath);
+    void syncIfNeeded(int fd, qint64 bytes);
+
+    int m_maxConcurrent = 0;
+    QAtomicInteger<qint64> m_copiedBytes;
+    QAtomicInteger<qint64> m_unsyncedBytes;
+    QAtomicInt m_stopped;
+};
+
+#endif // FILECOPYENGINE_H
@@ -23,11 +23,15 @@
 #include "unionimage/baseutils.h"
 #include "unionimage/unionimage_global.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/devicescancache.h"
 #include "configsetter.h"
 #include "movieservice.h"
+#include "imagedata/imagefilewatcher.h"
+#include "imagedata/svgrastercache.h"
 #include <QDebug>
 
 #include <QMetaType>
+#include <QScopedPointer>
 #include <QDirIterator>
 #include <QStandardPaths>
 #include <QSqlDatabase>
@@ -37,6 +41,10 @@
 const QString SETTINGS_GROUP = "Thumbnail";
 const QString SETTINGS_DISPLAY_MODE = "ThumbnailMode";
 const int THUMBNAIL_MAX_SIZE = 180;
+// 文件状态缓存有效时间(ms)，超时后重新访问文件系统
+const qint64 FILE_STAT_CACHE_TTL = 3000;
+// 文件状态缓存的最大条目数，超出后整体清空
+const int FILE_STAT_CACHE_MAX_COUNT = 20000;
 
 ImageDataService *ImageDataService::s_ImageDataService = nullptr;
 
@@ -118,6 +126,82 @@ void ImageDataService::removeThumbnailFile(const QString &path)
     }
 }
 
+bool ImageDataService::fileExistsCached(const QString &path)
+{
+    QMutexLocker locker(&m_statMutex);
+
+    qint64 now = m_statTimer.elapsed();
+    auto iter = m_fileStatCache.constFind(path);
+    if (iter != m_fileStatCache.constEnd() && now - iter->second < FILE_STAT_CACHE_TTL) {
+        return iter->first;
+    }
+
+    // 缓存未命中或已过期，访问文件系统时不持有锁
+    locker.unlock();
+    bool exists = QFile::exists(path);
+    locker.relock();
+
+    if (m_fileStatCache.size() >= FILE_STAT_CACHE_MAX_COUNT) {
+        qDebug() << "File stat cache exceeded" << FILE_STAT_CACHE_MAX_COUNT << "entries, clearing";
+        m_fileStatCache.clear();
+    }
+    m_fileStatCache.insert(path, std::make_pair(exists, m_statTimer.elapsed()));
+    return exists;
+}
+
+QString ImageDataService::trashRealPath(const QString &path)
+{
+    QMutexLocker locker(&m_statMutex);
+
+    auto iter = m_trashPathCache.constFind(path);
+    if (iter != m_trashPathCache.constEnd()) {
+        return iter.value();
+    }
+
+    QString realPath = Libutils::base::getDeleteFullPath(Libutils::base::hashByString(path), DBImgInfo::getFileNameFromFilePath(path));
+    if (m_trashPathCache.size() >= FILE_STAT_CACHE_MAX_COUNT) {
+        m_trashPathCache.clear();
+    }
+    m_trashPathCache.insert(path, realPath);
+    return realPath;
+}
+
+QString ImageDataService::knownThumbnailPath(const QString &path)
+{
+    QMutexLocker locker(&m_statMutex);
+    return m_thumbnailPathCache.value(path);
+}
+
+void ImageDataService::addThumbnailPath(const QString &path, const QString &thumbnailPath)
+{
+    QMutexLocker locker(&m_statMutex);
+    if (m_thumbnailPathCache.size() >= FILE_STAT_CACHE_MAX_COUNT) {
+        m_thumbnailPathCache.clear();
+    }
+    m_thumbnailPathCache.insert(path, thumbnailPath);
+}
+
+void ImageDataService::invalidateFileStat(const QString &path)
+{
+    QMutexLocker locker(&m_statMutex);
+    m_fileStatCache.remove(path);
+    // 文件内容变更后缩略图路径(哈希)随之变化
+    m_thumbnailPathCache.remove(path);
+
+    // 回收站中的文件同步清除
+    auto iter = m_trashPathCache.constFind(path);
+    if (iter != m_trashPathCache.constEnd()) {
+        m_fileStatCache.remove(iter.value());
+    }
+}
+
+void ImageDataService::invalidateFileStats(const QStringList &paths)
+{
+    for (const QString &path : paths) {
+        invalidateFileStat(path);
+    }
+}
+
 QString ImageDataService::getLoadModePath(const QString &path)
 {
     if (m_loadMode == 0)
@@ -175,11 +259,12 @@ QString ImageDataService::getMovieDurationStrByPath(const QString &path)
 
 bool ImageDataService::imageIsLoaded(const QString &path, bool isTrashFile)
 {
+    QString realPath = isTrashFile ? trashRealPath(path) : QString();
+
     QMutexLocker locker(&m_imgDataMutex);
 
     bool loaded = false;
     if (isTrashFile) {
-        QString realPath = Libutils::base::getDeleteFullPath(Libutils::base::hashByString(path), DBImgInfo::getFileNameFromFilePath(path));
         loaded = pathInMap(realPath) || pathInMap(path);
     } else {
         loaded = pathInMap(path);
@@ -197,6 +282,10 @@ ImageDataService::ImageDataService(QObject *parent) : QObject(parent)
     readThread->start();
     connect(this, &ImageDataService::startImageLoad, readThumbnailManager, &ReadThumbnailManager::readThumbnail);
 
+    //文件被移动、替换、删除时清除文件状态缓存
+    m_statTimer.start();
+    connect(ImageFileWatcher::instance(), &ImageFileWatcher::imageFileChanged, this, &ImageDataService::invalidateFileStat);
+
     //初始化的时候读取上次退出时的状态
     m_loadMode = LibConfigSetter::instance()->value(SETTINGS_GROUP, SETTINGS_DISPLAY_MODE, 0).toInt();
     qDebug() << "Initial load mode set to:" << m_loadMode;
@@ -251,16 +340,22 @@ QImage ImageDataService::getThumnailImageByPathRealTime(const QString &path, boo
 {
     QString realPath;
 
+    // 重新加载时文件可能已被替换，清除文件状态缓存
+    if (bReload) {
+        invalidateFileStat(path);
+    }
+
+    // 绘制时频繁调用，使用带缓存的文件状态判断，避免网络挂载目录下反复 stat
     if (!isTrashFile) {
         realPath = path;
-        if (!QFile::exists(realPath)) {
+        if (!fileExistsCached(realPath)) {
             qWarning() << "File does not exist:" << realPath;
             return QImage();
         }
     } else {
-        realPath = Libutils::base::getDeleteFullPath(Libutils::base::hashByString(path), DBImgInfo::getFileNameFromFilePath(path));
-        if (!QFile::exists(realPath)) {
-            if (!QFile::exists(path)) {
+        realPath = trashRealPath(path);
+        if (!fileExistsCached(realPath)) {
+            if (!fileExistsCached(path)) {
                 qWarning() << "Trash file does not exist:" << path;
                 return QImage();
             } else {
@@ -352,7 +447,19 @@ void ReadThumbnailManager::readThumbnail()
         using namespace LibUnionImage_NameSpace;
         QImage tImg;
         QString srcPath = path;
-        QString thumbnailPath = Libutils::base::filePathToThumbnailPath(path);
+        // 图片文件的哈希计算和解码共享同一文件映射，视频文件仅读取头部计算哈希
+        const bool bVideo = isVideo(srcPath);
+        QScopedPointer<UnionImageProbe> probe(bVideo ? nullptr : new UnionImageProbe(srcPath));
+        // 移动设备上的文件按设备缓存缩略图，无需读取文件内容计算哈希
+        QString thumbnailPath = DeviceScanCache::instance()->thumbnailPath(path);
+        if (thumbnailPath.isEmpty()) {
+            QString dataHash;  // 未映射时为空，由 filePathToThumbnailPath 读取文件计算
+            if (probe && !probe->fileData().isEmpty()) {
+                dataHash = Libutils::base::hashByData(path, probe->fileData());
+            }
+            thumbnailPath = Libutils::base::filePathToThumbnailPath(path, dataHash);
+        }
+        ImageDataService::instance()->addThumbnailPath(path, thumbnailPath);
         thumbnailPath = ImageDataService::instance()->getLoadModePath(thumbnailPath);
 
         QFileInfo thumbnailFile(thumbnailPath);
@@ -368,7 +475,7 @@ void ReadThumbnailManager::readThumbnail()
                 }
             }
 
-            if (isVideo(srcPath)) {
+            if (bVideo) {
                 qDebug() << "Getting video info for:" << srcPath;
                 MovieInfo mi = MovieService::instance()->getMovieInfo(QUrl::fromLocalFile(srcPath));
                 ImageDataService::instance()->addMovieDurationStr(srcPath, mi.duration);
@@ -376,14 +483,18 @@ void ReadThumbnailManager::readThumbnail()
         } else {
             qDebug() << "Generating new thumbnail for:" << srcPath;
             //读图
-            if (isVideo(srcPath)) {
+            if (bVideo) {
                 tImg = MovieService::instance()->getMovieCover(QUrl::fromLocalFile(srcPath));
 
                 //获取视频信息 demo
                 MovieInfo mi = MovieService::instance()->getMovieInfo(QUrl::fromLocalFile(srcPath));
                 ImageDataService::instance()->addMovieDurationStr(path, mi.duration);
+            } else if (SvgRasterCache::isSvgFile(srcPath)) {
+                // 矢量图直接按缩略图大小光栅化，避免按默认大小渲染后再缩放
+                tImg = SvgRasterCache::instance()->image(srcPath, QSize(THUMBNAIL_MAX_SIZE, THUMBNAIL_MAX_SIZE),
+                                                         Qt::KeepAspectRatioByExpanding);
             } else {
-                if (!loadStaticImageFromFile(srcPath, tImg, errMsg)) {
+                if (!probe->read(tImg, errMsg)) {
                     qWarning() << "Failed to load image:" << errMsg;
                     ImageDataService::instance()->addImage(srcPath, tImg);
                     DBManager::m_fileMutex.unlock();
@@ -408,7 +519,8 @@ void ReadThumbnailManager::readThumbnail()
             tImg.save(thumbnailPath, "PNG"); //保存裁好的缩略图，下次读的时候直接刷进去
         }
 
-        ImageDataService::instance()->addImage(path, tImg);
+        // 在加载线程中转换为显示格式，界面绘制时无需再转换
+        ImageDataService::instance()->addImage(path, toDisplayFormat(tImg));
 
         // 成功加载缩略图，通知上层界面刷新
         emit ImageDataService::instance()->gotImage(path);
@@ -472,7 +584,7 @@ QImage ReadThumbnailManager::clipToRect(const QImage &src)
 
 QImage ReadThumbnailManager::addPadAndScaled(const QImage &src)
 {
-    auto result = src.convertToFormat(QImage::Format_RGBA8888);
+    auto result = LibUnionImage_NameSpace::toDisplayFormat(src);
 
     if (result.height() > result.width()) {
         result = result.scaledToHeight(THUMBNAIL_MAX_SIZE, Qt::SmoothTransformation);
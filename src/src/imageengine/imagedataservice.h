@@ -27,6 +27,8 @@
 #include <QMutex>
 #include <QThread>
 #include <QQueue>
+#include <QHash>
+#include <QElapsedTimer>
 #include <deque>
 
 class readThumbnailThread;
@@ -62,6 +64,15 @@ public:
     // 获取等比例缩略图存放路径
     QString getScaledPath(const QString &path);
 
+    // 获取已加载过缩略图的文件对应的缩略图路径，未加载过时返回空，不读取文件计算哈希
+    QString knownThumbnailPath(const QString &path);
+    // 记录文件对应的缩略图路径，由缩略图加载线程在确定缩略图路径后调用
+    void addThumbnailPath(const QString &path, const QString &thumbnailPath);
+
+    // 文件变更（文件监控、外部修改）后清除对应路径的文件状态缓存
+    void invalidateFileStat(const QString &path);
+    void invalidateFileStats(const QStringList &paths);
+
 private slots:
 signals:
     void sigeUpdateListview();
@@ -79,6 +90,11 @@ private:
     // 清除图片文件对应缩略图文件
     void removeThumbnailFile(const QString &path);
 
+    // 带短时缓存的文件存在判断，避免绘制/滚动时反复访问文件系统
+    bool fileExistsCached(const QString &path);
+    // 获取回收站文件的实际存放路径（缓存MD5计算结果）
+    QString trashRealPath(const QString &path);
+
 private:
     static ImageDataService *s_ImageDataService;
 
@@ -91,6 +107,15 @@ private:
     //加载模式控制
     std::atomic_int m_loadMode;
 
+    //文件状态缓存 QString:文件路径 pair<bool, qint64>:<是否存在, 检查时间(ms)>
+    QMutex m_statMutex;
+    QHash<QString, std::pair<bool, qint64>> m_fileStatCache;
+    //QString:原始路径 QString:回收站中实际路径
+    QHash<QString, QString> m_trashPathCache;
+    //QString:原始路径 QString:缩略图路径(加载缩略图时记录，避免重复计算哈希)
+    QHash<QString, QString> m_thumbnailPathCache;
+    QElapsedTimer m_statTimer;
+
     ReadThumbnailManager *readThumbnailManager;
     QThread *readThread;
 };
@@ -4,11 +4,26 @@
 
 #include "imageenginethread.h"
 #include "dbmanager/dbmanager.h"
+#include "dbmanager/formatsniffcache.h"
 #include "unionimage/unionimage.h"
+#include "unionimage/baseutils.h"
 #include "albumControl.h"
+#include "configsetter.h"
 #include <QDebug>
 
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+
+// 导入时并行解析文件信息的最大线程数
+static const int s_importMaxThreads = 8;
+// 每个解析任务处理的文件数
+static const int s_importChunkSize = 64;
+// 每个解析线程允许积压的分组数，超出时遍历阶段等待
+static const int s_importQueueFactor = 4;
+// 单次写入数据库的最大记录数
+static const int s_importBatchSize = 1000;
 
 ImageEngineThreadObject::ImageEngineThreadObject()
 {
@@ -43,6 +58,9 @@ void ImageEngineThreadObject::run()
 ImportImagesThread::ImportImagesThread()
 {
     qDebug() << "Initializing ImportImagesThread";
+    // 重复文件的处理方式由配置文件指定，默认仍然导入，与按路径判重的行为一致
+    const int mode = LibConfigSetter::instance()->value("IMPORT", "DuplicateMode", DuplicateImport).toInt();
+    m_duplicateMode = (mode >= DuplicateImport && mode <= DuplicateLink) ? DuplicateMode(mode) : DuplicateImport;
     connect(this, &ImportImagesThread::sigRepeatUrls, AlbumControl::instance(), &AlbumControl::sigRepeatUrls);
     connect(this, &ImportImagesThread::sigImportProgress, AlbumControl::instance(), &AlbumControl::sigImportProgress);
     connect(this, &ImportImagesThread::sigImportFinished, AlbumControl::instance(), &AlbumControl::sigImportFinished);
@@ -88,59 +106,223 @@ void ImportImagesThread::setNotifyUI(bool bValue)
     m_notifyUI = bValue;
 }
 
+void ImportImagesThread::setDuplicateMode(DuplicateMode mode)
+{
+    qDebug() << "Setting duplicate mode to:" << mode;
+    m_duplicateMode = mode;
+}
+
+void ImportImagesThread::setJob(const ImportJobInfo &job)
+{
+    qDebug() << "Resuming import job" << job.jobID << "for UID:" << job.UID << "committed:" << job.cursor;
+    m_paths = job.sources;
+    m_UID = job.UID;
+    m_checkRepeat = job.checkRepeat;
+    m_jobID = job.jobID;
+    m_batchID = job.batchID;
+    m_committedCount = job.cursor;
+    m_type = DataType_String;
+}
+
 bool ImportImagesThread::ifCanStopThread(void *imgobject)
 {
     Q_UNUSED(imgobject);
     return true;
 }
 
-void ImportImagesThread::runDetail()
+/**
+   @class ImportPipeline
+   @brief 导入流水线各阶段间的通道。遍历阶段按组提交待解析的文件，提交前等待空闲位置；
+        解析阶段在线程池中并行获取文件信息；写入阶段按完成顺序取出结果并释放位置，
+        以此限制遍历和解析阶段超前写入阶段的数量
+   @threadsafe
+ */
+class ImportPipeline
 {
-    qDebug() << "Starting import process for UID:" << m_UID;
-    //相册中本次导入之前已导入的所有路径
-    DBImgInfoList oldInfos = AlbumControl::instance()->getAllInfosByUID(QString::number(m_UID));
-    QStringList allOldImportedPaths;
-    for (DBImgInfo info : oldInfos) {
-        allOldImportedPaths.push_back(info.filePath);
+public:
+    // 一组待解析的文件
+    struct Chunk
+    {
+        QStringList paths;
+        bool filterMedia { false };  // 目录中遍历的文件，需要过滤非图片视频文件
+    };
+
+    // 一组文件的解析结果
+    struct Result
+    {
+        int walked { 0 };          // 遍历的文件数
+        int count { 0 };           // 图片视频文件数
+        QStringList existPaths;    // 已导入的文件
+        QStringList duplicatePaths; // 内容与已导入文件相同的文件
+        QStringList originPaths;   // 与 duplicatePaths 对应的已导入文件
+        DBImgInfoList infos;       // 待导入的文件信息
+    };
+
+    explicit ImportPipeline(int capacity)
+        : capacity(capacity)
+    {
     }
-    qDebug() << "Found" << allOldImportedPaths.size() << "previously imported paths";
 
-    QStringList tempPaths;
-    QStringList filePaths;
-    DBImgInfoList dbInfos;
-    //判断是否含有目录
-    for (QString path : m_paths) {
-        //是目录，向下遍历,得到所有文件
-        if (QDir(path).exists()) {
-            qDebug() << "Processing directory:" << path;
-            QFileInfoList infos = LibUnionImage_NameSpace::getImagesAndVideoInfo(path, true);
-
-            std::transform(infos.begin(), infos.end(), std::back_inserter(tempPaths), [](const QFileInfo & info) {
-                return info.absoluteFilePath();
-            });
-            qDebug() << "Found" << infos.size() << "files in directory";
-        } else {//非目录
-            qDebug() << "Processing file:" << path;
-            tempPaths << path;
+    /**
+       @brief 等待存在空闲位置并占用，用于遍历阶段提交新的分组
+       @return 流水线已停止时返回 false
+     */
+    bool acquire()
+    {
+        QMutexLocker _locker(&mutex);
+        while (!stopped && pending >= capacity) {
+            notFull.wait(&mutex);
+        }
+        if (stopped) {
+            return false;
         }
+        pending++;
+        submitted++;
+        return true;
     }
 
-    //条件过滤
-    int noReadCount = 0; //记录已存在于相册中的数量，若全部存在，则不进行导入操作
-    int i = 0;
-    for (QString imagePath : tempPaths) {
-        i++;
-        //已导入
-        if (allOldImportedPaths.contains(imagePath)) {
-            qDebug() << "Skipping already imported file:" << imagePath;
-            m_checkRepeat = true;
-            noReadCount++;
-            continue;
+    void push(Result &&result)
+    {
+        QMutexLocker _locker(&mutex);
+        results.enqueue(std::move(result));
+        notEmpty.wakeAll();
+    }
+
+    /**
+       @brief 取出解析完成的结果至 \a result ，无结果时等待
+       @return 遍历完成且所有结果均已取出，或流水线已停止时返回 false
+     */
+    bool take(Result &result)
+    {
+        QMutexLocker _locker(&mutex);
+        while (!stopped && results.isEmpty() && !(walkDone && taken == submitted)) {
+            notEmpty.wait(&mutex);
+        }
+        if (stopped || results.isEmpty()) {
+            return false;
+        }
+
+        result = results.dequeue();
+        taken++;
+        pending--;
+        notFull.wakeAll();
+        return true;
+    }
+
+    void addWalked(int count)
+    {
+        QMutexLocker _locker(&mutex);
+        walked += count;
+    }
+
+    int walkedCount()
+    {
+        QMutexLocker _locker(&mutex);
+        return walked;
+    }
+
+    void finishWalk()
+    {
+        QMutexLocker _locker(&mutex);
+        walkDone = true;
+        notEmpty.wakeAll();
+    }
+
+    void stop()
+    {
+        QMutexLocker _locker(&mutex);
+        stopped = true;
+        notFull.wakeAll();
+        notEmpty.wakeAll();
+    }
+
+    bool isStopped()
+    {
+        QMutexLocker _locker(&mutex);
+        return stopped;
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition notFull;
+    QWaitCondition notEmpty;
+    QQueue<Result> results;
+    const int capacity;
+    int pending { 0 };    ///< 已提交但尚未被写入阶段取出的分组数
+    int submitted { 0 };
+    int taken { 0 };
+    int walked { 0 };
+    bool walkDone { false };
+    bool stopped { false };
+};
+
+/**
+   @return 与 \a info 内容相同的已导入文件路径，先按文件大小和内容标识查询，再逐字节确认，不存在时返回空
+ */
+static QString findDuplicate(const DBImgInfo &info)
+{
+    const QStringList candidates = DBManager::instance()->getPathsByContent(info.fileSize, info.contentHash);
+    for (const QString &candidate : candidates) {
+        // 相同路径导入至其它相册时不视为重复
+        if (candidate != info.filePath && Libutils::base::sameFileContent(candidate, info.filePath)) {
+            return candidate;
         }
+    }
+    return QString();
+}
+
+void ImportImagesThread::runDetail()
+{
+    qDebug() << "Starting import process for UID:" << m_UID;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    //记录导入任务，中断后下次启动时从最后提交的批次继续
+    if (m_jobID < 0) {
+        m_jobID = DBManager::instance()->createImportJob(m_paths, m_UID, m_checkRepeat);
+    }
+
+    //相册中本次导入之前已导入的所有路径，使用哈希集合查找，过滤耗时与导入文件数成线性关系
+    const QSet<QString> allOldImportedPaths = DBManager::instance()->getPathSetByUID(QString::number(m_UID));
+    qDebug() << "Found" << allOldImportedPaths.size() << "previously imported paths";
+
+    // 解析阶段使用独立的线程池，额外的一个线程用于遍历阶段
+    const int probeThreads = qBound(1, QThread::idealThreadCount(), s_importMaxThreads);
+    ImportPipeline pipeline(probeThreads * s_importQueueFactor);
+    QThreadPool probePool;
+    probePool.setMaxThreadCount(probeThreads + 1);
+
+    const QString albumUID = QString::number(m_UID);
+    const DuplicateMode duplicateMode = m_duplicateMode;
+    auto probeChunk = [&pipeline, &allOldImportedPaths, albumUID, duplicateMode, this](const ImportPipeline::Chunk &chunk) {
+        ImportPipeline::Result result;
+        result.walked = chunk.paths.size();
+        for (const QString &imagePath : chunk.paths) {
+            if (bneedstop || pipeline.isStopped()) {
+                break;
+            }
+
+            //去掉目录中非图片视频的文件
+            if (chunk.filterMedia && !LibUnionImage_NameSpace::imageSupportRead(imagePath)
+                    && !LibUnionImage_NameSpace::isVideo(imagePath)) {
+                continue;
+            }
+            result.count++;
+
+            //已导入
+            if (allOldImportedPaths.contains(imagePath)) {
+                qDebug() << "Skipping already imported file:" << imagePath;
+                result.existPaths << imagePath;
+                continue;
+            }
+
+            //当前文件存在和可读
+            QFileInfo info(imagePath);
+            if (!info.exists() || !info.isReadable()) {
+                qWarning() << "Skipping inaccessible file:" << imagePath;
+                continue;
+            }
 
-        //当前文件存在和可读
-        QFileInfo info(imagePath);
-        if (info.exists() && info.isReadable()) {
             //去掉不支持的图片和视频
             bool bIsVideo = LibUnionImage_NameSpace::isVideo(imagePath);
             if (!bIsVideo && !LibUnionImage_NameSpace::imageSupportRead(imagePath)) {
@@ -154,53 +336,191 @@ void ImportImagesThread::runDetail()
                 qWarning() << "Skipping file with invalid format:" << imagePath;
                 continue;
             }
-            dbInfo.albumUID = QString::number(m_UID);
-            dbInfos << dbInfo;
 
-            filePaths << imagePath;
-            qDebug() << "Added file to import list:" << imagePath;
-        } else {
-            qWarning() << "Skipping inaccessible file:" << imagePath;
+            //内容与已导入的文件相同
+            if (DuplicateImport != duplicateMode) {
+                const QString originPath = findDuplicate(dbInfo);
+                if (!originPath.isEmpty()) {
+                    qDebug() << "Skipping duplicate file:" << imagePath << "same as:" << originPath;
+                    result.duplicatePaths << imagePath;
+                    result.originPaths << originPath;
+                    continue;
+                }
+            }
+            dbInfo.albumUID = albumUID;
+            result.infos << dbInfo;
+        }
+        pipeline.push(std::move(result));
+    };
+
+    // 遍历阶段：逐个目录遍历文件，按组提交至解析阶段，解析积压时等待
+    auto submitChunk = [&pipeline, &probePool, probeChunk](ImportPipeline::Chunk &chunk) {
+        if (chunk.paths.isEmpty()) {
+            return true;
+        }
+        if (!pipeline.acquire()) {
+            return false;
+        }
+        pipeline.addWalked(chunk.paths.size());
+        probePool.start([probeChunk, chunk]() { probeChunk(chunk); });
+        chunk.paths.clear();
+        return true;
+    };
+    probePool.start([&pipeline, submitChunk, this]() {
+        ImportPipeline::Chunk chunk;
+        QSet<QString> walkedPaths;  // 同时选中目录及其中的文件时，每个文件仅导入一次
+        for (const QString &path : m_paths) {
+            if (bneedstop) {
+                break;
+            }
+
+            //是目录，向下遍历,得到所有文件
+            if (QDir(path).exists()) {
+                qDebug() << "Processing directory:" << path;
+                if (!submitChunk(chunk)) {
+                    break;
+                }
+                chunk.filterMedia = true;
+                QDirIterator dirIterator(path, QDir::Files, QDirIterator::Subdirectories);
+                while (dirIterator.hasNext() && !bneedstop) {
+                    dirIterator.next();
+                    const QString filePath = dirIterator.fileInfo().absoluteFilePath();
+                    if (walkedPaths.contains(filePath)) {
+                        continue;
+                    }
+                    walkedPaths.insert(filePath);
+                    chunk.paths << filePath;
+                    if (chunk.paths.size() >= s_importChunkSize && !submitChunk(chunk)) {
+                        break;
+                    }
+                }
+                if (!submitChunk(chunk)) {
+                    break;
+                }
+                chunk.filterMedia = false;
+            } else {//非目录
+                qDebug() << "Processing file:" << path;
+                if (walkedPaths.contains(path)) {
+                    continue;
+                }
+                walkedPaths.insert(path);
+                chunk.paths << path;
+                if (chunk.paths.size() >= s_importChunkSize && !submitChunk(chunk)) {
+                    break;
+                }
+            }
+        }
+        submitChunk(chunk);
+        pipeline.finishWalk();
+    });
+
+    // 写入阶段：汇总解析结果，分批写入数据库并报告进度
+    AlbumDBType atype = (m_UID == 0) ? AlbumDBType::Favourite : AlbumDBType::AutoImport;
+    auto writeBatch = [this, atype](DBImgInfoList &batch) {
+        if (batch.isEmpty()) {
+            return;
+        }
+        std::sort(batch.begin(), batch.end(), [](const DBImgInfo & lhs, const DBImgInfo & rhs) {
+            return lhs.changeTime > rhs.changeTime;
+        });
+
+        //导入图片数据库ImageTable3和AlbumTable3，并推进导入任务进度，三者在同一事务中提交
+        qDebug() << "Committing batch" << m_batchID + 1 << "with" << batch.size() << "images into album" << m_UID
+                 << "type:" << static_cast<int>(atype);
+        DBManager::instance()->commitImportBatch(m_jobID, ++m_batchID, batch, m_UID, atype);
+        batch.clear();
+    };
+
+    int totalCount = 0;    //图片视频文件总数
+    int noReadCount = 0;   //记录已存在于相册中的数量，若全部存在，则不进行导入操作
+    int importCount = 0;
+    int processed = 0;
+    QStringList existPaths;
+    QStringList linkPaths;
+    QHash<QPair<qint64, quint64>, QString> importContents;  // 本次导入的文件内容标识，过滤本次导入中内容相同的文件
+    DBImgInfoList batch;
+    ImportPipeline::Result result;
+    while (pipeline.take(result)) {
+        if (bneedstop) {
+            break;
+        }
+
+        totalCount += result.count;
+        // 内容重复的文件与已导入的文件同样处理
+        result.existPaths << result.duplicatePaths;
+        linkPaths << result.originPaths;
+        for (const DBImgInfo &info : result.infos) {
+            if (DuplicateImport != m_duplicateMode && 0 != info.contentHash) {
+                const QPair<qint64, quint64> key(info.fileSize, info.contentHash);
+                auto itr = importContents.constFind(key);
+                if (itr == importContents.constEnd()) {
+                    importContents.insert(key, info.filePath);
+                } else if (Libutils::base::sameFileContent(itr.value(), info.filePath)) {
+                    qDebug() << "Skipping duplicate file:" << info.filePath << "same as:" << itr.value();
+                    result.existPaths << info.filePath;
+                    continue;
+                }
+            }
+            batch << info;
+            importCount++;
+        }
+
+        noReadCount += result.existPaths.size();
+        if (!result.existPaths.isEmpty()) {
+            m_checkRepeat = true;
+            existPaths << result.existPaths;
+        }
+        if (batch.size() >= s_importBatchSize) {
+            writeBatch(batch);
         }
-        emit sigImportProgress(i, tempPaths.size());
+
+        processed += result.walked;
+        emit sigImportProgress(processed, pipeline.walkedCount());
     }
+    pipeline.stop();
+    probePool.waitForDone();
 
-    //已全部存在，无需导入
-    if (noReadCount == tempPaths.size() && tempPaths.size() > 0 && m_checkRepeat) {
+    //导入过程中嗅探的文件格式一并保存，不论导入是否停止、是否有文件写入
+    FormatSniffCache::instance()->flush();
+
+    //停止时保留导入任务记录，下次启动时恢复
+    if (bneedstop) {
+        qWarning() << "Import process stopped, processed:" << processed;
+        return;
+    }
+
+    writeBatch(batch);
+
+    //内容重复的文件关联已导入的相同文件
+    if (DuplicateLink == m_duplicateMode && m_UID >= 0 && !linkPaths.isEmpty()) {
+        qDebug() << "Linking" << linkPaths.size() << "duplicate files into album" << m_UID;
+        DBManager::instance()->insertIntoAlbum(m_UID, linkPaths, atype);
+    }
+
+    //所有文件均已处理，清理相册重复记录并结束导入任务
+    DBManager::instance()->finishImportJob(m_jobID, atype);
+    emit sigImportCommitted();
+
+    //已全部存在，无需导入；恢复的任务中此前已提交的文件不视为重复
+    if (noReadCount == totalCount && totalCount > 0 && m_checkRepeat && 0 == m_committedCount) {
         qDebug() << "All files already exist in album, skipping import";
         QStringList urlPaths;
-        for (QString path : tempPaths) {
+        for (QString path : existPaths) {
             urlPaths.push_back("file://" + path);
         }
         emit sigRepeatUrls(urlPaths);
         return;
     }
-    if (filePaths.isEmpty()) {
+    if (0 == importCount + m_committedCount) {
         // 存在无法导入
-        int skiped = tempPaths.size() - noReadCount;
+        int skiped = totalCount - noReadCount;
         qWarning() << "No valid files to import, skipped:" << skiped;
         emit sigImportFailed(skiped);
         return;
     }
 
-    qDebug() << "Sorting" << dbInfos.size() << "files by change time";
-    std::sort(dbInfos.begin(), dbInfos.end(), [](const DBImgInfo & lhs, const DBImgInfo & rhs) {
-        return lhs.changeTime > rhs.changeTime;
-    });
-
-    //导入图片数据库ImageTable3
-    qDebug() << "Inserting" << dbInfos.size() << "images into database";
-    DBManager::instance()->insertImgInfos(dbInfos);
-
-    //导入图片数据库AlbumTable3
-    if (m_UID >= 0) {
-        AlbumDBType atype = AlbumDBType::AutoImport;
-        if (m_UID == 0) {
-            atype = AlbumDBType::Favourite;
-        }
-        qDebug() << "Inserting" << filePaths.size() << "files into album" << m_UID << "type:" << static_cast<int>(atype);
-        DBManager::instance()->insertIntoAlbum(m_UID, filePaths, atype);
-    }
+    qInfo() << "Imported" << importCount << "of" << totalCount << "files with" << probeThreads << "threads, previously committed:"
+            << m_committedCount << "elapsed(ms):" << elapsedTimer.elapsed();
 
     //原createNewCustomAutoImportAlbum逻辑
     if (m_UID > 0) {
@@ -209,7 +529,6 @@ void ImportImagesThread::runDetail()
         emit AlbumControl::instance()->sigAddCustomAlbum(m_UID);
     }
 
-    QThread::msleep(100);
     //发送导入完成信号
     if (m_notifyUI) {
         qDebug() << "Import process completed, notifying UI";
@@ -218,4 +537,3 @@ void ImportImagesThread::runDetail()
         qDebug() << "Import process completed without UI notification";
     }
 }
-
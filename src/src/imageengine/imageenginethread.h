@@ -14,6 +14,8 @@
 #include <QUrl>
 #include <QWaitCondition>
 
+#include "unionimage/unionimage_global.h"
+
 class ImageEngineThreadObject;
 
 //这里将QRunnable继承转移到这里，方便将run函数的实现也转移过来
@@ -45,11 +47,21 @@ class ImportImagesThread : public ImageEngineThreadObject
 {
     Q_OBJECT
 public:
+    //内容与已导入文件相同时的处理方式
+    enum DuplicateMode {
+        DuplicateImport,    //仍然导入
+        DuplicateSkip,      //跳过
+        DuplicateLink       //跳过，并将已导入的相同文件加入目标相册
+    };
+
     ImportImagesThread();
     ~ImportImagesThread() override;
     void setData(const QStringList &paths, const int UID);
     void setData(const QList<QUrl> &paths, const int UID, const bool checkRepeat);
     void setNotifyUI(bool bValue);
+    void setDuplicateMode(DuplicateMode mode);
+    //恢复中断的导入任务
+    void setJob(const ImportJobInfo &job);
 
 protected:
     bool ifCanStopThread(void *imgobject) override;
@@ -59,6 +71,8 @@ signals:
     void runFinished();
     //导入完成信号
     void sigImportFinished();
+    //导入数据已全部写入数据库，导入任务结束，不论是否通知界面
+    void sigImportCommitted();
     //导入失败信号
     void sigImportFailed(int error);
     //导入文件重复信号
@@ -78,6 +92,10 @@ private:
     DataType m_type = DataType_NULL;
     bool m_notifyUI = true;
     bool m_checkRepeat = true;
+    DuplicateMode m_duplicateMode = DuplicateImport;
+    int m_jobID = -1;       //导入任务记录
+    int m_batchID = 0;      //最后提交的批次号
+    int m_committedCount = 0; //恢复的导入任务中此前已提交的文件数
 };
 
 #endif // IMAGEENGINETHREAD_H
@@ -111,12 +111,15 @@ void PrintHelper::showPrintDialog(const QStringList &paths, QWidget *parent)
     for (const QString &path : paths) {
         qDebug() << "Processing file for printing:" << path;
         QString errMsg;
-        QImageReader imgReadreder(path);
-        if (imgReadreder.imageCount() > 1) {
-            qDebug() << "Found multi-page image with" << imgReadreder.imageCount() << "pages";
-            for (int imgindex = 0; imgindex < imgReadreder.imageCount(); imgindex++) {
-                imgReadreder.jumpToImage(imgindex);
-                m_re->m_imgs << imgReadreder.read();
+        // 依次读取各页共享同一解码器，无需每页从首页查找
+        LibUnionImage_NameSpace::ImageFrameReader frameReader(path);
+        const int pageCount = frameReader.frameCount();
+        if (pageCount > 1) {
+            qDebug() << "Found multi-page image with" << pageCount << "pages";
+            for (int imgindex = 0; imgindex < pageCount; imgindex++) {
+                QImage page;
+                frameReader.read(imgindex, page, errMsg);
+                m_re->m_imgs << page;
             }
         } else {
             //QImage不应该多次赋值，所以换到这里来，修复style问题
@@ -7,6 +7,7 @@
 #include "configsetter.h"
 #include "imageengine/movieservice.h"
 #include "dbmanager/dbmanager.h"
+#include "imagedata/svgrastercache.h"
 #include <QPainter>
 
 const QString SETTINGS_GROUP = "Thumbnail";
@@ -653,7 +654,7 @@ QImage ImagePublisher::clipToRect(const QImage &src)
 //将图片按比例缩小
 QImage ImagePublisher::addPadAndScaled(const QImage &src)
 {
-    auto result = src.convertToFormat(QImage::Format_RGBA8888);
+    auto result = LibUnionImage_NameSpace::toDisplayFormat(src);
 
     if (result.height() > result.width()) {
         result = result.scaledToHeight(THUMBNAIL_MAX_SIZE, Qt::SmoothTransformation);
@@ -676,7 +677,13 @@ QImage ImagePublisher::requestImage(const QString &id, QSize *size, const QSize
     qDebug() << "Requesting image:" << localPath << "Requested size:" << requestedSize;
     QString error;
     QImage image;
-    LibUnionImage_NameSpace::loadStaticImageFromFile(localPath, image, error);
+    if (SvgRasterCache::isSvgFile(localPath)) {
+        // 矢量图按请求大小所属档位光栅化，图标较多的目录滚动时复用缓存，无需重复解析
+        image = SvgRasterCache::instance()->image(localPath, requestedSize,
+                                                  m_loadMode == 0 ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio);
+    } else {
+        LibUnionImage_NameSpace::loadStaticImageFromFile(localPath, image, error);
+    }
     if (!error.isEmpty()) {
         qWarning() << "Failed to load image:" << localPath << "Error:" << error;
     }
@@ -686,6 +693,7 @@ QImage ImagePublisher::requestImage(const QString &id, QSize *size, const QSize
         qDebug() << "Loading video cover for:" << localPath;
         image = MovieService::instance()->getMovieCover(url);
     }
+    image = LibUnionImage_NameSpace::toDisplayFormat(image);
 
     if (m_loadMode == 0) {
         qDebug() << "Using clip mode for image processing";
@@ -763,7 +771,7 @@ QImage CollectionPublisher::createYearImage(const QString &year)
     QImage image;
     QString error;
     LibUnionImage_NameSpace::loadStaticImageFromFile(picPath, image, error);
-    image = image.scaled(outputWidth, outputHeight, Qt::KeepAspectRatioByExpanding);
+    image = LibUnionImage_NameSpace::toDisplayFormat(image).scaled(outputWidth, outputHeight, Qt::KeepAspectRatioByExpanding);
 
     return image;
 }
@@ -792,7 +800,7 @@ QImage CollectionPublisher::createMonthCellImage(const QString &path, const Coll
         image = MovieService::instance()->getMovieCover(QUrl::fromLocalFile(path));
     else
         LibUnionImage_NameSpace::loadStaticImageFromFile(path, image, error);
-    image = image.scaled(outputWidth, outputHeight, Qt::KeepAspectRatioByExpanding);
+    image = LibUnionImage_NameSpace::toDisplayFormat(image).scaled(outputWidth, outputHeight, Qt::KeepAspectRatioByExpanding);
 
     // 2.根据比例裁剪
     image = clipHelper(image, requestSize.width(), requestSize.height());
@@ -850,7 +858,13 @@ void AsyncImageResponseAlbum::run()
 
     qDebug() << "Processing async image:" << localPath;
     QString error;
-    LibUnionImage_NameSpace::loadStaticImageFromFile(localPath, m_image, error);
+    if (SvgRasterCache::isSvgFile(localPath)) {
+        // 矢量图按请求大小所属档位光栅化，图标较多的目录滚动时复用缓存，无需重复解析
+        m_image = SvgRasterCache::instance()->image(localPath, m_requestedSize,
+                                                    m_loadMode == 0 ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio);
+    } else {
+        LibUnionImage_NameSpace::loadStaticImageFromFile(localPath, m_image, error);
+    }
     if (!error.isEmpty()) {
         qWarning() << "Failed to load async image:" << localPath << "Error:" << error;
     }
@@ -860,6 +874,8 @@ void AsyncImageResponseAlbum::run()
         qDebug() << "Loading video cover for:" << localPath;
         m_image = MovieService::instance()->getMovieCover(url);
     }
+    // 在加载线程中统一转换为显示格式，后续裁剪缩放及上传纹理时无需再转换
+    m_image = LibUnionImage_NameSpace::toDisplayFormat(m_image);
 
     if (m_loadMode == 0) {
         qDebug() << "Using clip mode for async image processing";
@@ -927,7 +943,7 @@ QImage AsyncImageResponseAlbum::clipToRect(const QImage &src)
 //将图片按比例缩小
 QImage AsyncImageResponseAlbum::addPadAndScaled(const QImage &src)
 {
-    auto result = src.convertToFormat(QImage::Format_RGBA8888);
+    auto result = LibUnionImage_NameSpace::toDisplayFormat(src);
 
     if (result.height() > result.width()) {
         result = result.scaledToHeight(THUMBNAIL_MAX_SIZE, Qt::SmoothTransformation);
@@ -18,7 +18,7 @@ ImageDataModel::ImageDataModel(QObject *parent)
     , m_dayToken("")
 {
     qDebug() << "Initializing ImageDataModel";
-    connect(AlbumControl::instance(), &AlbumControl::deviceAlbumInfoLoadFinished, this, &ImageDataModel::onDeviceDataLoaded);
+    connect(AlbumControl::instance(), &AlbumControl::deviceAlbumInfoBatchLoaded, this, &ImageDataModel::onDeviceDataBatchLoaded);
 }
 
 QHash<int, QByteArray> ImageDataModel::roleNames() const
@@ -235,8 +235,7 @@ void ImageDataModel::loadData(Types::ItemType type)
         bool waiting = false;
         m_infoList = AlbumControl::instance()->getDeviceAlbumInfoList(m_devicePath, m_loadType, &waiting);
         if (waiting) {
-            m_infoList.clear();
-            qDebug() << "Device data not ready, refresh later";
+            qDebug() << "Device data still loading, remaining items will be appended";
         }
     } else if (m_modelType == Types::SearchResult) {
         qDebug() << "Loading search results for keyword:" << m_keyWord << "in album:" << m_albumID;
@@ -252,17 +251,25 @@ void ImageDataModel::loadData(Types::ItemType type)
     qDebug() << QString("loadData modelType:[%1] cost [%2]ms, loaded [%3] items").arg(m_modelType).arg(time.elapsed()).arg(m_infoList.size());
 }
 
-void ImageDataModel::onDeviceDataLoaded(QString devicePath)
+void ImageDataModel::onDeviceDataBatchLoaded(const QString &devicePath, const DBImgInfoList &infos)
 {
-    if (devicePath != m_devicePath) {
-        qDebug() << "Ignoring device data load for different path:" << devicePath;
+    if (m_modelType != Types::Device || devicePath != m_devicePath) {
         return;
     }
 
-    qDebug() << "Refreshing model with device data for path:" << devicePath;
-    beginResetModel();
-    m_infoList = AlbumControl::instance()->getDeviceAlbumInfoList(m_devicePath, m_loadType);
-    endResetModel();
+    DBImgInfoList appendList;
+    for (const DBImgInfo &info : infos) {
+        if (ItemTypeNull == m_loadType || m_loadType == info.itemType) {
+            appendList << info;
+        }
+    }
+    if (appendList.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_infoList.size(), m_infoList.size() + appendList.size() - 1);
+    m_infoList << appendList;
+    endInsertRows();
 
-    qDebug() << "Device data ready, refreshed model with" << m_infoList.size() << "items";
+    qDebug() << "Appended" << appendList.size() << "device items, total:" << m_infoList.size();
 }
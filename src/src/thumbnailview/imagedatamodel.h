@@ -49,7 +49,7 @@ public:
 
     Q_INVOKABLE void loadData(Types::ItemType type = Types::All);
 
-    Q_SLOT void onDeviceDataLoaded(QString devicePath);
+    Q_SLOT void onDeviceDataBatchLoaded(const QString &devicePath, const DBImgInfoList &infos);
 
 signals:
     void modelTypeChanged();
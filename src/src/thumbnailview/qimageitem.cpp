@@ -14,13 +14,121 @@
 
 DGUI_USE_NAMESPACE
 
-#include <QPainter>
+#include <QHash>
+#include <QMutex>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSharedPointer>
 #include <QTimer>
 
+namespace {
+
+// 共享纹理的键
+struct ImageTextureKey
+{
+    QQuickWindow *window;
+    qint64 cacheKey;
+    bool tiled;  // 平铺模式需要设置纹理重复，不与其它模式共享
+
+    bool operator==(const ImageTextureKey &other) const
+    {
+        return window == other.window && cacheKey == other.cacheKey && tiled == other.tiled;
+    }
+};
+
+size_t qHash(const ImageTextureKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.window, key.cacheKey, key.tiled);
+}
+
+/**
+   @brief 缩略图纹理共享缓存，以窗口、图像 cacheKey 及是否平铺为键，
+        相同的图像数据仅上传一次纹理，最后一个引用纹理的节点销毁时释放纹理
+   @threadsafe
+ */
+class ImageTextureCache
+{
+public:
+    static ImageTextureCache *instance()
+    {
+        static ImageTextureCache ins;
+        return &ins;
+    }
+
+    /**
+       @return \a window 中 \a image 对应的纹理，不存在时上传纹理并缓存，仅在渲染线程中调用
+     */
+    QSharedPointer<QSGTexture> texture(QQuickWindow *window, const QImage &image, bool tiled)
+    {
+        const ImageTextureKey key { window, image.cacheKey(), tiled };
+        QMutexLocker _locker(&mutex);
+        QSharedPointer<QSGTexture> shared = textures.value(key).toStrongRef();
+        if (shared) {
+            return shared;
+        }
+
+        QSGTexture *created = window->createTextureFromImage(image);
+        if (!created) {
+            qWarning() << "Failed to create texture for image:" << image.size();
+            return shared;
+        }
+        if (tiled) {
+            created->setHorizontalWrapMode(QSGTexture::Repeat);
+            created->setVerticalWrapMode(QSGTexture::Repeat);
+        }
+
+        shared = QSharedPointer<QSGTexture>(created, [this, key](QSGTexture *released) { release(key, released); });
+        textures.insert(key, shared);
+        return shared;
+    }
+
+private:
+    void release(const ImageTextureKey &key, QSGTexture *texture)
+    {
+        QMutexLocker _locker(&mutex);
+        // 释放前可能已为相同图像重新创建了纹理
+        if (textures.value(key).isNull()) {
+            textures.remove(key);
+        }
+        delete texture;
+    }
+
+    QMutex mutex;
+    QHash<ImageTextureKey, QWeakPointer<QSGTexture>> textures;
+};
+
+/**
+   @brief 缩略图场景图节点，持有共享纹理的引用，节点在渲染线程销毁时释放引用
+ */
+class ImageTextureNode : public QSGNode
+{
+public:
+    explicit ImageTextureNode(QSGImageNode *node)
+        : imageNode(node)
+    {
+        imageNode->setOwnsTexture(false);
+        appendChildNode(imageNode);
+    }
+
+    ~ImageTextureNode() override
+    {
+        // 先销毁使用纹理的节点，再释放纹理引用
+        removeChildNode(imageNode);
+        delete imageNode;
+    }
+
+    QSGImageNode *imageNode;
+    QSharedPointer<QSGTexture> texture;
+    qint64 cacheKey { 0 };
+    bool tiled { false };
+};
+
+}  // namespace
+
 QImage QImageItem::s_damage = QImage();
 
 QImageItem::QImageItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent)
+    : QQuickItem(parent)
     , m_smooth(false)
     , m_fillMode(QImageItem::Stretch)
 {
@@ -136,41 +244,84 @@ void QImageItem::setFillMode(QImageItem::FillMode mode)
     Q_EMIT fillModeChanged();
 }
 
-void QImageItem::paint(QPainter *painter)
+/**
+   @return 当前显示的图像，图片为空时为撕裂图
+ */
+const QImage &QImageItem::displayImage() const
 {
-    QImage *pImage = nullptr;
+    return m_image.isNull() ? s_damage : m_image;
+}
 
-    // 图片为空时，显示撕裂图
-    if (m_image.isNull()) {
-        qDebug() << "Painting damage image - source image is null";
-        pImage = &s_damage;
-    } else {
-        pImage = &m_image;
+/**
+   @brief 在渲染线程中更新纹理节点，图像未变更时仅更新显示区域，不重新上传纹理
+ */
+QSGNode *QImageItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    const QImage &image = displayImage();
+    if (image.isNull() || m_paintedRect.isEmpty() || !window()) {
+        delete oldNode;
+        return nullptr;
     }
 
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, m_smooth);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
-
-    if (m_fillMode == TileVertically) {
-        painter->scale(width() / (qreal)pImage->width(), 1);
+    ImageTextureNode *node = static_cast<ImageTextureNode *>(oldNode);
+    if (!node) {
+        node = new ImageTextureNode(window()->createImageNode());
     }
 
-    if (m_fillMode == TileHorizontally) {
-        painter->scale(1, height() / (qreal)pImage->height());
+    const bool tiled = m_fillMode == Tile || m_fillMode == TileVertically || m_fillMode == TileHorizontally;
+    if (!node->texture || node->cacheKey != image.cacheKey() || node->tiled != tiled) {
+        node->texture = ImageTextureCache::instance()->texture(window(), image, tiled);
+        node->cacheKey = image.cacheKey();
+        node->tiled = tiled;
+        if (!node->texture) {
+            delete node;
+            return nullptr;
+        }
+        node->imageNode->setTexture(node->texture.data());
     }
 
-    if (m_fillMode == Pad) {
-        QRect centeredRect = m_paintedRect;
-        centeredRect.moveCenter(pImage->rect().center());
-        painter->drawImage(m_paintedRect, *pImage, centeredRect);
-    } else if (m_fillMode >= Tile) {
-        painter->drawTiledPixmap(m_paintedRect, QPixmap::fromImage(*pImage));
-    } else {
-        painter->drawImage(m_paintedRect, *pImage, pImage->rect());
+    const QRectF imageRect = image.rect();
+    QRectF targetRect = m_paintedRect;
+    QRectF sourceRect = imageRect;
+    switch (m_fillMode) {
+    case PreserveAspectCrop: {
+        // 仅绘制组件范围内的部分
+        const QRectF visibleRect = targetRect & boundingRect();
+        const qreal scaleX = imageRect.width() / targetRect.width();
+        const qreal scaleY = imageRect.height() / targetRect.height();
+        sourceRect = QRectF((visibleRect.x() - targetRect.x()) * scaleX, (visibleRect.y() - targetRect.y()) * scaleY,
+                            visibleRect.width() * scaleX, visibleRect.height() * scaleY);
+        targetRect = visibleRect;
+        break;
+    }
+    case Pad: {
+        QRectF centeredRect = targetRect;
+        centeredRect.moveCenter(imageRect.center());
+        sourceRect = centeredRect & imageRect;
+        targetRect = QRectF(targetRect.topLeft() + (sourceRect.topLeft() - centeredRect.topLeft()), sourceRect.size());
+        break;
+    }
+    case Tile:
+        // 纹理设置为重复，源区域超出纹理大小时平铺
+        sourceRect = QRectF(QPointF(0, 0), targetRect.size());
+        break;
+    case TileVertically:
+        targetRect = boundingRect();
+        sourceRect = QRectF(0, 0, imageRect.width(), targetRect.height());
+        break;
+    case TileHorizontally:
+        targetRect = boundingRect();
+        sourceRect = QRectF(0, 0, targetRect.width(), imageRect.height());
+        break;
+    default:
+        break;
     }
 
-    painter->restore();
+    node->imageNode->setFiltering(m_smooth ? QSGTexture::Linear : QSGTexture::Nearest);
+    node->imageNode->setRect(targetRect);
+    node->imageNode->setSourceRect(sourceRect);
+    return node;
 }
 
 bool QImageItem::isNull() const
@@ -190,13 +341,7 @@ int QImageItem::paintedHeight() const
 
 void QImageItem::updatePaintedRect()
 {
-    QImage *pImage = nullptr;
-
-    if (m_image.isNull()) {
-        pImage = &s_damage;
-    } else {
-        pImage = &m_image;
-    }
+    const QImage *pImage = &displayImage();
 
     QRectF sourceRect = m_paintedRect;
     QRectF destRect;
@@ -253,10 +398,11 @@ void QImageItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeom
 #endif
 {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    QQuickPaintedItem::geometryChanged(newGeometry, oldGeometry);
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
 #else
-    QQuickPaintedItem::geometryChange(newGeometry, oldGeometry);
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
 #endif
     qDebug() << "Geometry changed from" << oldGeometry << "to" << newGeometry;
     updatePaintedRect();
+    update();
 }
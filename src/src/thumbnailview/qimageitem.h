@@ -9,9 +9,13 @@
 #define QIMAGEITEM_H
 
 #include <QImage>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 
-class QImageItem : public QQuickPaintedItem
+/**
+   @brief 缩略图显示组件，通过场景图纹理节点绘制图像，每张图像仅上传一次纹理，
+        相同的图像数据(QImage::cacheKey() 相同)在同一窗口中共享纹理
+ */
+class QImageItem : public QQuickItem
 {
     Q_OBJECT
 
@@ -56,8 +60,6 @@ public:
     FillMode fillMode() const;
     void setFillMode(FillMode mode);
 
-    void paint(QPainter *painter) override;
-
     bool isNull() const;
 
 Q_SIGNALS:
@@ -70,6 +72,7 @@ Q_SIGNALS:
     void paintedHeightChanged();
 
 protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 #else
@@ -79,6 +82,8 @@ protected:
 private:
     static QImage s_damage;
 private:
+    const QImage &displayImage() const;
+
     QImage m_image;
     bool m_smooth;
     FillMode m_fillMode;
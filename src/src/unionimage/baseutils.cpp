@@ -398,15 +398,17 @@ QString hashByString(const QString &str)
     return QCryptographicHash::hash(str.toUtf8(), QCryptographicHash::Md5).toHex();
 }
 
+static const qint64 s_hashDataSize = 1 * 1024 * 1024;  // 参与计算哈希的文件头部数据量
+
 QString hashByData(const QString &str)
 {
     qDebug() << "Generating hash for file:" << str;
     QFile file(str);
     QString  stHashValue;
-    if (file.open(QIODevice::ReadOnly)) { //只读方式打开
+    if (file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) { //只读方式打开，仅读取头部数据，无需缓冲
         QCryptographicHash hash(QCryptographicHash::Md5);
 
-        QByteArray buf = file.read(1 * 1024 * 1024); // 每次读取10M
+        QByteArray buf = file.read(s_hashDataSize); // 读取文件头部 1M
         buf = buf.append(str.toUtf8());
         hash.addData(buf);  // 将数据添加到Hash中
         stHashValue.append(hash.result().toHex());
@@ -417,6 +419,88 @@ QString hashByData(const QString &str)
     return stHashValue;
 }
 
+QString hashByData(const QString &str, const QByteArray &fileData)
+{
+    // 与读取文件的计算方式一致：文件头部 1M 数据 + 文件路径，映射数据仅访问头部页面
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArrayView(fileData.constData(), qMin(qint64(fileData.size()), s_hashDataSize)));
+    hash.addData(str.toUtf8());
+    return hash.result().toHex();
+}
+
+static const qint64 s_contentBlockSize = 64 * 1024;  // 内容标识使用的首尾数据块大小
+static const qint64 s_compareBlockSize = 1024 * 1024; // 比较文件内容时每次读取的数据量
+
+/**
+   @brief 以 FNV-1a 算法累加计算 \a data 的 64 位哈希，结果不依赖运行环境，可持久化保存
+ */
+static quint64 fnv1a64(quint64 hash, const char *data, qint64 size)
+{
+    for (qint64 i = 0; i < size; ++i) {
+        hash ^= static_cast<uchar>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+   @return 文件大小 \a fileSize 及首尾数据块 \a head \a tail 的内容标识，不为 0
+ */
+static quint64 contentHashOf(qint64 fileSize, const char *head, qint64 headSize, const char *tail, qint64 tailSize)
+{
+    quint64 hash = 0xcbf29ce484222325ULL;
+    hash = fnv1a64(hash, reinterpret_cast<const char *>(&fileSize), sizeof(fileSize));
+    hash = fnv1a64(hash, head, headSize);
+    hash = fnv1a64(hash, tail, tailSize);
+    return hash ? hash : 1;
+}
+
+quint64 contentHash(const QByteArray &fileData)
+{
+    const qint64 size = fileData.size();
+    const qint64 headSize = qMin(size, s_contentBlockSize);
+    // 小文件的首尾数据块重叠时，尾部仅取剩余部分
+    const qint64 tailSize = qMin(size - headSize, s_contentBlockSize);
+    return contentHashOf(size, fileData.constData(), headSize, fileData.constData() + size - tailSize, tailSize);
+}
+
+quint64 contentHash(const QString &filePath)
+{
+    // 仅读取首尾数据块，不映射整个文件(视频等大文件同样只读取 128KB)
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning() << "Failed to open file for content hash:" << filePath;
+        return 0;
+    }
+    const qint64 size = file.size();
+    const QByteArray head = file.read(qMin(size, s_contentBlockSize));
+    // 小文件的首尾数据块重叠时，尾部仅取剩余部分
+    const qint64 tailSize = qMin(size - head.size(), s_contentBlockSize);
+    QByteArray tail;
+    if (tailSize > 0 && file.seek(size - tailSize)) {
+        tail = file.read(tailSize);
+    }
+    return contentHashOf(size, head.constData(), head.size(), tail.constData(), tail.size());
+}
+
+bool sameFileContent(const QString &filePath1, const QString &filePath2)
+{
+    QFile file1(filePath1);
+    QFile file2(filePath2);
+    if (!file1.open(QIODevice::ReadOnly) || !file2.open(QIODevice::ReadOnly) || file1.size() != file2.size()) {
+        return false;
+    }
+
+    while (!file1.atEnd()) {
+        const QByteArray block1 = file1.read(s_compareBlockSize);
+        const QByteArray block2 = file2.read(s_compareBlockSize);
+        if (block1.isEmpty() || block1 != block2) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool onMountDevice(const QString &path)
 {
     bool result = (path.startsWith("/media/") || path.startsWith("/run/media/"));
@@ -544,7 +628,7 @@ bool checkMimeUrls(const QList<QUrl> &urls)
         QFileInfo fileinfo(path);
         if (fileinfo.isDir()) {
             qDebug() << "Checking directory:" << path;
-            auto finfos = getImagesAndVideoInfo(path, false);
+            auto finfos = getImagesAndVideoInfo(path, true);
             for (auto finfo : finfos) {
                 if (imageSupportRead(finfo.absoluteFilePath()) || isVideo(finfo.absoluteFilePath())) {
                     qDebug() << "Found supported file in directory:" << finfo.absoluteFilePath();
@@ -216,6 +216,14 @@ bool        checkMimeUrls(const QList<QUrl> &urls);
 QString     hash(const QString &str);
 QString     hashByString(const QString &str);
 QString     hashByData(const QString &str);
+//使用已映射的文件数据 fileData 计算哈希，结果与 hashByData(str) 一致
+QString     hashByData(const QString &str, const QByteArray &fileData);
+//文件内容标识：首尾数据块的 64 位哈希，与文件大小共同用于查找内容相同的文件，返回 0 表示读取失败
+quint64     contentHash(const QString &filePath);
+//使用已映射的文件数据 fileData 计算内容标识，结果与 contentHash(filePath) 一致
+quint64     contentHash(const QByteArray &fileData);
+//逐字节比较两个文件内容是否相同，用于内容标识相同时的确认
+bool        sameFileContent(const QString &filePath1, const QString &filePath2);
 QString     mkMutiDir(const QString &path);
 //根据源文件路径生产缩略图路径
 QString     filePathToThumbnailPath(const QString &filePath, QString dataHash = "");
@@ -0,0 +1,438 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dirwalker.h"
+#include "unionimage.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace LibUnionImage_NameSpace {
+
+static const int s_walkMaxThreads = 8;                  // 并行遍历的最大线程数
+static const size_t s_direntBufferSize = 64 * 1024;     // 单次读取目录项的缓冲区大小
+static const int s_walkBatchSize = 256;                 // 按批遍历时每批的最少文件数
+static const qint64 s_racyInterval = 2000000000LL;      // 修改时间距当前不足该时长(ns)的目录不可信
+
+// getdents64 返回的目录项结构，glibc 未导出
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/**
+   @brief 返回快照中记录的目录修改时间(ns)。文件系统时间戳精度有限，刚修改过的目录在同一时间戳内
+    可能再次变化而修改时间不变，这类目录记录为 0 ，下次必然重新读取
+ */
+static qint64 snapshotTime(const struct stat &st)
+{
+    const qint64 modifyTime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    struct timespec now;
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    const qint64 current = static_cast<qint64>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+    return current - modifyTime < s_racyInterval ? 0 : modifyTime;
+}
+
+/**
+   @class DirWalk
+   @brief 一次并行遍历的共享状态。每个线程优先遍历自己的待遍历目录栈，
+    存在空闲线程时将栈底(层级较浅、子树通常较大)的一半目录分给共享队列，
+    空闲线程从共享队列中获取目录；所有线程空闲且队列为空时遍历结束。
+    设置 handler 时，各线程发现的文件每满一批即交给 handler ，handler 返回 false 时所有线程停止遍历。
+    设置 previous 时，修改时间与快照一致的目录不再读取目录项；设置 current 时记录每个目录的快照
+ */
+class DirWalk
+{
+public:
+    DirWalk(const WalkFilter &filter, const WalkBatchHandler &handler, bool recursive,
+            const DirSnapshot *previous = nullptr, DirSnapshot *current = nullptr)
+        : filter(filter)
+        , handler(handler)
+        , recursive(recursive)
+        , previous(previous)
+        , current(current)
+    {
+    }
+
+    bool isCancelled() const
+    {
+        return cancelled.loadRelaxed();
+    }
+
+    void start(const QByteArray &root)
+    {
+        rootLength = root.size();
+        queue.enqueue(root);
+    }
+
+    void run()
+    {
+        std::vector<char> buffer(s_direntBufferSize);
+        QStringList files;
+        QList<QByteArray> local;
+        QByteArray dir;
+        while (take(dir)) {
+            local << dir;
+            while (!local.isEmpty() && !isCancelled()) {
+                scan(local.takeLast(), buffer, local, files);
+                if (handler && files.size() >= s_walkBatchSize) {
+                    deliver(files);
+                }
+                if (local.size() > 1 && idle.loadRelaxed() > 0) {
+                    share(local);
+                }
+            }
+            local.clear();
+            done();
+        }
+
+        if (handler) {
+            deliver(files);
+            return;
+        }
+        QMutexLocker locker(&mutex);
+        result << files;
+    }
+
+    QStringList takeResult()
+    {
+        QMutexLocker locker(&mutex);
+        return std::move(result);
+    }
+
+private:
+    bool take(QByteArray &dir)
+    {
+        QMutexLocker locker(&mutex);
+        while (queue.isEmpty() && active > 0 && !isCancelled()) {
+            idle.ref();
+            wake.wait(&mutex);
+            idle.deref();
+        }
+        if (queue.isEmpty() || isCancelled()) {
+            return false;
+        }
+        dir = queue.dequeue();
+        active++;
+        return true;
+    }
+
+    void share(QList<QByteArray> &local)
+    {
+        const int count = local.size() / 2;
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < count; ++i) {
+            queue.enqueue(local.takeFirst());
+        }
+        wake.wakeAll();
+    }
+
+    void deliver(QStringList &files)
+    {
+        if (files.isEmpty() || isCancelled()) {
+            files.clear();
+            return;
+        }
+
+        QMutexLocker locker(&handlerMutex);
+        if (!isCancelled() && !handler(files)) {
+            cancelled.storeRelaxed(1);
+            QMutexLocker queueLocker(&mutex);
+            wake.wakeAll();
+        }
+        files.clear();
+    }
+
+    void done()
+    {
+        QMutexLocker locker(&mutex);
+        active--;
+        if (0 == active && queue.isEmpty()) {
+            wake.wakeAll();
+        }
+    }
+
+    /**
+       @brief 读取目录 \a dir 的全部目录项，子目录加入 \a subDirs ，通过筛选的文件加入 \a files
+     */
+    void scan(const QByteArray &dir, std::vector<char> &buffer, QList<QByteArray> &subDirs, QStringList &files)
+    {
+        // 根目录为 / 时路径为空
+        const int fd = ::open(dir.isEmpty() ? "/" : dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            qWarning() << "Failed to open directory:" << QFile::decodeName(dir);
+            return;
+        }
+
+        // 目录修改时间与快照一致时直接使用快照
+        const QString key = (previous || current) ? QFile::decodeName(dir.mid(rootLength)) : QString();
+        DirSnapshotEntry snapshot;
+        struct stat dirStat;
+        if ((previous || current) && 0 == ::fstat(fd, &dirStat)) {
+            snapshot.modifyTime = snapshotTime(dirStat);
+            auto itr = previous ? previous->constFind(key) : DirSnapshot::const_iterator();
+            if (previous && 0 != snapshot.modifyTime && itr != previous->constEnd() && itr->modifyTime == snapshot.modifyTime) {
+                ::close(fd);
+                const QString dirPath = QFile::decodeName(dir);
+                for (const QString &name : itr->files) {
+                    files << dirPath + '/' + name;
+                }
+                if (recursive) {
+                    for (const QString &name : itr->subDirs) {
+                        subDirs << dir + '/' + QFile::encodeName(name);
+                    }
+                }
+                record(key, itr.value());
+                return;
+            }
+        }
+
+        for (;;) {
+            const long bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (bytes <= 0) {
+                if (bytes < 0) {
+                    qWarning() << "Failed to read directory:" << QFile::decodeName(dir);
+                }
+                break;
+            }
+
+            for (long offset = 0; offset < bytes;) {
+                auto entry = reinterpret_cast<const LinuxDirent64 *>(buffer.data() + offset);
+                offset += entry->d_reclen;
+
+                // 跳过 . 、 .. 及隐藏文件，与 QDir 默认行为一致
+                const char *name = entry->d_name;
+                if ('.' == name[0]) {
+                    continue;
+                }
+
+                unsigned char type = entry->d_type;
+                if (DT_UNKNOWN == type || DT_LNK == type) {
+                    type = statType(fd, name, type);
+                }
+
+                if (DT_DIR == type) {
+                    if (recursive) {
+                        subDirs << dir + '/' + name;
+                    }
+                    if (current) {
+                        snapshot.subDirs << QFile::decodeName(name);
+                    }
+                } else if (DT_REG == type) {
+                    const QString fileName = QFile::decodeName(name);
+                    if (!filter || filter(fileName)) {
+                        files << QFile::decodeName(dir + '/' + name);
+                        if (current) {
+                            snapshot.files << fileName;
+                        }
+                    }
+                }
+            }
+        }
+
+        ::close(fd);
+        record(key, snapshot);
+    }
+
+    void record(const QString &key, const DirSnapshotEntry &entry)
+    {
+        if (current) {
+            QMutexLocker locker(&snapshotMutex);
+            current->insert(key, entry);
+        }
+    }
+
+    /**
+       @return 通过文件状态获取的目录项类型，链接至目录的符号链接返回 DT_LNK ，避免循环遍历
+     */
+    static unsigned char statType(int dirFd, const char *name, unsigned char type)
+    {
+        struct stat st;
+        if (DT_UNKNOWN == type) {
+            if (0 != fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW)) {
+                return DT_UNKNOWN;
+            }
+            if (S_ISDIR(st.st_mode)) {
+                return DT_DIR;
+            }
+            if (S_ISREG(st.st_mode)) {
+                return DT_REG;
+            }
+            if (!S_ISLNK(st.st_mode)) {
+                return DT_UNKNOWN;
+            }
+        }
+
+        if (0 != fstatat(dirFd, name, &st, 0)) {
+            return DT_UNKNOWN;
+        }
+        return S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+    }
+
+    const WalkFilter filter;
+    const WalkBatchHandler handler;
+    const bool recursive;
+    const DirSnapshot *previous;
+    DirSnapshot *current;
+    int rootLength = 0;
+    QMutex snapshotMutex;
+    QMutex handlerMutex;
+    QAtomicInt cancelled;
+
+    QMutex mutex;
+    QWaitCondition wake;
+    QQueue<QByteArray> queue;
+    QStringList result;
+    int active = 0;             ///< 正在遍历的线程数
+    QAtomicInt idle;            ///< 等待获取目录的线程数
+};
+
+/**
+   @brief 在独立的线程池中执行 \a walk ，调用方本身位于全局线程池时不会互相等待，当前线程同样参与遍历
+ */
+static void runWalk(DirWalk &walk, const QString &dir, bool recursive)
+{
+    QByteArray root = QFile::encodeName(QDir(dir).absolutePath());
+    if (root.endsWith('/')) {
+        root.chop(1);
+    }
+    walk.start(root);
+
+    const int threads = recursive ? qBound(1, QThread::idealThreadCount(), s_walkMaxThreads) : 1;
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 1; i < threads; ++i) {
+        pool.start([&walk]() { walk.run(); });
+    }
+    walk.run();
+    pool.waitForDone();
+}
+
+QStringList walkFiles(const QString &dir, const WalkFilter &filter, bool recursive)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    DirWalk walk(filter, WalkBatchHandler(), recursive);
+    runWalk(walk, dir, recursive);
+
+    QStringList files = walk.takeResult();
+    qDebug() << "Walked" << files.size() << "files in" << dir << "elapsed(ms):" << timer.elapsed();
+    return files;
+}
+
+bool walkFilesBatched(const QString &dir, const WalkFilter &filter, const WalkBatchHandler &handler, bool recursive,
+                      const DirSnapshot *previous, DirSnapshot *current)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    DirWalk walk(filter, handler, recursive, previous, current);
+    runWalk(walk, dir, recursive);
+
+    qDebug() << "Walked" << dir << (walk.isCancelled() ? "(cancelled)" : "") << "elapsed(ms):" << timer.elapsed();
+    return !walk.isCancelled();
+}
+
+bool isMediaFileName(const QString &fileName)
+{
+    static const QSet<QString> suffixes = []() {
+        QSet<QString> set;
+        for (const QString &format : unionImageSupportFormat()) {
+            set.insert(format.toLower());
+        }
+        // 与 imageSupportRead 一致，排除无法正确读取的格式
+        set.remove("x3f");
+        for (const QString &format : videoFiletypes()) {
+            set.insert(format.toLower());
+        }
+        return set;
+    }();
+
+    const int index = fileName.lastIndexOf('.');
+    if (index <= 0) {
+        return false;
+    }
+    return suffixes.contains(fileName.mid(index + 1).toLower());
+}
+
+QStringList walkMediaFiles(const QString &dir, bool recursive)
+{
+    return walkFiles(dir, isMediaFileName, recursive);
+}
+
+bool walkMediaFilesBatched(const QString &dir, const WalkBatchHandler &handler, bool recursive,
+                           const DirSnapshot *previous, DirSnapshot *current)
+{
+    return walkFilesBatched(dir, isMediaFileName, handler, recursive, previous, current);
+}
+
+qint64 dirModifyTime(const QString &dir)
+{
+    struct stat st;
+    if (0 != ::stat(QFile::encodeName(dir).constData(), &st) || !S_ISDIR(st.st_mode)) {
+        return -1;
+    }
+    return snapshotTime(st);
+}
+
+bool diffDirSnapshot(const QString &root, const DirSnapshot &previous, const DirSnapshot &current,
+                     QSet<QString> &changedDirs, QSet<QString> &currentDirs)
+{
+    const QString rootPath = QDir(root).absolutePath();
+    QString base = rootPath;
+    if (base.endsWith('/')) {
+        base.chop(1);
+    }
+
+    //修改时间为 0 的目录刚修改过，同样视为变化
+    for (auto itr = current.constBegin(); itr != current.constEnd(); ++itr) {
+        const QString dir = itr.key().isEmpty() ? rootPath : base + itr.key();
+        currentDirs.insert(dir);
+        auto prev = previous.constFind(itr.key());
+        if (0 == itr->modifyTime || prev == previous.constEnd() || prev->modifyTime != itr->modifyTime) {
+            changedDirs.insert(dir);
+        }
+    }
+
+    bool removed = false;
+    for (auto itr = previous.constBegin(); itr != previous.constEnd() && !removed; ++itr) {
+        removed = !current.contains(itr.key());
+    }
+    return !changedDirs.isEmpty() || removed;
+}
+
+QDataStream &operator<<(QDataStream &stream, const DirSnapshotEntry &entry)
+{
+    return stream << entry.modifyTime << entry.files << entry.subDirs;
+}
+
+QDataStream &operator>>(QDataStream &stream, DirSnapshotEntry &entry)
+{
+    return stream >> entry.modifyTime >> entry.files >> entry.subDirs;
+}
+
+}  // namespace LibUnionImage_NameSpace
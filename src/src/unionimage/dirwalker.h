@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRWALKER_H
+#define DIRWALKER_H
+
+#include <QDataStream>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+#include "unionimage_global.h"
+
+namespace LibUnionImage_NameSpace {
+
+/**
+ * @brief 按文件名筛选文件，返回 true 表示保留，筛选时不访问文件内容
+ */
+typedef std::function<bool(const QString &fileName)> WalkFilter;
+
+/**
+ * @brief 接收遍历过程中发现的一批文件，返回 false 时取消遍历。调用是串行的，但可能位于任一遍历线程
+ */
+typedef std::function<bool(const QStringList &files)> WalkBatchHandler;
+
+/**
+ * @brief 目录快照中的一个目录，记录目录修改时间及其中通过筛选的文件名和子目录名。
+ *  目录修改时间未变时其中的目录项未增删，可直接使用快照而无需重新读取
+ */
+struct DirSnapshotEntry {
+    qint64 modifyTime = 0;  // 目录修改时间(ns)，为 0 时下次遍历必然重新读取
+    QStringList files;
+    QStringList subDirs;
+};
+/**
+ * @brief 目录快照，键为目录相对遍历根目录的路径，根目录为空字符串，与挂载点无关
+ */
+typedef QHash<QString, DirSnapshotEntry> DirSnapshot;
+
+UNIONIMAGESHARED_EXPORT QDataStream &operator<<(QDataStream &stream, const DirSnapshotEntry &entry);
+UNIONIMAGESHARED_EXPORT QDataStream &operator>>(QDataStream &stream, DirSnapshotEntry &entry);
+
+/**
+ * @brief walkFiles 并行遍历目录 \a dir 下的文件(不含隐藏文件)，直接读取目录项类型，
+ *  仅在文件系统未提供类型或为符号链接时获取文件状态，不进入链接至目录的符号链接
+ * @param dir 遍历的根目录
+ * @param filter 文件名筛选，为空时保留全部文件
+ * @param recursive 是否遍历子目录
+ * @return 文件的绝对路径，顺序不固定
+ */
+UNIONIMAGESHARED_EXPORT QStringList walkFiles(const QString &dir, const WalkFilter &filter = WalkFilter(), bool recursive = true);
+
+/**
+ * @brief walkMediaFiles 遍历目录 \a dir 下扩展名为支持的图片或视频格式的文件，不读取文件内容
+ */
+UNIONIMAGESHARED_EXPORT QStringList walkMediaFiles(const QString &dir, bool recursive = true);
+
+/**
+ * @brief walkFilesBatched 同 walkFiles ，遍历过程中每发现一批文件即交给 \a handler ，遍历结束后返回
+ * @param previous 上次遍历的快照，修改时间未变的目录直接使用快照中的文件和子目录，为空时全部读取
+ * @param current 不为空时记录本次遍历的快照，仅在遍历完成时完整
+ * @return 遍历是否完成，被 \a handler 取消时返回 false
+ */
+UNIONIMAGESHARED_EXPORT bool walkFilesBatched(const QString &dir, const WalkFilter &filter, const WalkBatchHandler &handler, bool recursive = true,
+                                              const DirSnapshot *previous = nullptr, DirSnapshot *current = nullptr);
+
+/**
+ * @brief walkMediaFilesBatched 按批遍历目录 \a dir 下扩展名为支持的图片或视频格式的文件
+ */
+UNIONIMAGESHARED_EXPORT bool walkMediaFilesBatched(const QString &dir, const WalkBatchHandler &handler, bool recursive = true,
+                                                   const DirSnapshot *previous = nullptr, DirSnapshot *current = nullptr);
+
+/**
+ * @brief dirModifyTime 获取目录 \a dir 用于快照比较的修改时间(ns)
+ * @return 目录不存在时返回 -1 ，刚修改过(修改时间可能在同一时间戳内再次变化)时返回 0 ，不应视为未变化
+ */
+UNIONIMAGESHARED_EXPORT qint64 dirModifyTime(const QString &dir);
+
+/**
+ * @brief diffDirSnapshot 比较目录 \a root 上次遍历的快照 \a previous 与本次遍历的快照 \a current
+ * @param changedDirs 返回本次重新读取的目录的绝对路径，其中的文件需与已有记录比较
+ * @param currentDirs 返回本次遍历到的全部目录的绝对路径，记录所在的目录不在其中时已被删除
+ * @return 是否有目录被重新读取或被删除，否则已有记录无需比较
+ */
+UNIONIMAGESHARED_EXPORT bool diffDirSnapshot(const QString &root, const DirSnapshot &previous, const DirSnapshot &current,
+                                             QSet<QString> &changedDirs, QSet<QString> &currentDirs);
+
+/**
+ * @return 文件名 \a fileName 的扩展名是否为支持的图片或视频格式
+ */
+UNIONIMAGESHARED_EXPORT bool isMediaFileName(const QString &fileName);
+
+}  // namespace LibUnionImage_NameSpace
+
+#endif  // DIRWALKER_H
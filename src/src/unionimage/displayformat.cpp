@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "unionimage.h"
+
+// 显示格式转换不依赖解码库，单独编译以便图像加载器等模块直接链接
+
+namespace LibUnionImage_NameSpace {
+
+UNIONIMAGESHARED_EXPORT QImage toDisplayFormat(const QImage &image)
+{
+    if (image.isNull() || QImage::Format_ARGB32_Premultiplied == image.format()) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+}  // namespace LibUnionImage_NameSpace
@@ -0,0 +1,493 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "exifparser.h"
+
+#include <QFile>
+#include <QDebug>
+
+#include <cstring>
+#include <functional>
+
+namespace LibUnionImage_NameSpace {
+
+static const int s_tiffHeaderSize = 256 * 1024;  // TIFF 结构文件读取的头部数据大小
+static const int s_maxJpegSegments = 64;         // JPEG 文件查找 APP1 时最多跳过的数据段数量
+static const char s_exifHeader[] = "Exif\0\0";   // APP1 数据段 EXIF 标识
+
+// EXIF 字段
+enum ExifTag : quint16 {
+    TagImageWidth = 0x0100,
+    TagImageLength = 0x0101,
+    TagMake = 0x010F,
+    TagModel = 0x0110,
+    TagOrientation = 0x0112,
+    TagExifIfdPointer = 0x8769,
+    TagDateTimeOriginal = 0x9003,
+    TagDateTimeDigitized = 0x9004,
+    TagPixelXDimension = 0xA002,
+    TagPixelYDimension = 0xA003,
+};
+
+/**
+   @return 返回 EXIF 数据类型 \a type 单个数据的字节数，不支持的类型返回 0
+ */
+static int exifTypeSize(quint16 type)
+{
+    switch (type) {
+        case 1:  // BYTE
+        case 2:  // ASCII
+        case 6:  // SBYTE
+        case 7:  // UNDEFINED
+            return 1;
+        case 3:  // SHORT
+        case 8:  // SSHORT
+            return 2;
+        case 4:  // LONG
+        case 9:  // SLONG
+            return 4;
+        case 5:   // RATIONAL
+        case 10:  // SRATIONAL
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/**
+   @return 返回 EXIF 中记录的时间 \a text ，格式为 "yyyy:MM:dd HH:mm:ss" ，未记录时返回无效时间
+ */
+static QDateTime exifDateTime(const QString &text)
+{
+    QDateTime dateTime = QDateTime::fromString(text, "yyyy:MM:dd HH:mm:ss");
+    if (!dateTime.isValid()) {
+        // 部分设备不记录秒
+        dateTime = QDateTime::fromString(text, "yyyy:MM:dd HH:mm");
+    }
+    return dateTime;
+}
+
+/**
+   @return 返回 EXIF 方向 \a orientation 顺时针旋转 \a angle 度后的方向值
+    方向值分解为 "水平镜像 + 顺时针旋转" 两部分，旋转操作仅叠加旋转角度
+ */
+static int rotateExifOrientation(int orientation, int angle)
+{
+    // 方向值 1~8 对应的 镜像 / 顺时针旋转角度
+    static const int s_mirror[] = { 0, 1, 0, 1, 1, 0, 1, 0 };
+    static const int s_rotation[] = { 0, 0, 180, 180, 270, 90, 90, 270 };
+
+    if (orientation < 1 || orientation > 8) {
+        orientation = 1;
+    }
+    int mirror = s_mirror[orientation - 1];
+    int rotation = ((s_rotation[orientation - 1] + angle) % 360 + 360) % 360;
+
+    for (int i = 0; i < 8; ++i) {
+        if (s_mirror[i] == mirror && s_rotation[i] == rotation) {
+            return i + 1;
+        }
+    }
+    return 1;
+}
+
+/**
+   @class ExifParser
+   @brief 轻量的 EXIF 头解析器，仅读取文件头部的元数据，不解码图像数据，用于导入时快速获取
+    拍摄时间、方向、相机型号等信息。解析过程中对所有偏移进行边界检查，损坏的数据将被忽略
+ */
+
+/**
+   @return 读取图片文件 \a path 的 EXIF 信息，JPEG 文件仅读取首个 Exif APP1 数据段
+ */
+ExifInfo ExifParser::parseFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open file for EXIF parsing:" << path << file.errorString();
+        return ExifInfo();
+    }
+
+    return parseDevice(&file);
+}
+
+/**
+   @return 从已打开的随机访问设备 \a device 中读取 EXIF 信息，读取完成后恢复设备的读取位置，
+    用于和解码器共享同一文件句柄
+ */
+ExifInfo ExifParser::parseDevice(QIODevice *device)
+{
+    ExifInfo info;
+    if (!device || !device->isOpen() || device->isSequential()) {
+        return info;
+    }
+
+    const qint64 originPos = device->pos();
+    info = parseRandomAccessDevice(device);
+    device->seek(originPos);
+    return info;
+}
+
+/**
+   @return 从设备 \a device 起始位置读取 EXIF 信息
+ */
+ExifInfo ExifParser::parseRandomAccessDevice(QIODevice *device)
+{
+    ExifInfo info;
+    QIODevice &file = *device;
+    if (!file.seek(0)) {
+        return info;
+    }
+
+    QByteArray head = file.read(4);
+    if (head.size() < 4) {
+        return info;
+    }
+
+    // TIFF 结构文件，EXIF 信息位于文件头部
+    if (head.startsWith(QByteArray("II*\0", 4)) || head.startsWith(QByteArray("MM\0*", 4))) {
+        QByteArray data = head + file.read(s_tiffHeaderSize);
+        parseTiff(data, 0, data.size(), info);
+        return info;
+    }
+
+    if (uchar(head[0]) != 0xFF || uchar(head[1]) != 0xD8) {
+        return info;
+    }
+
+    // 逐个跳过 JPEG 数据段，仅读取 APP1 数据段内容
+    qint64 pos = 2;
+    for (int i = 0; i < s_maxJpegSegments; ++i) {
+        if (!file.seek(pos)) {
+            break;
+        }
+        QByteArray marker = file.read(4);
+        if (marker.size() < 4 || uchar(marker[0]) != 0xFF) {
+            break;
+        }
+
+        uchar type = uchar(marker[1]);
+        if (0xFF == type) {
+            // 填充字节
+            pos++;
+            continue;
+        }
+        if (0xDA == type || 0xD9 == type) {
+            // 图像数据开始(SOS)或结束(EOI)，其后不再有元数据段
+            break;
+        }
+
+        int segmentLength = readUInt16(marker, 2, true);
+        if (segmentLength < 2) {
+            break;
+        }
+
+        if (0xE1 == type) {
+            QByteArray segment = file.read(segmentLength - 2);
+            if (segment.size() > 6 && 0 == std::memcmp(segment.constData(), s_exifHeader, 6)) {
+                parseTiff(segment, 6, segment.size() - 6, info);
+                return info;
+            }
+        }
+
+        pos += 2 + segmentLength;
+    }
+
+    return info;
+}
+
+/**
+   @return 从文件数据 \a data 中解析 EXIF 信息， \a data 可为 JPEG 文件数据或 TIFF 结构文件的头部数据
+ */
+ExifInfo ExifParser::parse(const QByteArray &data)
+{
+    ExifInfo info;
+    if (data.startsWith(QByteArray("II*\0", 4)) || data.startsWith(QByteArray("MM\0*", 4))) {
+        parseTiff(data, 0, data.size(), info);
+        return info;
+    }
+
+    int tiffOffset = 0;
+    int tiffLength = 0;
+    int insertOffset = 0;
+    if (findJpegExifSegment(data, tiffOffset, tiffLength, insertOffset)) {
+        parseTiff(data, tiffOffset, tiffLength, info);
+    }
+    return info;
+}
+
+/**
+   @brief 在 JPEG 文件数据 \a data 中查找首个 Exif APP1 数据段
+   @param[out] tiffOffset   EXIF 数据中 TIFF 头的偏移
+   @param[out] tiffLength   TIFF 数据长度
+   @param[out] insertOffset 可插入 EXIF 数据段的位置(JFIF APP0 之后)，在不存在 EXIF 数据段时使用
+   @return 是否找到 EXIF 数据段
+ */
+bool ExifParser::findJpegExifSegment(const QByteArray &data, int &tiffOffset, int &tiffLength, int &insertOffset)
+{
+    insertOffset = 2;
+    if (data.size() < 4 || uchar(data[0]) != 0xFF || uchar(data[1]) != 0xD8) {
+        return false;
+    }
+
+    int pos = 2;
+    while (pos + 4 <= data.size()) {
+        if (uchar(data[pos]) != 0xFF) {
+            return false;
+        }
+        uchar type = uchar(data[pos + 1]);
+        if (0xFF == type) {
+            pos++;
+            continue;
+        }
+        if (0xDA == type || 0xD9 == type) {
+            return false;
+        }
+
+        int segmentLength = readUInt16(data, pos + 2, true);
+        int segmentEnd = pos + 2 + segmentLength;
+        if (segmentLength < 2 || segmentEnd > data.size()) {
+            return false;
+        }
+
+        if (0xE0 == type) {
+            insertOffset = segmentEnd;
+        } else if (0xE1 == type && segmentLength > 8 && 0 == std::memcmp(data.constData() + pos + 4, s_exifHeader, 6)) {
+            tiffOffset = pos + 10;
+            tiffLength = segmentEnd - tiffOffset;
+            return true;
+        }
+
+        pos = segmentEnd;
+    }
+
+    return false;
+}
+
+/**
+   @brief 在 \a data 中偏移 \a tiffOffset 长度 \a tiffLength 的 TIFF 数据的 IFD0 中查找字段 \a tag
+   @param[out] bigEndian TIFF 数据的字节序
+   @return 字段项(12 字节)的偏移，未找到返回 -1
+ */
+int ExifParser::findIfd0Entry(const QByteArray &data, int tiffOffset, int tiffLength, quint16 tag, bool &bigEndian)
+{
+    const qint64 end = qMin<qint64>(data.size(), qint64(tiffOffset) + tiffLength);
+    if (tiffOffset < 0 || tiffOffset + 8 > end) {
+        return -1;
+    }
+
+    if (0 == std::memcmp(data.constData() + tiffOffset, "MM", 2)) {
+        bigEndian = true;
+    } else if (0 == std::memcmp(data.constData() + tiffOffset, "II", 2)) {
+        bigEndian = false;
+    } else {
+        return -1;
+    }
+
+    const qint64 ifdOffset = tiffOffset + qint64(readUInt32(data, tiffOffset + 4, bigEndian));
+    if (ifdOffset < tiffOffset + 8 || ifdOffset + 2 > end) {
+        return -1;
+    }
+
+    const int entryCount = readUInt16(data, int(ifdOffset), bigEndian);
+    for (int i = 0; i < entryCount; ++i) {
+        const qint64 entry = ifdOffset + 2 + qint64(i) * 12;
+        if (entry + 12 > end) {
+            return -1;
+        }
+        if (tag == readUInt16(data, int(entry), bigEndian)) {
+            return int(entry);
+        }
+    }
+
+    return -1;
+}
+
+/**
+   @brief 改写 JPEG 文件数据 \a data 中 IFD0 的方向字段，使图像顺时针旋转 \a angle 度，不修改图像数据。
+    不含 EXIF 数据段时插入仅包含方向字段的 EXIF 数据段
+   @return 是否改写成功，EXIF 数据段中不包含方向字段(或非 JPEG 数据)时返回 false
+ */
+bool ExifParser::rotateJpegOrientation(QByteArray &data, int angle)
+{
+    int tiffOffset = 0;
+    int tiffLength = 0;
+    int insertOffset = 2;
+    if (findJpegExifSegment(data, tiffOffset, tiffLength, insertOffset)) {
+        // Orientation 字段 0x0112 ，类型为 SHORT(3) ，数量为 1
+        bool bigEndian = true;
+        int entry = findIfd0Entry(data, tiffOffset, tiffLength, TagOrientation, bigEndian);
+        if (-1 == entry || 3 != readUInt16(data, entry + 2, bigEndian) || 1 != readUInt32(data, entry + 4, bigEndian)) {
+            return false;
+        }
+
+        int orientation = rotateExifOrientation(readUInt16(data, entry + 8, bigEndian), angle);
+        data[entry + 8] = char(bigEndian ? 0 : orientation);
+        data[entry + 9] = char(bigEndian ? orientation : 0);
+        return true;
+    }
+
+    if (data.size() < 4 || uchar(data[0]) != 0xFF || uchar(data[1]) != 0xD8) {
+        return false;
+    }
+
+    // 构造仅包含 IFD0 方向字段的 EXIF 数据段(大端字节序)
+    static const char s_exifSegment[] = { '\xFF', '\xE1', 0x00, 0x22, 'E', 'x', 'i', 'f', 0x00, 0x00,
+                                          'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08,
+                                          0x00, 0x01,
+                                          0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+                                          0x00, 0x00, 0x00, 0x00 };
+    QByteArray segment(s_exifSegment, sizeof(s_exifSegment));
+    segment[29] = char(rotateExifOrientation(1, angle));
+    data.insert(insertOffset, segment);
+    return true;
+}
+
+/**
+   @return 以字节序 \a bigEndian 读取 \a data 中偏移 \a offset 处的 16 位无符号整数，调用方保证偏移有效
+ */
+quint16 ExifParser::readUInt16(const QByteArray &data, int offset, bool bigEndian)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData()) + offset;
+    return bigEndian ? quint16((p[0] << 8) | p[1]) : quint16((p[1] << 8) | p[0]);
+}
+
+/**
+   @return 以字节序 \a bigEndian 读取 \a data 中偏移 \a offset 处的 32 位无符号整数，调用方保证偏移有效
+ */
+quint32 ExifParser::readUInt32(const QByteArray &data, int offset, bool bigEndian)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData()) + offset;
+    return bigEndian ? (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3]
+                     : (quint32(p[3]) << 24) | (quint32(p[2]) << 16) | (quint32(p[1]) << 8) | p[0];
+}
+
+/**
+   @brief 解析 \a data 中偏移 \a tiffOffset 长度 \a tiffLength 的 TIFF 数据，读取 IFD0 及 Exif IFD 中的字段至 \a info
+ */
+void ExifParser::parseTiff(const QByteArray &data, int tiffOffset, int tiffLength, ExifInfo &info)
+{
+    const qint64 end = qMin<qint64>(data.size(), qint64(tiffOffset) + tiffLength);
+    if (tiffOffset < 0 || tiffOffset + 8 > end) {
+        return;
+    }
+
+    bool bigEndian = true;
+    if (0 == std::memcmp(data.constData() + tiffOffset, "MM", 2)) {
+        bigEndian = true;
+    } else if (0 == std::memcmp(data.constData() + tiffOffset, "II", 2)) {
+        bigEndian = false;
+    } else {
+        return;
+    }
+    if (42 != readUInt16(data, tiffOffset + 2, bigEndian)) {
+        return;
+    }
+
+    // 读取字段的整数值，类型为 SHORT 或 LONG
+    auto readInteger = [&](quint16 type, qint64 valueOffset) -> quint32 {
+        return (3 == type) ? readUInt16(data, int(valueOffset), bigEndian) : readUInt32(data, int(valueOffset), bigEndian);
+    };
+    // 读取字段的字符串值，移除尾部的 '\0' 及空白字符
+    auto readString = [&](quint32 count, qint64 valueOffset) -> QString {
+        QByteArray text(data.constData() + valueOffset, int(count));
+        int nullIndex = text.indexOf('\0');
+        if (-1 != nullIndex) {
+            text.truncate(nullIndex);
+        }
+        return QString::fromUtf8(text).trimmed();
+    };
+
+    // 遍历 IFD 中的字段，返回字段值有效的字段，偏移越界的字段将被忽略
+    auto readIfd = [&](qint64 ifdOffset, const std::function<void(quint16, quint16, quint32, qint64)> &handler) {
+        if (ifdOffset < tiffOffset + 8 || ifdOffset + 2 > end) {
+            return;
+        }
+
+        const int entryCount = readUInt16(data, int(ifdOffset), bigEndian);
+        for (int i = 0; i < entryCount; ++i) {
+            const qint64 entry = ifdOffset + 2 + qint64(i) * 12;
+            if (entry + 12 > end) {
+                return;
+            }
+
+            const quint16 tag = readUInt16(data, int(entry), bigEndian);
+            const quint16 type = readUInt16(data, int(entry + 2), bigEndian);
+            const quint32 count = readUInt32(data, int(entry + 4), bigEndian);
+            const int typeSize = exifTypeSize(type);
+            if (0 == typeSize || 0 == count || count > quint32(end)) {
+                continue;
+            }
+
+            // 数据不超过 4 字节时直接存储在字段中，否则存储偏移
+            const qint64 valueSize = qint64(typeSize) * count;
+            const qint64 valueOffset = (valueSize <= 4) ? entry + 8 : tiffOffset + qint64(readUInt32(data, int(entry + 8), bigEndian));
+            if (valueOffset < tiffOffset || valueOffset + valueSize > end) {
+                continue;
+            }
+
+            handler(tag, type, count, valueOffset);
+        }
+    };
+
+    info.valid = true;
+    qint64 exifIfdOffset = 0;
+    QSize tiffSize;
+    const qint64 ifd0Offset = tiffOffset + qint64(readUInt32(data, tiffOffset + 4, bigEndian));
+    readIfd(ifd0Offset, [&](quint16 tag, quint16 type, quint32 count, qint64 valueOffset) {
+        switch (tag) {
+            case TagMake:
+                info.make = readString(count, valueOffset);
+                break;
+            case TagModel:
+                info.model = readString(count, valueOffset);
+                break;
+            case TagOrientation: {
+                int orientation = int(readInteger(type, valueOffset));
+                info.orientation = (1 <= orientation && orientation <= 8) ? orientation : 1;
+            } break;
+            case TagImageWidth:
+                tiffSize.setWidth(int(readInteger(type, valueOffset)));
+                break;
+            case TagImageLength:
+                tiffSize.setHeight(int(readInteger(type, valueOffset)));
+                break;
+            case TagExifIfdPointer:
+                exifIfdOffset = tiffOffset + qint64(readInteger(type, valueOffset));
+                break;
+            default:
+                break;
+        }
+    });
+
+    QSize exifSize;
+    if (exifIfdOffset != ifd0Offset) {
+        readIfd(exifIfdOffset, [&](quint16 tag, quint16 type, quint32 count, qint64 valueOffset) {
+            switch (tag) {
+                case TagDateTimeOriginal:
+                    info.dateTimeOriginal = exifDateTime(readString(count, valueOffset));
+                    break;
+                case TagDateTimeDigitized:
+                    info.dateTimeDigitized = exifDateTime(readString(count, valueOffset));
+                    break;
+                case TagPixelXDimension:
+                    exifSize.setWidth(int(readInteger(type, valueOffset)));
+                    break;
+                case TagPixelYDimension:
+                    exifSize.setHeight(int(readInteger(type, valueOffset)));
+                    break;
+                default:
+                    break;
+            }
+        });
+    }
+
+    // 优先使用 Exif IFD 中记录的像素大小，TIFF 结构文件使用 IFD0 记录的图像大小
+    info.size = exifSize.isValid() && !exifSize.isEmpty() ? exifSize : tiffSize;
+    if (!info.size.isValid() || info.size.isEmpty()) {
+        info.size = QSize();
+    }
+}
+
+}  // namespace LibUnionImage_NameSpace
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EXIFPARSER_H
+#define EXIFPARSER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QDateTime>
+#include <QSize>
+#include <QString>
+
+#include "unionimage_global.h"
+
+namespace LibUnionImage_NameSpace {
+
+/**
+ * @brief EXIF 头信息，仅包含导入及展示时常用的字段
+ */
+struct ExifInfo {
+    bool valid = false;          // 是否解析到 EXIF 数据
+    int orientation = 1;         // 方向 1~8
+    QDateTime dateTimeOriginal;  // 拍摄时间
+    QDateTime dateTimeDigitized; // 数字化时间
+    QString make;                // 相机厂商
+    QString model;               // 相机型号
+    QSize size;                  // EXIF 记录的图像大小(未应用方向)
+};
+
+/**
+ * @brief 轻量的 EXIF 头解析器，不解码图像数据。
+ * JPEG 文件仅读取首个 Exif APP1 数据段，TIFF 格式(含 TIFF 结构的 RAW 格式)读取文件头部数据
+ */
+class UNIONIMAGESHARED_EXPORT ExifParser
+{
+public:
+    static ExifInfo parseFile(const QString &path);
+    static ExifInfo parseDevice(QIODevice *device);
+    static ExifInfo parse(const QByteArray &data);
+
+    static bool findJpegExifSegment(const QByteArray &data, int &tiffOffset, int &tiffLength, int &insertOffset);
+    static int findIfd0Entry(const QByteArray &data, int tiffOffset, int tiffLength, quint16 tag, bool &bigEndian);
+    // 改写 JPEG 数据的方向字段实现无损旋转
+    static bool rotateJpegOrientation(QByteArray &data, int angle);
+
+    static quint16 readUInt16(const QByteArray &data, int offset, bool bigEndian);
+    static quint32 readUInt32(const QByteArray &data, int offset, bool bigEndian);
+
+private:
+    static ExifInfo parseRandomAccessDevice(QIODevice *device);
+    static void parseTiff(const QByteArray &data, int tiffOffset, int tiffLength, ExifInfo &info);
+};
+
+}  // namespace LibUnionImage_NameSpace
+
+#endif  // EXIFPARSER_H
@@ -0,0 +1,454 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "frameindex.h"
+
+#include <QDataStream>
+#include <QImageReader>
+#include <QIODevice>
+#include <QSet>
+#include <QDebug>
+
+#include <cstring>
+
+namespace LibUnionImage_NameSpace {
+
+static const quint32 s_indexVersion = 1;    // 序列化格式版本，格式变更时递增使旧索引失效
+static const int s_maxFrames = 65536;       // 最大索引帧数，防止异常文件导致无限扫描
+
+// TIFF 字段
+enum TiffTag : quint16 {
+    TagStripByteCounts = 279,
+    TagTileByteCounts = 325,
+};
+
+/**
+   @brief 将映射数据的 TIFF 文件头替换为指向指定 IFD 的文件头，其余数据直接引用原数据，
+        使 TIFF 解码器将指定页作为首页读取，无需从首页逐页查找
+ */
+class TiffFrameDevice : public QIODevice
+{
+public:
+    TiffFrameDevice(const QByteArray &data, const QByteArray &header)
+        : fileData(data)
+        , patchedHeader(header)
+    {
+    }
+
+    bool isSequential() const override
+    {
+        return false;
+    }
+
+    qint64 size() const override
+    {
+        return fileData.size();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const qint64 current = pos();
+        const qint64 len = qMin(maxSize, qint64(fileData.size()) - current);
+        if (len <= 0) {
+            return 0;
+        }
+
+        memcpy(data, fileData.constData() + current, size_t(len));
+        if (current < patchedHeader.size()) {
+            memcpy(data, patchedHeader.constData() + current, size_t(qMin(len, qint64(patchedHeader.size()) - current)));
+        }
+        return len;
+    }
+
+    qint64 writeData(const char *, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    QByteArray fileData;
+    QByteArray patchedHeader;
+};
+
+/**
+   @return 以字节序 \a bigEndian 读取 \a data 中偏移 \a offset 处长度为 \a bytes 的无符号整数，调用方保证偏移有效
+ */
+static quint64 readUInt(const QByteArray &data, qint64 offset, int bytes, bool bigEndian)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData()) + offset;
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= quint64(p[bigEndian ? i : bytes - 1 - i]) << (8 * (bytes - 1 - i));
+    }
+    return value;
+}
+
+/**
+   @brief 以字节序 \a bigEndian 将 \a value 写入 \a data 中偏移 \a offset 处，长度为 \a bytes
+ */
+static void writeUInt(QByteArray &data, int offset, int bytes, bool bigEndian, quint64 value)
+{
+    for (int i = 0; i < bytes; ++i) {
+        const int shift = 8 * (bigEndian ? bytes - 1 - i : i);
+        data[offset + i] = char((value >> shift) & 0xFF);
+    }
+}
+
+/**
+   @brief 解析 \a data 的 TIFF 文件头，返回字节序 \a bigEndian 和是否为 BigTIFF 格式 \a bigTiff
+   @return 是否为有效的 TIFF 文件头
+ */
+static bool parseTiffHeader(const QByteArray &data, bool &bigEndian, bool &bigTiff)
+{
+    if (data.size() < 8) {
+        return false;
+    }
+
+    if (data.startsWith("II")) {
+        bigEndian = false;
+    } else if (data.startsWith("MM")) {
+        bigEndian = true;
+    } else {
+        return false;
+    }
+
+    const quint64 magic = readUInt(data, 2, 2, bigEndian);
+    if (42 == magic) {
+        bigTiff = false;
+        return true;
+    }
+
+    // BigTIFF 文件头: 字节序(2) + 43(2) + 偏移字节数 8(2) + 保留(2) + IFD0 偏移(8)
+    if (43 == magic && data.size() >= 16 && 8 == readUInt(data, 4, 2, bigEndian)) {
+        bigTiff = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+   @return 读取 \a data 中偏移 \a ifdOffset 处 IFD 的条带/分块数据总大小，解析失败时返回 0
+ */
+static qint64 tiffFrameDataSize(const QByteArray &data, qint64 ifdOffset, quint64 entryCount, bool bigEndian, bool bigTiff)
+{
+    const int countSize = bigTiff ? 8 : 2;
+    const int entrySize = bigTiff ? 20 : 12;
+    const int offsetSize = bigTiff ? 8 : 4;
+
+    qint64 total = 0;
+    for (quint64 i = 0; i < entryCount; ++i) {
+        const qint64 entry = ifdOffset + countSize + qint64(i) * entrySize;
+        const quint64 tag = readUInt(data, entry, 2, bigEndian);
+        if (TagStripByteCounts != tag && TagTileByteCounts != tag) {
+            continue;
+        }
+
+        // 字段类型: 3 SHORT, 4 LONG, 16 LONG8
+        const quint64 type = readUInt(data, entry + 2, 2, bigEndian);
+        const int valueSize = (3 == type) ? 2 : (4 == type) ? 4 : (16 == type) ? 8 : 0;
+        if (0 == valueSize) {
+            continue;
+        }
+
+        const quint64 valueCount = readUInt(data, entry + 4, offsetSize, bigEndian);
+        const qint64 valueField = entry + 4 + offsetSize;
+        if (valueCount > quint64(data.size()) / quint64(valueSize)) {
+            return 0;
+        }
+
+        // 数据长度不超过偏移字段长度时直接存储在字段内，否则字段存储数据偏移
+        // BigTIFF 的偏移为 64 位，先与文件大小比较，避免偏移与长度相加溢出
+        const qint64 valuesLength = qint64(valueCount) * valueSize;
+        quint64 values = quint64(valueField);
+        if (valuesLength > offsetSize) {
+            values = readUInt(data, valueField, offsetSize, bigEndian);
+        }
+        if (values > quint64(data.size()) || quint64(valuesLength) > quint64(data.size()) - values) {
+            return 0;
+        }
+
+        for (quint64 j = 0; j < valueCount; ++j) {
+            total += qint64(readUInt(data, qint64(values) + qint64(j) * valueSize, valueSize, bigEndian));
+        }
+    }
+    return total;
+}
+
+/**
+   @return 跳过 GIF 从 \a pos 开始的数据子块，返回子块结束后的偏移，数据不完整时返回 -1
+ */
+static qint64 skipGifSubBlocks(const QByteArray &data, qint64 pos)
+{
+    while (pos < data.size()) {
+        const int len = uchar(data.at(pos));
+        pos += 1;
+        if (0 == len) {
+            return pos;
+        }
+        pos += len;
+    }
+    return -1;
+}
+
+/**
+   @return 扫描文件数据 \a data 生成帧索引，不支持的格式或静态 WebP 返回空列表。
+        \a maxFrames 大于 0 时扫描到指定帧数即停止，仅需判断是否为多帧时无需遍历整个文件
+ */
+FrameIndexList FrameIndex::build(const QByteArray &data, int maxFrames)
+{
+    if (maxFrames <= 0 || maxFrames > s_maxFrames) {
+        maxFrames = s_maxFrames;
+    }
+
+    FrameIndexList frames;
+    if (isTiff(data)) {
+        frames = buildTiff(data, maxFrames);
+    } else if (data.startsWith("GIF87a") || data.startsWith("GIF89a")) {
+        frames = buildGif(data, maxFrames);
+    } else if (data.size() >= 12 && data.startsWith("RIFF") && 0 == memcmp(data.constData() + 8, "WEBP", 4)) {
+        frames = buildWebP(data, maxFrames);
+    }
+    return frames;
+}
+
+/**
+   @return 序列化的帧索引 \a frames ，空索引同样生成数据，用于标记文件已扫描
+ */
+QByteArray FrameIndex::serialize(const FrameIndexList &frames)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << s_indexVersion << qint32(frames.size());
+    for (const FrameIndexEntry &frame : frames) {
+        stream << frame.offset << frame.size << qint32(frame.delay);
+    }
+    return data;
+}
+
+/**
+   @return 反序列化的帧索引，数据无效或版本不匹配时返回空列表
+ */
+FrameIndexList FrameIndex::deserialize(const QByteArray &data)
+{
+    FrameIndexList frames;
+    QDataStream stream(data);
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> version >> count;
+    if (s_indexVersion != version || count < 0 || count > s_maxFrames) {
+        return frames;
+    }
+
+    frames.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        FrameIndexEntry frame;
+        qint32 delay = 0;
+        stream >> frame.offset >> frame.size >> delay;
+        frame.delay = delay;
+        frames.append(frame);
+    }
+
+    if (QDataStream::Ok != stream.status()) {
+        qWarning() << "Invalid frame index data";
+        return FrameIndexList();
+    }
+    return frames;
+}
+
+/**
+   @return \a data 是否为 TIFF 格式数据
+ */
+bool FrameIndex::isTiff(const QByteArray &data)
+{
+    bool bigEndian = false;
+    bool bigTiff = false;
+    return parseTiffHeader(data, bigEndian, bigTiff);
+}
+
+/**
+   @brief 根据帧索引 \a frame 读取 TIFF 文件数据 \a data 中的指定页至 \a image
+   @return 是否读取成功
+ */
+bool FrameIndex::readTiffFrame(const QByteArray &data, const FrameIndexEntry &frame, QImage &image)
+{
+    bool bigEndian = false;
+    bool bigTiff = false;
+    if (!parseTiffHeader(data, bigEndian, bigTiff) || frame.offset <= 0 || frame.offset >= data.size()) {
+        return false;
+    }
+
+    // 替换文件头中的 IFD0 偏移为指定页的偏移
+    QByteArray header = data.left(bigTiff ? 16 : 8);
+    if (bigTiff) {
+        writeUInt(header, 8, 8, bigEndian, quint64(frame.offset));
+    } else {
+        if (frame.offset > 0xFFFFFFFFLL) {
+            return false;
+        }
+        writeUInt(header, 4, 4, bigEndian, quint64(frame.offset));
+    }
+
+    TiffFrameDevice device(data, header);
+    if (!device.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    QImageReader reader(&device, "tiff");
+    image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Failed to read indexed tiff frame at offset:" << frame.offset << reader.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+   @return 遍历 TIFF 文件的 IFD 链表生成的页索引
+ */
+FrameIndexList FrameIndex::buildTiff(const QByteArray &data, int maxFrames)
+{
+    FrameIndexList frames;
+    bool bigEndian = false;
+    bool bigTiff = false;
+    if (!parseTiffHeader(data, bigEndian, bigTiff)) {
+        return frames;
+    }
+
+    const int countSize = bigTiff ? 8 : 2;
+    const int entrySize = bigTiff ? 20 : 12;
+    const int offsetSize = bigTiff ? 8 : 4;
+
+    QSet<qint64> visited;
+    quint64 next = readUInt(data, bigTiff ? 8 : 4, offsetSize, bigEndian);
+    while (next > 0 && frames.size() < maxFrames) {
+        // BigTIFF 的 64 位偏移先与文件大小比较，避免转换及相加溢出
+        if (next > quint64(data.size() - countSize)) {
+            break;
+        }
+        // 异常文件的 IFD 链表可能存在循环
+        const qint64 offset = qint64(next);
+        if (visited.contains(offset)) {
+            break;
+        }
+        visited.insert(offset);
+
+        const quint64 entryCount = readUInt(data, offset, countSize, bigEndian);
+        if (entryCount > quint64(data.size()) / quint64(entrySize)) {
+            break;
+        }
+        const qint64 nextField = offset + countSize + qint64(entryCount) * entrySize;
+        if (nextField + offsetSize > data.size()) {
+            break;
+        }
+
+        FrameIndexEntry frame;
+        frame.offset = offset;
+        frame.size = tiffFrameDataSize(data, offset, entryCount, bigEndian, bigTiff);
+        frames.append(frame);
+
+        next = readUInt(data, nextField, offsetSize, bigEndian);
+    }
+    return frames;
+}
+
+/**
+   @return 遍历 GIF 文件数据块生成的帧索引，帧显示时长取自图形控制扩展
+ */
+FrameIndexList FrameIndex::buildGif(const QByteArray &data, int maxFrames)
+{
+    FrameIndexList frames;
+    if (data.size() < 13) {
+        return frames;
+    }
+
+    // 逻辑屏幕描述符后为可选的全局颜色表
+    qint64 pos = 13;
+    const uchar screenFlags = uchar(data.at(10));
+    if (screenFlags & 0x80) {
+        pos += 3 * (1 << ((screenFlags & 0x07) + 1));
+    }
+
+    qint64 frameStart = -1;
+    int delay = 0;
+    while (pos >= 0 && pos < data.size() && frames.size() < maxFrames) {
+        const uchar blockType = uchar(data.at(pos));
+        if (0x3B == blockType) {
+            // 文件结束
+            break;
+        } else if (0x21 == blockType) {
+            if (pos + 2 > data.size()) {
+                break;
+            }
+            // 图形控制扩展，记录下一帧的显示时长(1/100 s)
+            if (0xF9 == uchar(data.at(pos + 1)) && pos + 8 <= data.size()) {
+                delay = int(readUInt(data, pos + 4, 2, false)) * 10;
+                frameStart = pos;
+            }
+            pos = skipGifSubBlocks(data, pos + 2);
+        } else if (0x2C == blockType) {
+            if (pos + 10 > data.size()) {
+                break;
+            }
+            if (frameStart < 0) {
+                frameStart = pos;
+            }
+
+            // 图像描述符后为可选的局部颜色表、LZW 编码长度及图像数据子块
+            const uchar imageFlags = uchar(data.at(pos + 9));
+            pos += 10;
+            if (imageFlags & 0x80) {
+                pos += 3 * (1 << ((imageFlags & 0x07) + 1));
+            }
+            pos = skipGifSubBlocks(data, pos + 1);
+            if (pos < 0) {
+                break;
+            }
+
+            FrameIndexEntry frame;
+            frame.offset = frameStart;
+            frame.size = pos - frameStart;
+            frame.delay = delay;
+            frames.append(frame);
+
+            frameStart = -1;
+            delay = 0;
+        } else {
+            qWarning() << "Unknown gif block type:" << blockType << "at offset:" << pos;
+            break;
+        }
+    }
+    return frames;
+}
+
+/**
+   @return 遍历 WebP 文件数据块生成的动画帧索引，静态 WebP 返回空列表
+ */
+FrameIndexList FrameIndex::buildWebP(const QByteArray &data, int maxFrames)
+{
+    FrameIndexList frames;
+    qint64 pos = 12;
+    while (pos + 8 <= data.size() && frames.size() < maxFrames) {
+        const qint64 chunkSize = qint64(readUInt(data, pos + 4, 4, false));
+        const qint64 payload = pos + 8;
+        if (payload + chunkSize > data.size()) {
+            break;
+        }
+
+        // ANMF 数据块: X(3) Y(3) 宽度-1(3) 高度-1(3) 显示时长(3) 标志(1) 帧数据
+        if (0 == memcmp(data.constData() + pos, "ANMF", 4) && chunkSize >= 16) {
+            FrameIndexEntry frame;
+            frame.offset = pos;
+            frame.size = 8 + chunkSize;
+            frame.delay = int(readUInt(data, payload + 12, 3, false));
+            frames.append(frame);
+        }
+
+        // 数据块按偶数字节对齐
+        pos = payload + chunkSize + (chunkSize & 1);
+    }
+    return frames;
+}
+
+}  // namespace LibUnionImage_NameSpace
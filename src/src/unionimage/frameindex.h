@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMEINDEX_H
+#define FRAMEINDEX_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+
+#include "unionimage_global.h"
+
+namespace LibUnionImage_NameSpace {
+
+/**
+ * @brief 多页图/动态图单帧的索引信息
+ */
+struct FrameIndexEntry {
+    qint64 offset = 0;  // 帧数据在文件中的偏移(TIFF 为 IFD 偏移，GIF 为图形控制扩展或图像描述符偏移，WebP 为 ANMF 数据块偏移)
+    qint64 size = 0;    // 帧数据大小
+    int delay = 0;      // 帧显示时长(ms)，多页图为 0
+};
+typedef QList<FrameIndexEntry> FrameIndexList;
+
+/**
+ * @brief 多页图/动态图的帧索引，仅扫描文件结构，不解码图像数据。
+ * 支持 TIFF(含 BigTIFF)、GIF 和动态 WebP ，索引可序列化后持久保存，
+ * TIFF 文件可根据索引直接读取指定页，无需从首页逐页查找
+ */
+class UNIONIMAGESHARED_EXPORT FrameIndex
+{
+public:
+    static FrameIndexList build(const QByteArray &data, int maxFrames = 0);
+
+    static QByteArray serialize(const FrameIndexList &frames);
+    static FrameIndexList deserialize(const QByteArray &data);
+
+    static bool isTiff(const QByteArray &data);
+    static bool readTiffFrame(const QByteArray &data, const FrameIndexEntry &frame, QImage &image);
+
+private:
+    static FrameIndexList buildTiff(const QByteArray &data, int maxFrames);
+    static FrameIndexList buildGif(const QByteArray &data, int maxFrames);
+    static FrameIndexList buildWebP(const QByteArray &data, int maxFrames);
+};
+
+}  // namespace LibUnionImage_NameSpace
+
+#endif  // FRAMEINDEX_H
@@ -4,7 +4,9 @@
 
 #include "baseutils.h"
 #include "imageutils.h"
+#include "dirwalker.h"
 #include "unionimage.h"
+#include "dbmanager/formatsniffcache.h"
 #include <fstream>
 
 #include <QBuffer>
@@ -94,8 +96,8 @@ bool imageSupportRead(const QString &path)
     /*lmh0724使用USE_UNIONIMAGE*/
     //修正论坛上提出的格式判断错误，应该采用真实格式
     //20210220真实格式来做判断
-    QMap<QString, QString> dataMap = getAllMetaData(path);
-    const QString suffix = dataMap.value("FileFormat");
+    //FileFormat 即文件后缀，直接读取，无需打开文件获取全部元数据
+    const QString suffix = QFileInfo(path).suffix();
     QStringList errorList;
     errorList << "X3F";
     if (errorList.indexOf(suffix.toUpper()) != -1) {
@@ -618,31 +620,15 @@ QFileInfoList getImagesAndVideoInfo(const QString &dir, bool recursive)
     qDebug() << "Getting images and video info from directory:" << dir << "recursive:" << recursive;
     QFileInfoList infos;
 
-    if (! recursive) {
-        QFileInfoList nsl;
-        getAllFileInDir(dir, nsl);
-        for (QFileInfo info : nsl) {
-            if (imageSupportRead(info.absoluteFilePath()) ||
-                    isVideo(info.absoluteFilePath())) {
-                infos << info;
-            }
-        }
-        qDebug() << "Found" << infos.size() << "media files in directory";
-        return infos;
-    }
-
-    QDirIterator dirIterator(dir,
-                             QDir::Files,
-                             QDirIterator::Subdirectories);
-    while (dirIterator.hasNext()) {
-        dirIterator.next();
-        if ( imageSupportRead(dirIterator.fileInfo().absoluteFilePath())
-                || isVideo(dirIterator.fileInfo().absoluteFilePath())) {
-            infos << dirIterator.fileInfo();
+    //按扩展名并行遍历，仅对通过扩展名筛选的文件做进一步判断(如ts文件需区分视频和翻译文件)
+    const QStringList paths = LibUnionImage_NameSpace::walkMediaFiles(dir, recursive);
+    for (const QString &path : paths) {
+        if (imageSupportRead(path) || isVideo(path)) {
+            infos << QFileInfo(path);
         }
     }
 
-    qDebug() << "Found" << infos.size() << "media files recursively";
+    qDebug() << "Found" << infos.size() << "media files";
     return infos;
 }
 
@@ -669,8 +655,22 @@ bool isVideo(QString path)
 
     // ts文件可能为翻译文件，使用QMimeDataBase::mimeTypeForFile做精确判断，判断是否为视频
     if (fileName == "ts") {
-        bool isVideo = QMimeDatabase().mimeTypeForFile(path).name() == "video/mp2t";
+        FormatCacheInfo cacheInfo;
+        if (temDir.exists() && FormatSniffCache::instance()->find(path, temDir, cacheInfo) && -1 != cacheInfo.isVideo) {
+            return 1 == cacheInfo.isVideo;
+        }
+
+        QString mimeName = QMimeDatabase().mimeTypeForFile(path).name();
+        bool isVideo = mimeName == "video/mp2t";
         qDebug() << "TS file video status:" << isVideo;
+
+        if (temDir.exists()) {
+            FormatCacheInfo sniffInfo;
+            sniffInfo.filePath = path;
+            sniffInfo.format = mimeName;
+            sniffInfo.isVideo = isVideo ? 1 : 0;
+            FormatSniffCache::instance()->update(temDir, sniffInfo);
+        }
         return isVideo;
     }
 
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mappedfile.h"
+
+#include <QDebug>
+#include <QList>
+
+#include <sys/mman.h>
+#include <sys/vfs.h>
+
+namespace LibUnionImage_NameSpace {
+
+// 不映射的文件系统：文件可能在映射期间被移除(拔出设备、网络断开、FUSE 进程退出)，访问映射内存将触发 SIGBUS
+static const QList<qint64> s_unmappableFileSystems = {
+    0x65735546,  // FUSE_SUPER_MAGIC (含 ntfs-3g、MTP/gvfs 等)
+    0x4d44,      // MSDOS_SUPER_MAGIC (vfat)
+    0x2011BAB0,  // EXFAT_SUPER_MAGIC
+    0x5346544e,  // NTFS_SB_MAGIC
+    0x9660,      // ISOFS_SUPER_MAGIC
+    0x15013346,  // UDF_SUPER_MAGIC
+    0x6969,      // NFS_SUPER_MAGIC
+    0x517B,      // SMB_SUPER_MAGIC
+    0xFF534D42,  // CIFS_MAGIC_NUMBER
+    0xFE534D42,  // SMB2_MAGIC_NUMBER
+};
+
+/**
+   @return 已打开的文件 \a file 是否位于可安全映射的本地固定存储上，
+        移动设备挂载目录(/media、/run/media)及可移除、网络、FUSE 文件系统上的文件不映射
+ */
+static bool isMappableStorage(QFile &file)
+{
+    const QString path = file.fileName();
+    if (path.startsWith("/media/") || path.startsWith("/run/media/")) {
+        return false;
+    }
+
+    struct statfs fsInfo;
+    if (0 != fstatfs(file.handle(), &fsInfo)) {
+        return false;
+    }
+    return !s_unmappableFileSystems.contains(qint64(static_cast<quint32>(fsInfo.f_type)));
+}
+
+/**
+   @class MappedFile
+   @brief 以只读方式映射文件 \a path ，映射区域提示内核顺序读取，
+    data() 返回的 QByteArray 直接引用映射内存，可通过 QBuffer 提供给 QImageReader / QMimeDatabase 等使用
+   @note 映射的生命周期同对象一致，引用 data() 的 QBuffer 等对象不能超出 MappedFile 的生命周期。
+    映射本身不读取数据，嗅探、哈希只访问头部页面；需要解码完整文件时调用 willNeed() 预读。
+    文件在映射期间被截断时访问映射内存将触发 SIGBUS ，因此移动设备、网络及 FUSE 文件系统上的文件不映射
+ */
+MappedFile::MappedFile(const QString &path)
+    : file(path)
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open file for mapping:" << path << file.errorString();
+        return;
+    }
+
+    const qint64 fileSize = file.size();
+    if (fileSize <= 0) {
+        return;
+    }
+
+    if (!isMappableStorage(file)) {
+        qDebug() << "Skip mapping file on removable or remote storage:" << path;
+        return;
+    }
+
+    mappedData = file.map(0, fileSize);
+    if (!mappedData) {
+        qDebug() << "Failed to map file, fallback to buffered read:" << path << file.errorString();
+        return;
+    }
+
+    // 嗅探、哈希和解码均按顺序读取，提示内核顺序预读
+    if (0 != madvise(mappedData, size_t(fileSize), MADV_SEQUENTIAL)) {
+        qDebug() << "madvise failed for:" << path;
+    }
+    rawData = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData), qsizetype(fileSize));
+}
+
+MappedFile::~MappedFile()
+{
+    rawData.clear();
+    if (mappedData) {
+        file.unmap(mappedData);
+    }
+}
+
+/**
+   @return 是否成功映射文件
+ */
+bool MappedFile::isValid() const
+{
+    return nullptr != mappedData;
+}
+
+/**
+   @brief 即将解码完整文件时调用，提示内核预读全部映射数据
+ */
+void MappedFile::willNeed()
+{
+    if (mappedData && 0 != madvise(mappedData, size_t(rawData.size()), MADV_WILLNEED)) {
+        qDebug() << "madvise(MADV_WILLNEED) failed for:" << file.fileName();
+    }
+}
+
+/**
+   @return 映射的文件路径
+ */
+QString MappedFile::filePath() const
+{
+    return file.fileName();
+}
+
+/**
+   @return 映射的数据大小
+ */
+qint64 MappedFile::size() const
+{
+    return rawData.size();
+}
+
+/**
+   @return 映射的文件数据，未映射时返回空数据
+ */
+const QByteArray &MappedFile::data() const
+{
+    return rawData;
+}
+
+/**
+   @return 文件头部 \a length 字节数据，同样直接引用映射内存
+ */
+QByteArray MappedFile::head(qint64 length) const
+{
+    return QByteArray::fromRawData(rawData.constData(), qsizetype(qMin<qint64>(length, rawData.size())));
+}
+
+}  // namespace LibUnionImage_NameSpace
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "unionimage_global.h"
+
+namespace LibUnionImage_NameSpace {
+
+/**
+ * @brief 只读的文件内存映射，嗅探、哈希和解码共享同一映射，文件数据只从页缓存读取一次。
+ * 映射失败(空文件、不支持 mmap 的文件系统、移动设备或网络存储上的文件等)时 isValid() 返回 false ，
+ * 调用方应回退为普通文件读取
+ */
+class UNIONIMAGESHARED_EXPORT MappedFile
+{
+public:
+    explicit MappedFile(const QString &path);
+    ~MappedFile();
+
+    bool isValid() const;
+    QString filePath() const;
+    qint64 size() const;
+    void willNeed();
+
+    const QByteArray &data() const;
+    QByteArray head(qint64 length) const;
+
+private:
+    QFile file;
+    uchar *mappedData = nullptr;
+    QByteArray rawData;  ///< 引用映射内存，不拷贝数据
+
+    Q_DISABLE_COPY(MappedFile)
+};
+
+}  // namespace LibUnionImage_NameSpace
+
+#endif  // MAPPEDFILE_H
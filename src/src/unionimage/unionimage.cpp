@@ -15,12 +15,17 @@
 #include <QPainter>
 #include <QSvgGenerator>
 #include <QImageReader>
+#include <QFile>
+#include <QSaveFile>
+#include <QBuffer>
 #include <QMimeDatabase>
 #include <QtSvg/QSvgRenderer>
 #include <QDir>
 #include <QDebug>
 
 #include "unionimage/imageutils.h"
+#include "unionimage/mappedfile.h"
+#include "dbmanager/formatsniffcache.h"
 
 #include <cstring>
 
@@ -284,67 +289,278 @@ UNIONIMAGESHARED_EXPORT bool creatNewImage(QImage &res, int width, int height, i
 }
 
 QString PrivateDetectImageFormat(const QString &filepath);
-UNIONIMAGESHARED_EXPORT bool loadStaticImageFromFile(const QString &path, QImage &res, QString &errorMsg, const QString &format_bar)
+
+/**
+ * @brief exifOrientationFromTransformation
+ * @param transformation 解码器读取的变换信息
+ * @return EXIF 方向信息(1~8)
+ * 将 QImageIOHandler 变换信息转换为 EXIF 方向值
+ */
+static int exifOrientationFromTransformation(QImageIOHandler::Transformations transformation)
+{
+    switch (transformation) {
+    case QImageIOHandler::TransformationMirror:
+        return 2;
+    case QImageIOHandler::TransformationRotate180:
+        return 3;
+    case QImageIOHandler::TransformationFlip:
+        return 4;
+    case QImageIOHandler::TransformationFlipAndRotate90:
+        return 5;
+    case QImageIOHandler::TransformationRotate90:
+        return 6;
+    case QImageIOHandler::TransformationMirrorAndRotate90:
+        return 7;
+    case QImageIOHandler::TransformationRotate270:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+class UnionImageProbePrivate
+{
+public:
+    explicit UnionImageProbePrivate(const QString &path)
+        : file(path)
+    {
+        QFileInfo fileInfo(path);
+        info.filePath = path;
+        info.suffix = fileInfo.suffix();
+        info.fileSize = fileInfo.size();
+        info.lastModified = fileInfo.lastModified();
+    }
+
+    ~UnionImageProbePrivate()
+    {
+        // 解码器先于映射数据释放
+        reader.setDevice(nullptr);
+    }
+
+    /**
+     * @brief openDevice 打开文件并关联到解码器，整个探测/解码过程只打开一次
+     *  优先使用文件内存映射，EXIF 解析、哈希和解码共享同一份映射数据，
+     *  映射失败或文件位于移动设备、网络存储上时使用普通文件读取
+     */
+    bool openDevice()
+    {
+        if (device) {
+            return true;
+        }
+
+        mapped.reset(new MappedFile(info.filePath));
+        if (mapped->isValid()) {
+            buffer.setData(mapped->data());
+            buffer.open(QIODevice::ReadOnly);
+            device = &buffer;
+        } else {
+            mapped.reset();
+            if (!file.open(QIODevice::ReadOnly)) {
+                qWarning() << "Failed to open file for probe:" << info.filePath << file.errorString();
+                return false;
+            }
+            device = &file;
+        }
+
+        reader.setDevice(device);
+        reader.setFormat(info.suffix.toLower().toLatin1());
+        return true;
+    }
+
+    /**
+     * @brief resetReader 复用已打开的文件，使用新的格式重新初始化解码器
+     */
+    void resetReader(const QByteArray &format)
+    {
+        reader.setDevice(nullptr);
+        device->seek(0);
+        reader.setDevice(device);
+        reader.setFormat(format);
+    }
+
+    QScopedPointer<MappedFile> mapped;
+    QBuffer buffer;
+    QFile file;
+    QIODevice *device = nullptr;  // 当前使用的映射数据或文件
+    QImageReader reader;
+    ImageProbeInfo info;
+    ExifInfo exif;
+    bool probed = false;
+    bool exifParsed = false;
+};
+
+UnionImageProbe::UnionImageProbe(const QString &path)
+    : d_ptr(new UnionImageProbePrivate(path))
 {
-    qDebug() << "Loading static image from file:" << path;
-    QFileInfo file_info(path);
-    if (file_info.size() == 0) {
+}
+
+UnionImageProbe::~UnionImageProbe()
+{
+    delete d_ptr;
+}
+
+bool UnionImageProbe::probe()
+{
+    Q_D(UnionImageProbe);
+    if (d->probed) {
+        return d->info.valid;
+    }
+    d->probed = true;
+
+    if (!d->openDevice()) {
+        return false;
+    }
+
+    // 一次读取文件头得到全部信息，后续解码复用同一解码器
+    d->info.size = d->reader.size();
+    d->info.format = d->reader.format();
+    d->info.orientation = exifOrientationFromTransformation(d->reader.transformation());
+    d->info.valid = d->info.size.isValid();
+
+    qDebug() << "Probed image:" << d->info.filePath << "format:" << d->info.format
+             << "size:" << d->info.size << "orientation:" << d->info.orientation;
+    return d->info.valid;
+}
+
+bool UnionImageProbe::read(QImage &res, QString &errorMsg, const QString &format_bar)
+{
+    Q_D(UnionImageProbe);
+    qDebug() << "Loading static image from file:" << d->info.filePath;
+    const QString &path = d->info.filePath;
+    if (d->info.fileSize == 0) {
         qWarning() << "File is empty:" << path;
         res = QImage();
         errorMsg = "error file!";
         return false;
     }
-    QMap<QString, QString> dataMap = getAllMetaData(path);
-    QString file_suffix_upper = dataMap.value("FileFormat").toUpper();
-
-    QByteArray temp_path;
-    temp_path.append(path.toUtf8());
-    QString file_suffix_lower = file_suffix_upper.toLower();
-    if (union_image_private.m_qtSupported.contains(file_suffix_upper)) {
-        QImageReader reader;
-        QImage res_qt;
-        reader.setFileName(path);
-        if (format_bar.isEmpty()) {
-            reader.setFormat(file_suffix_lower.toLatin1());
-        } else {
-            reader.setFormat(format_bar.toLatin1());
-        }
-        reader.setAutoTransform(true);
-        if (reader.imageCount() > 0 || file_suffix_upper != "ICNS") {
-            res_qt = reader.read();
-            if (res_qt.isNull()) {
-                qDebug() << "Failed to read image with QImageReader, trying alternative method";
-                QString format = PrivateDetectImageFormat(path);
-                QImageReader readerF(path, format.toLatin1());
-                QImage try_res;
-                readerF.setAutoTransform(true);
-                if (readerF.canRead()) {
-                    try_res = readerF.read();
-                } else {
-                    errorMsg = "can't read image:" + readerF.errorString() + format;
-                    try_res = QImage(path);
-                }
-                if (try_res.isNull()) {
-                    errorMsg = "load image by qt faild, use format:" + reader.format() + " ,path:" + path;
-                    res = QImage();
-                    return false;
-                }
-                errorMsg = "use old method to load QImage";
-                res = try_res;
-                return true;
+
+    QString file_suffix_upper = d->info.suffix.toUpper();
+    if (!union_image_private.m_qtSupported.contains(file_suffix_upper)) {
+        qWarning() << "Unsupported file format:" << file_suffix_upper;
+        return false;
+    }
+
+    if (!d->openDevice()) {
+        res = QImage();
+        errorMsg = "can't open file:" + d->file.errorString();
+        return false;
+    }
+    // 解码读取完整文件，提前预读映射数据
+    if (d->mapped) {
+        d->mapped->willNeed();
+    }
+
+    // 指定解码格式时，使用指定格式重新初始化解码器
+    if (!format_bar.isEmpty() && format_bar.toLatin1() != d->reader.format()) {
+        d->resetReader(format_bar.toLatin1());
+        d->probed = false;
+    }
+    probe();
+
+    d->reader.setAutoTransform(true);
+    // 仅 ICNS 需要确认包含图像，其它格式不统计帧数，避免遍历多帧图片的全部帧
+    if (file_suffix_upper != "ICNS" || d->reader.imageCount() > 0) {
+        QImage res_qt = d->reader.read();
+        if (res_qt.isNull()) {
+            qDebug() << "Failed to read image with QImageReader, trying alternative method";
+            QByteArray failedFormat = d->reader.format();
+            QString format = PrivateDetectImageFormat(path);
+            d->resetReader(format.toLatin1());
+            d->reader.setAutoTransform(true);
+            QImage try_res;
+            if (d->reader.canRead()) {
+                try_res = d->reader.read();
+            } else {
+                errorMsg = "can't read image:" + d->reader.errorString() + format;
+                try_res = QImage(path);
             }
-            errorMsg = "use QImage";
-            res = res_qt;
-        } else {
-            qWarning() << "No images found in file:" << path;
-            res = QImage();
-            return false;
+            if (try_res.isNull()) {
+                errorMsg = "load image by qt faild, use format:" + failedFormat + " ,path:" + path;
+                res = QImage();
+                return false;
+            }
+            errorMsg = "use old method to load QImage";
+            d->info.format = format.toLatin1();
+            res = try_res;
+            return true;
         }
-        qDebug() << "Successfully loaded image from file";
-        return true;
+        errorMsg = "use QImage";
+        res = res_qt;
+    } else {
+        qWarning() << "No images found in file:" << path;
+        res = QImage();
+        return false;
     }
-    qWarning() << "Unsupported file format:" << file_suffix_upper;
-    return false;
+    qDebug() << "Successfully loaded image from file";
+    return true;
+}
+
+const ImageProbeInfo &UnionImageProbe::info() const
+{
+    Q_D(const UnionImageProbe);
+    return d->info;
+}
+
+const ExifInfo &UnionImageProbe::exifInfo()
+{
+    Q_D(UnionImageProbe);
+    if (!d->exifParsed) {
+        d->exifParsed = true;
+        // 复用探测打开的文件，读取后恢复文件位置，不影响后续解码
+        d->exif = d->openDevice() ? ExifParser::parseDevice(d->device) : ExifInfo();
+    }
+    return d->exif;
+}
+
+const QByteArray &UnionImageProbe::fileData()
+{
+    Q_D(UnionImageProbe);
+    static const QByteArray s_empty;
+    return (d->openDevice() && d->mapped) ? d->mapped->data() : s_empty;
+}
+
+QMap<QString, QString> UnionImageProbe::metaData()
+{
+    Q_D(UnionImageProbe);
+    probe();
+    const ExifInfo &exif = exifInfo();
+
+    QMap<QString, QString> admMap;
+    //移除秒　　2020/6/5 DJH
+    //需要转义才能读出：或者/　　2020/8/21 DJH
+    // 优先使用 EXIF 记录的拍摄时间，未记录时使用文件修改时间
+    const QDateTime &original = exif.dateTimeOriginal.isValid() ? exif.dateTimeOriginal : d->info.lastModified;
+    const QDateTime &digitized = exif.dateTimeDigitized.isValid() ? exif.dateTimeDigitized : original;
+    admMap.insert("DateTimeOriginal", original.toString("yyyy/MM/dd HH:mm"));
+    admMap.insert("DateTimeDigitized", digitized.toString("yyyy/MM/dd HH:mm"));
+    if (!exif.make.isEmpty()) {
+        admMap.insert("Make", exif.make);
+    }
+    if (!exif.model.isEmpty()) {
+        admMap.insert("Model", exif.model);
+    }
+
+    // The value of width and height might incorrect
+    int w = d->info.size.width();
+    int h = d->info.size.height();
+    admMap.insert("Dimension", QString::number(w) + "x" + QString::number(h));
+    // 记录图片宽高
+    admMap.insert("Width", QString::number(w));
+    admMap.insert("Height", QString::number(h));
+
+    admMap.insert("FileName", QFileInfo(d->info.filePath).fileName());
+    //应该使用qfileinfo的格式
+    admMap.insert("FileFormat", d->info.suffix);
+    admMap.insert("FileSize", size2Human(d->info.fileSize));
+
+    qDebug() << "Found" << admMap.size() << "metadata entries";
+    return admMap;
+}
+
+UNIONIMAGESHARED_EXPORT bool loadStaticImageFromFile(const QString &path, QImage &res, QString &errorMsg, const QString &format_bar)
+{
+    UnionImageProbe probe(path);
+    return probe.read(res, errorMsg, format_bar);
 }
 
 UNIONIMAGESHARED_EXPORT QString detectImageFormat(const QString &path)
@@ -513,6 +729,39 @@ QImage adjustImageToRealPosition(const QImage &image, int orientation)
     return result;
 }
 
+/**
+   @brief 通过改写 EXIF 方向字段无损旋转 JPEG 图片 \a path 共 \a angle 度并保存至 \a savePath ，
+    不进行图像的解码和重新编码，不会降低图像质量。数据先写入同目录的临时文件，完成后替换目标文件，
+    写入中断时不会损坏原图
+   @return 是否旋转成功，无法直接改写方向字段时返回 false ，由调用方使用重新编码的方式旋转
+ */
+static bool rotateJpegByExifOrientation(int angle, const QString &path, const QString &savePath)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open JPEG for lossless rotation:" << path << file.errorString();
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    if (!ExifParser::rotateJpegOrientation(data, angle)) {
+        qDebug() << "EXIF orientation not found, lossless rotation unavailable for:" << path;
+        return false;
+    }
+
+    QSaveFile saveFile(savePath);
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for lossless rotation:" << savePath << saveFile.errorString();
+        return false;
+    }
+    if (saveFile.write(data) != data.size() || !saveFile.commit()) {
+        qWarning() << "Failed to save lossless rotation:" << savePath << saveFile.errorString();
+        return false;
+    }
+    return true;
+}
+
 UNIONIMAGESHARED_EXPORT bool rotateImageFIle(int angel, const QString &path, QString &erroMsg, const QString &targetPath)
 {
     qDebug() << "Rotating image file:" << path << "by" << angel << "degrees";
@@ -561,6 +810,10 @@ UNIONIMAGESHARED_EXPORT bool rotateImageFIle(int angel, const QString &path, QSt
         qDebug() << "Successfully rotated SVG file";
         return true;
 
+    } else if ((format == "JPG" || format == "JPEG") && rotateJpegByExifOrientation(angel, path, savePath)) {
+        // JPEG 图片优先改写 EXIF 方向字段，无需重新编码
+        qDebug() << "Successfully rotated JPEG by EXIF orientation";
+        return true;
     } else if (union_image_private.m_qtrotate.contains(format)) {
         //由于Qt内部不会去读图片的EXIF信息来判断当前的图像矩阵的真实位置，同时回写数据的时候会丢失全部的EXIF数据
         int orientation = getOrientation(path);
@@ -651,34 +904,8 @@ UNIONIMAGESHARED_EXPORT bool rotateImageFIleWithImage(int angel, QImage &img, co
 UNIONIMAGESHARED_EXPORT QMap<QString, QString> getAllMetaData(const QString &path)
 {
     qDebug() << "Getting all metadata for:" << path;
-    QMap<QString, QString> admMap;
-    //移除秒　　2020/6/5 DJH
-    //需要转义才能读出：或者/　　2020/8/21 DJH
-    QFileInfo info(path);
-    if (admMap.contains("DateTime")) {
-        QDateTime time = QDateTime::fromString(admMap["DateTime"], "yyyy:MM:dd hh:mm:ss");
-        admMap["DateTimeOriginal"] = time.toString("yyyy/MM/dd hh:mm");
-    } else {
-        admMap.insert("DateTimeOriginal",  info.lastModified().toString("yyyy/MM/dd HH:mm"));
-    }
-    admMap.insert("DateTimeDigitized",  info.lastModified().toString("yyyy/MM/dd HH:mm"));
-
-           // The value of width and height might incorrect
-    QImageReader reader(path);
-    int w = reader.size().width();
-    int h = reader.size().height();
-    admMap.insert("Dimension", QString::number(w) + "x" + QString::number(h));
-    // 记录图片宽高
-    admMap.insert("Width", QString::number(w));
-    admMap.insert("Height", QString::number(h));
-
-    admMap.insert("FileName", info.fileName());
-    //应该使用qfileinfo的格式
-    admMap.insert("FileFormat", getFileFormat(path));
-    admMap.insert("FileSize", size2Human(info.size()));
-
-    qDebug() << "Found" << admMap.size() << "metadata entries";
-    return admMap;
+    UnionImageProbe probe(path);
+    return probe.metaData();
 }
 
 UNIONIMAGESHARED_EXPORT bool isImageSupportRotate(const QString &path)
@@ -688,8 +915,62 @@ UNIONIMAGESHARED_EXPORT bool isImageSupportRotate(const QString &path)
 
 UNIONIMAGESHARED_EXPORT int getOrientation(const QString &path)
 {
-    Q_UNUSED(path);
-    return 1;
+    return ExifParser::parseFile(path).orientation;
+}
+
+/**
+   @return 文件 \a path 是否为支持建立帧索引的多页图/动态图格式(TIFF/GIF/WebP)，
+        优先按扩展名判断，避免 CR2/NEF/ARW/DNG 等基于 TIFF 结构的 RAW 格式被当作多页 TIFF
+ */
+static bool isFrameIndexFormat(const QString &path)
+{
+    static const QStringList s_frameIndexMimes = {"image/tiff", "image/gif", "image/webp"};
+
+    QMimeDatabase db;
+    QMimeType mt = db.mimeTypeForFile(path, QMimeDatabase::MatchExtension);
+    if (mt.isDefault()) {
+        // 无可识别扩展名时按文件头判断
+        mt = db.mimeTypeForFile(path, QMimeDatabase::MatchContent);
+    }
+    return s_frameIndexMimes.contains(mt.name());
+}
+
+/**
+   @return 文件 \a path 的帧索引，缓存无效时扫描映射数据 \a mapped 重新建立并更新缓存
+ */
+static FrameIndexList frameIndexFor(const QString &path, const MappedFile &mapped)
+{
+    QFileInfo fi(path);
+    FormatCacheInfo cacheInfo;
+    if (FormatSniffCache::instance()->find(path, fi, cacheInfo) && !cacheInfo.frameIndex.isEmpty()) {
+        return FrameIndex::deserialize(cacheInfo.frameIndex);
+    }
+    if (!mapped.isValid()) {
+        return FrameIndexList();
+    }
+
+    const FrameIndexList frames = FrameIndex::build(mapped.data());
+    qDebug() << "Built frame index for:" << path << "frames:" << frames.size();
+
+    FormatCacheInfo sniffInfo;
+    sniffInfo.filePath = path;
+    sniffInfo.frameIndex = FrameIndex::serialize(frames);
+    if (!frames.isEmpty()) {
+        sniffInfo.frameCount = frames.size();
+    }
+    FormatSniffCache::instance()->update(fi, sniffInfo);
+    return frames;
+}
+
+/**
+   @return 通过文件映射数据 \a mapped 检测文件内容的 MIME 类型，未映射时回退为读取文件 \a path 头部
+ */
+static QMimeType mimeTypeForContent(const QMimeDatabase &db, const QString &path, const MappedFile &mapped)
+{
+    if (mapped.isValid()) {
+        return db.mimeTypeForData(mapped.data());
+    }
+    return db.mimeTypeForFile(path, QMimeDatabase::MatchContent);
 }
 
 imageViewerSpace::ImageType getImageType(const QString &imagepath)
@@ -705,16 +986,51 @@ imageViewerSpace::ImageType getImageType(const QString &imagepath)
             return imageViewerSpace::ImageTypeBlank;
         }
 
+        // 文件未变更时直接使用缓存的嗅探结果，无需打开文件
+        FormatCacheInfo cacheInfo;
+        if (FormatSniffCache::instance()->find(imagepath, fi, cacheInfo) && -1 != cacheInfo.imageType) {
+            qDebug() << "Image type from cache:" << cacheInfo.imageType;
+            return static_cast<imageViewerSpace::ImageType>(cacheInfo.imageType);
+        }
+
         QString strType = fi.suffix().toLower();
         //解决bug57394 【专业版1031】【看图】【5.6.3.74】【修改引入】pic格式图片变为翻页状态，不为动图且首张显示序号为0
+        // MIME 嗅探和帧数读取共享同一文件映射
+        MappedFile mapped(imagepath);
         QMimeDatabase db;
-        QMimeType mt = db.mimeTypeForFile(imagepath, QMimeDatabase::MatchContent);
+        QMimeType mt = mimeTypeForContent(db, imagepath, mapped);
         QMimeType mt1 = db.mimeTypeForFile(imagepath, QMimeDatabase::MatchExtension);
         QString path1 = mt.name();
         QString path2 = mt1.name();
 
-        QImageReader imgreader(imagepath);
-        int nSize = imgreader.imageCount();
+        // 分类仅需判断是否为多帧，完整的帧索引及帧数在首次随机访问帧时建立
+        // CR2/NEF/ARW/DNG 等 RAW 格式基于 TIFF 结构，IFD 链表中的预览图不应被当作多页
+        int nSize = 1;
+        bool countKnown = true;
+        QByteArray frameIndex;  // 单帧文件的帧索引在嗅探时即已完整
+        if (mapped.isValid() && isFrameIndexFormat(imagepath)) {
+            // TIFF/GIF/WebP 扫描到第二帧即停止，不遍历整个文件
+            const FrameIndexList frames = FrameIndex::build(mapped.data(), 2);
+            nSize = qMax(1, int(frames.size()));
+            if (frames.size() < 2) {
+                frameIndex = FrameIndex::serialize(frames);
+            } else {
+                countKnown = false;
+            }
+        } else if (!mt.name().startsWith("image/tiff") || mt1.isDefault() || mt1.name().startsWith("image/tiff")) {
+            // 其它格式的解码器统计帧数时不遍历文件，未映射的文件(移动设备等)由解码器读取
+            QBuffer buffer;
+            QImageReader imgreader;
+            if (mapped.isValid()) {
+                buffer.setData(mapped.data());
+                buffer.open(QIODevice::ReadOnly);
+                imgreader.setDevice(&buffer);
+                imgreader.setFormat(strType.toLatin1());
+            } else {
+                imgreader.setFileName(imagepath);
+            }
+            nSize = imgreader.imageCount();
+        }
         //
         if (strType == "svg" && QSvgRenderer().load(imagepath)) {
             type = imageViewerSpace::ImageTypeSvg;
@@ -731,11 +1047,157 @@ imageViewerSpace::ImageType getImageType(const QString &imagepath)
         } else {
             type = imageViewerSpace::ImageTypeStatic;
         }
+
+        FormatCacheInfo sniffInfo;
+        sniffInfo.filePath = imagepath;
+        sniffInfo.format = mt.name();
+        sniffInfo.imageType = type;
+        // 提前停止扫描的多帧文件帧数未知，由帧索引确定
+        if (countKnown) {
+            sniffInfo.frameCount = nSize;
+        }
+        sniffInfo.frameIndex = frameIndex;
+        FormatSniffCache::instance()->update(fi, sniffInfo);
     }
     qDebug() << "Image type:" << type;
     return type;
 }
 
+int getFrameCount(const QString &path)
+{
+    QFileInfo fi(path);
+    FormatCacheInfo cacheInfo;
+    if (!FormatSniffCache::instance()->find(path, fi, cacheInfo) || -1 == cacheInfo.frameCount) {
+        // 嗅探图片类型时同时更新帧数缓存，单帧文件在嗅探时即可确定帧数
+        getImageType(path);
+        if (!FormatSniffCache::instance()->find(path, fi, cacheInfo) || -1 == cacheInfo.frameCount) {
+            // 多帧文件建立帧索引获取帧数，索引同时持久保存
+            const FrameIndexList frames = getFrameIndex(path);
+            return frames.isEmpty() ? QImageReader(path).imageCount() : int(frames.size());
+        }
+    }
+    return cacheInfo.frameCount;
+}
+
+FrameIndexList getFrameIndex(const QString &path)
+{
+    if (!isFrameIndexFormat(path)) {
+        return FrameIndexList();
+    }
+
+    MappedFile mapped(path);
+    return frameIndexFor(path, mapped);
+}
+
+class ImageFrameReaderPrivate
+{
+public:
+    explicit ImageFrameReaderPrivate(const QString &path)
+        : filePath(path)
+        , mapped(path)
+    {
+        if (mapped.isValid()) {
+            buffer.setData(mapped.data());
+            buffer.open(QIODevice::ReadOnly);
+        }
+        // TIFF 根据 IFD 偏移直接读取指定页
+        tiffIndexed = mapped.isValid() && FrameIndex::isTiff(mapped.data()) && isFrameIndexFormat(path);
+        resetReader();
+    }
+
+    ~ImageFrameReaderPrivate()
+    {
+        // 解码器先于映射数据释放
+        reader.setDevice(nullptr);
+    }
+
+    /**
+     * @brief resetReader 重新从首帧开始读取，复用已映射的数据或文件
+     */
+    void resetReader()
+    {
+        reader.setDevice(nullptr);
+        if (mapped.isValid()) {
+            buffer.seek(0);
+            reader.setDevice(&buffer);
+        } else {
+            reader.setFileName(filePath);
+        }
+        nextFrame = 0;
+    }
+
+    QString filePath;
+    MappedFile mapped;
+    QBuffer buffer;
+    QImageReader reader;
+    bool tiffIndexed = false;
+    bool indexLoaded = false;
+    FrameIndexList frames;
+    int nextFrame = 0;  // 解码器下次读取的帧序号
+};
+
+ImageFrameReader::ImageFrameReader(const QString &path)
+    : d_ptr(new ImageFrameReaderPrivate(path))
+{
+}
+
+ImageFrameReader::~ImageFrameReader()
+{
+    delete d_ptr;
+}
+
+int ImageFrameReader::frameCount() const
+{
+    Q_D(const ImageFrameReader);
+    return getFrameCount(d->filePath);
+}
+
+bool ImageFrameReader::read(int frameIndex, QImage &res, QString &errorMsg)
+{
+    Q_D(ImageFrameReader);
+    if (d->tiffIndexed) {
+        if (!d->indexLoaded) {
+            d->indexLoaded = true;
+            d->frames = frameIndexFor(d->filePath, d->mapped);
+        }
+        if (frameIndex >= 0 && frameIndex < d->frames.size() && FrameIndex::readTiffFrame(d->mapped.data(), d->frames.at(frameIndex), res)) {
+            return true;
+        }
+        qWarning() << "Failed to read indexed frame, fallback to sequential read:" << d->filePath << "frame:" << frameIndex;
+    }
+
+    // 动态图的帧依赖前序帧合成，需由解码器按顺序读取，顺序读取时从上次读取的位置继续
+    if (frameIndex < d->nextFrame) {
+        d->resetReader();
+    }
+    if (frameIndex > d->nextFrame && d->reader.jumpToImage(frameIndex)) {
+        d->nextFrame = frameIndex;
+    }
+    // 解码器不支持跳转时按顺序读取至指定帧
+    for (; d->nextFrame < frameIndex; ++d->nextFrame) {
+        if (d->reader.read().isNull()) {
+            errorMsg = "can't jump to frame " + QString::number(frameIndex);
+            d->resetReader();
+            return false;
+        }
+    }
+
+    res = d->reader.read();
+    if (res.isNull()) {
+        errorMsg = d->reader.errorString();
+        d->resetReader();
+        return false;
+    }
+    ++d->nextFrame;
+    return true;
+}
+
+bool loadImageFrame(const QString &path, int frameIndex, QImage &res, QString &errorMsg)
+{
+    ImageFrameReader reader(path);
+    return reader.read(frameIndex, res, errorMsg);
+}
+
 imageViewerSpace::PathType getPathType(const QString &imagepath)
 {
     //判断文件路径来自于哪里
@@ -931,13 +1393,29 @@ UNIONIMAGESHARED_EXPORT bool isImage(const QString &path)
     bool bRet = false;
     //路径为空直接跳出
     if (!path.isEmpty()) {
+        // 文件未变更时直接使用缓存的嗅探结果
+        QFileInfo fi(path);
+        FormatCacheInfo cacheInfo;
+        if (fi.exists() && FormatSniffCache::instance()->find(path, fi, cacheInfo) && -1 != cacheInfo.isImage) {
+            return 1 == cacheInfo.isImage;
+        }
+
+        MappedFile mapped(path);
         QMimeDatabase db;
-        QMimeType mt = db.mimeTypeForFile(path, QMimeDatabase::MatchContent);
+        QMimeType mt = mimeTypeForContent(db, path, mapped);
         QMimeType mt1 = db.mimeTypeForFile(path, QMimeDatabase::MatchExtension);
         if (mt.name().startsWith("image/") || mt.name().startsWith("video/x-mng") ||
                 mt1.name().startsWith("image/") || mt1.name().startsWith("video/x-mng")) {
             bRet = true;
         }
+
+        if (fi.exists()) {
+            FormatCacheInfo sniffInfo;
+            sniffInfo.filePath = path;
+            sniffInfo.format = mt.name();
+            sniffInfo.isImage = bRet ? 1 : 0;
+            FormatSniffCache::instance()->update(fi, sniffInfo);
+        }
     }
     qDebug() << "File is an image:" << bRet;
     return bRet;
@@ -20,8 +20,11 @@
 #include <QFileInfo>
 #include <QStringList>
 #include <QMap>
+#include <QDateTime>
 
 #include "unionimage_global.h"
+#include "exifparser.h"
+#include "frameindex.h"
 
 namespace  LibUnionImage_NameSpace {
 
@@ -102,6 +105,15 @@ UNIONIMAGESHARED_EXPORT QString detectImageFormat(const QString &path);
  */
 UNIONIMAGESHARED_EXPORT bool isNoneQImage(const QImage &qi);
 
+/**
+ * @brief toDisplayFormat
+ * @param[in]           image
+ * @return QImage
+ * 将图像转换为显示使用的 ARGB32_Premultiplied 格式，纹理上传和绘制时无需再次转换，
+ * 应在解码线程中调用，已为该格式时直接返回
+ */
+UNIONIMAGESHARED_EXPORT QImage toDisplayFormat(const QImage &image);
+
 /**
  * @brief rotateImage
  * @param[in]           angel
@@ -193,6 +205,33 @@ UNIONIMAGESHARED_EXPORT int getOrientation(const QString &path);
 
 UNIONIMAGESHARED_EXPORT imageViewerSpace::ImageType getImageType(const QString &imagepath);
 
+/**
+ * @brief getFrameCount
+ * @param path 文件路径
+ * @return int 多页图/动态图的帧数，优先使用持久化的嗅探缓存，无需遍历文件
+ */
+UNIONIMAGESHARED_EXPORT int getFrameCount(const QString &path);
+
+/**
+ * @brief getFrameIndex
+ * @param path 文件路径
+ * @return FrameIndexList 多页图/动态图的帧索引(偏移、大小、显示时长)，首次扫描后持久保存，
+ *         仅支持 TIFF/GIF/WebP ，其它格式(包括基于 TIFF 结构的 RAW 格式)返回空列表
+ */
+UNIONIMAGESHARED_EXPORT FrameIndexList getFrameIndex(const QString &path);
+
+/**
+ * @brief loadImageFrame
+ * @param[in]           path
+ * @param[in]           frameIndex  帧索引
+ * @param[out]          res
+ * @param[out]          errorMsg
+ * @return bool
+ * 读取多页图/动态图的指定帧，TIFF 文件根据帧索引直接定位到指定页，其它格式按顺序查找。
+ * 每次调用重新打开文件，需依次读取多帧时使用 ImageFrameReader
+ */
+UNIONIMAGESHARED_EXPORT bool loadImageFrame(const QString &path, int frameIndex, QImage &res, QString &errorMsg);
+
 /**
  * @brief getPathType
  * @param path
@@ -283,6 +322,7 @@ UNIONIMAGESHARED_EXPORT bool trashFile(const QString &file);
 /**
  * @brief getImagesAndVideoInfo
  * @param dir
+ * @param recursive 是否遍历子目录，不进入链接至目录的符号链接
  * @author LMH
  * @return QFileInfoList
  * 获得info
@@ -346,8 +386,107 @@ UNIONIMAGESHARED_EXPORT QString localPath(const QUrl& url);
  */
 UNIONIMAGESHARED_EXPORT QPixmap renderSVG(const QString &path,const QSize & size);
 
+/**
+ * @brief The ImageProbeInfo struct
+ * 单次打开文件探测得到的图片信息
+ */
+struct ImageProbeInfo {
+    QString filePath;
+    QString suffix;             // 文件后缀(大写)
+    QByteArray format;          // 解码器识别的图片格式
+    QSize size;                 // 原始图像大小(未应用方向信息)
+    int orientation = 1;        // EXIF 方向信息(1~8)
+    qint64 fileSize = 0;
+    QDateTime lastModified;
+    bool valid = false;         // 是否成功探测
+};
+
 QT_BEGIN_NAMESPACE
 
+class UnionImageProbePrivate;
+/**
+ * @brief The UnionImageProbe class
+ * 只打开一次文件，探测格式、大小和方向信息，并可使用同一文件句柄完成解码，
+ * 用于替代 getAllMetaData() + loadStaticImageFromFile() 多次打开、嗅探同一文件
+ */
+class UNIONIMAGESHARED_EXPORT UnionImageProbe
+{
+public:
+    explicit UnionImageProbe(const QString &path);
+    ~UnionImageProbe();
+
+    /**
+     * @brief probe 读取文件头，获取图片信息，不解码图像数据，重复调用直接返回缓存结果
+     * @return 是否成功获取图片信息
+     */
+    bool probe();
+
+    /**
+     * @brief read 解码首帧图像，同时填充探测信息
+     * @param[out]  res         图像数据
+     * @param[out]  errorMsg    错误信息
+     * @param[in]   format_bar  指定解码格式，为空时按文件后缀解码
+     * @return 是否解码成功
+     */
+    bool read(QImage &res, QString &errorMsg, const QString &format_bar = "");
+
+    const ImageProbeInfo &info() const;
+
+    /**
+     * @brief exifInfo 复用已打开的文件读取 EXIF 头信息(拍摄时间、方向、相机型号等)，不解码图像数据
+     */
+    const ExifInfo &exifInfo();
+
+    /**
+     * @brief fileData 返回文件的内存映射数据，可用于计算哈希等，与解码共享同一映射，
+     *  未映射(映射失败或文件位于移动设备、网络存储上)时返回空数据
+     * @note 返回的数据引用映射内存，生命周期不能超过当前对象
+     */
+    const QByteArray &fileData();
+
+    /**
+     * @brief metaData 以 getAllMetaData() 相同的格式返回探测信息
+     */
+    QMap<QString, QString> metaData();
+
+private:
+    UnionImageProbePrivate *const d_ptr;
+    Q_DECLARE_PRIVATE(UnionImageProbe)
+    Q_DISABLE_COPY(UnionImageProbe)
+};
+
+class ImageFrameReaderPrivate;
+/**
+ * @brief The ImageFrameReader class
+ * 读取多页图/动态图的各帧，整个读取过程共享同一文件映射及解码器。
+ * TIFF 根据帧索引直接定位到指定页；其它格式按顺序读取时从上一帧继续解码，
+ * 依次读取全部帧(如打印多页图)的开销与帧数成线性关系
+ */
+class UNIONIMAGESHARED_EXPORT ImageFrameReader
+{
+public:
+    explicit ImageFrameReader(const QString &path);
+    ~ImageFrameReader();
+
+    /**
+     * @brief frameCount 帧数，同 getFrameCount()
+     */
+    int frameCount() const;
+
+    /**
+     * @brief read 读取第 \a frameIndex 帧
+     * @param[out]  res         图像数据
+     * @param[out]  errorMsg    错误信息
+     * @return 是否读取成功
+     */
+    bool read(int frameIndex, QImage &res, QString &errorMsg);
+
+private:
+    ImageFrameReaderPrivate *const d_ptr;
+    Q_DECLARE_PRIVATE(ImageFrameReader)
+    Q_DISABLE_COPY(ImageFrameReader)
+};
+
 class UnionMovieImagePrivate;
 /**
  * @brief The UnionDynamicImage class
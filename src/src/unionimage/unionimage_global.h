@@ -19,6 +19,15 @@
 #  define IMAGEVIEWERSHARED_EXPORT Q_DECL_IMPORT
 #endif
 
+// 与 unionimage.h 一致，供不包含 unionimage.h 的 unionimage 模块头文件使用
+#ifndef UNIONIMAGESHARED_EXPORT
+#  if defined(UNIONIMAGE_LIBRARY)
+#    define UNIONIMAGESHARED_EXPORT Q_DECL_EXPORT
+#  else
+#    define UNIONIMAGESHARED_EXPORT Q_DECL_IMPORT
+#  endif
+#endif
+
 const QString DATETIME_FORMAT_DATABASE = "yyyy.MM.dd hh:mm";
 
 //相册的define
@@ -96,6 +105,8 @@ struct DBImgInfo {
     QDateTime importTime;  // 导入时间 Or 删除时间
     QString albumUID = "-1";      // 图片所属相册UID，以","分隔，用于恢复
     QString pathHash;      // 用于应付频繁的hash，但不一定每个DBImgInfo都装载了它
+    qint64 fileSize = 0;       // 文件大小
+    quint64 contentHash = 0;   // 文件内容标识(首尾数据块哈希)，与 fileSize 共同查找内容相同的文件，0 表示未计算
     ItemType itemType = ItemTypePic;//类型，空白，图片，视频
 
     //显示
@@ -170,6 +181,32 @@ Q_DECLARE_METATYPE(DBImgInfo)
 
 typedef QList<DBImgInfo> DBImgInfoList;
 
+//文件格式嗅探缓存，以(路径, 修改时间, 文件大小)判断缓存是否有效
+//-1表示对应项尚未嗅探
+struct FormatCacheInfo {
+    QString filePath;
+    qint64 modifyTime = 0;  // 文件修改时间(ms)
+    qint64 fileSize = 0;
+    QString format;         // 按内容嗅探得到的mime类型
+    int imageType = -1;     // imageViewerSpace::ImageType
+    int frameCount = -1;
+    int isImage = -1;
+    int isVideo = -1;
+    QByteArray frameIndex;  // 序列化的多页图/动态图帧索引，为空表示尚未扫描
+};
+typedef QList<FormatCacheInfo> FormatCacheInfoList;
+
+//导入任务记录，导入中断后按记录恢复，已提交的批次不再重复解析
+struct ImportJobInfo {
+    int jobID = -1;
+    int UID = -1;
+    QStringList sources;    // 导入的文件/文件夹路径
+    bool checkRepeat = true;
+    int cursor = 0;         // 已提交的文件数
+    int batchID = 0;        // 最后提交的批次号
+};
+typedef QList<ImportJobInfo> ImportJobInfoList;
+
 enum OpenImgViewType {
     VIEW_MAINWINDOW_ALLPIC = 0,
     VIEW_MAINWINDOW_TIMELINE = 1,
@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "unionimage/dirwalker.h"
+
+using namespace LibUnionImage_NameSpace;
+
+/**
+   @brief 创建文件 \a path ，上级目录不存在时一并创建
+ */
+static void createFile(const QString &path)
+{
+    ASSERT_TRUE(QDir().mkpath(QFileInfo(path).absolutePath()));
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+}
+
+/**
+   @brief 将目录 \a path 的修改时间设为一小时前，快照中记录为可信的修改时间
+ */
+static void ageDirectory(const QString &path)
+{
+    struct timespec times[2];
+    ::clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[0].tv_sec -= 3600;
+    times[1] = times[0];
+    ASSERT_EQ(0, ::utimensat(AT_FDCWD, QFile::encodeName(path).constData(), times, 0));
+}
+
+static DirSnapshotEntry snapshotEntry(qint64 modifyTime)
+{
+    DirSnapshotEntry entry;
+    entry.modifyTime = modifyTime;
+    return entry;
+}
+
+static QSet<QString> toSet(const QStringList &list)
+{
+    return QSet<QString>(list.begin(), list.end());
+}
+
+class tst_DirWalker : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        root = dir.path();
+        for (const QString &name : { "a.jpg", "b.txt", ".hidden.jpg", "sub/c.png", "sub/deep/d.jpg", ".hiddendir/e.jpg" }) {
+            createFile(path(name));
+        }
+    }
+
+    QString path(const QString &name) const
+    {
+        return root + '/' + name;
+    }
+
+    QSet<QString> paths(const QStringList &names) const
+    {
+        QSet<QString> result;
+        for (const QString &name : names) {
+            result.insert(path(name));
+        }
+        return result;
+    }
+
+    QTemporaryDir dir;
+    QString root;
+};
+
+TEST_F(tst_DirWalker, walkRecursive)
+{
+    // 不含隐藏文件及隐藏目录，返回绝对路径
+    const QStringList files = walkFiles(root);
+    EXPECT_EQ(4, files.size());
+    EXPECT_EQ(paths({ "a.jpg", "b.txt", "sub/c.png", "sub/deep/d.jpg" }), toSet(files));
+
+    // 根目录末尾的分隔符不影响结果
+    EXPECT_EQ(toSet(files), toSet(walkFiles(root + '/')));
+}
+
+TEST_F(tst_DirWalker, walkWithFilter)
+{
+    const QStringList files = walkFiles(root, [](const QString &fileName) {
+        return fileName.endsWith(".jpg");
+    });
+    EXPECT_EQ(paths({ "a.jpg", "sub/deep/d.jpg" }), toSet(files));
+}
+
+TEST_F(tst_DirWalker, walkNonRecursive)
+{
+    EXPECT_EQ(paths({ "a.jpg", "b.txt" }), toSet(walkFiles(root, WalkFilter(), false)));
+}
+
+TEST_F(tst_DirWalker, walkSymlinks)
+{
+    // 链接至文件的符号链接按文件返回，链接至目录(含循环链接)及失效的符号链接均跳过
+    ASSERT_TRUE(QFile::link(path("a.jpg"), path("link.jpg")));
+    ASSERT_TRUE(QFile::link(path("sub"), path("linkdir")));
+    ASSERT_TRUE(QFile::link(root, path("sub/loop")));
+    ASSERT_TRUE(QFile::link(path("missing.jpg"), path("broken.jpg")));
+
+    EXPECT_EQ(paths({ "a.jpg", "b.txt", "link.jpg", "sub/c.png", "sub/deep/d.jpg" }), toSet(walkFiles(root)));
+}
+
+TEST_F(tst_DirWalker, walkMissingDirectory)
+{
+    EXPECT_TRUE(walkFiles(path("missing")).isEmpty());
+}
+
+TEST_F(tst_DirWalker, mediaFileName)
+{
+    EXPECT_TRUE(isMediaFileName("a.jpg"));
+    EXPECT_TRUE(isMediaFileName("a.JPG"));
+    EXPECT_TRUE(isMediaFileName("a.b.png"));
+    EXPECT_TRUE(isMediaFileName("a.mp4"));
+    EXPECT_FALSE(isMediaFileName("a.txt"));
+    EXPECT_FALSE(isMediaFileName("a.x3f"));
+    EXPECT_FALSE(isMediaFileName(".jpg"));
+    EXPECT_FALSE(isMediaFileName("jpg"));
+
+    EXPECT_EQ(paths({ "a.jpg", "sub/c.png", "sub/deep/d.jpg" }), toSet(walkMediaFiles(root)));
+}
+
+TEST_F(tst_DirWalker, walkBatched)
+{
+    // 文件数超过单批数量，分散在多个目录中由多个线程遍历
+    for (int i = 0; i < 600; ++i) {
+        createFile(path(QString("batch/%1/%2.jpg").arg(i % 3).arg(i)));
+    }
+
+    QMutex mutex;
+    QStringList files;
+    const bool finished = walkFilesBatched(root, WalkFilter(), [&](const QStringList &batch) {
+        QMutexLocker locker(&mutex);
+        files << batch;
+        return true;
+    });
+    EXPECT_TRUE(finished);
+
+    // 每个文件仅交付一次，与一次性遍历结果一致
+    const QStringList all = walkFiles(root);
+    EXPECT_EQ(604, all.size());
+    EXPECT_EQ(all.size(), files.size());
+    EXPECT_EQ(toSet(all), toSet(files));
+}
+
+TEST_F(tst_DirWalker, cancelBatched)
+{
+    for (int i = 0; i < 1000; ++i) {
+        createFile(path(QString("batch/%1.jpg").arg(i)));
+    }
+
+    int calls = 0;
+    const bool finished = walkFilesBatched(root, WalkFilter(), [&calls](const QStringList &) {
+        ++calls;
+        return false;
+    });
+    EXPECT_FALSE(finished);
+    EXPECT_EQ(1, calls);
+}
+
+TEST_F(tst_DirWalker, recordSnapshot)
+{
+    for (const QString &name : { "", "sub", "sub/deep" }) {
+        ageDirectory(path(name));
+    }
+
+    DirSnapshot current;
+    ASSERT_TRUE(walkFilesBatched(root, WalkFilter(), [](const QStringList &) { return true; }, true, nullptr, &current));
+
+    // 键为相对根目录的路径，不含隐藏目录
+    EXPECT_EQ(QSet<QString>({ "", "/sub", "/sub/deep" }), QSet<QString>(current.keyBegin(), current.keyEnd()));
+    EXPECT_EQ(QSet<QString>({ "a.jpg", "b.txt" }), toSet(current.value("").files));
+    EXPECT_EQ(QStringList({ "sub" }), current.value("").subDirs);
+    EXPECT_EQ(QStringList({ "d.jpg" }), current.value("/sub/deep").files);
+    for (const DirSnapshotEntry &entry : current) {
+        EXPECT_NE(0, entry.modifyTime);
+    }
+
+    // 刚修改过的目录记录为 0 ，下次必然重新读取
+    createFile(path("sub/deep/f.jpg"));
+    DirSnapshot next;
+    ASSERT_TRUE(walkFilesBatched(root, WalkFilter(), [](const QStringList &) { return true; }, true, &current, &next));
+    EXPECT_EQ(0, next.value("/sub/deep").modifyTime);
+    EXPECT_EQ(QSet<QString>({ "d.jpg", "f.jpg" }), toSet(next.value("/sub/deep").files));
+    EXPECT_EQ(current.value("").modifyTime, next.value("").modifyTime);
+}
+
+TEST_F(tst_DirWalker, reuseUnchangedSnapshot)
+{
+    for (const QString &name : { "", "sub", "sub/deep" }) {
+        ageDirectory(path(name));
+    }
+    DirSnapshot previous;
+    ASSERT_TRUE(walkFilesBatched(root, WalkFilter(), [](const QStringList &) { return true; }, true, nullptr, &previous));
+
+    // 修改时间未变的目录不读取目录项，快照中的记录原样返回
+    previous[""].files << "ghost.jpg";
+    previous["/sub"].modifyTime += 1;
+    previous["/sub"].files << "changed.jpg";
+
+    QStringList files;
+    DirSnapshot current;
+    ASSERT_TRUE(walkFilesBatched(root, WalkFilter(), [&files](const QStringList &batch) {
+        files << batch;
+        return true;
+    }, true, &previous, &current));
+    EXPECT_EQ(paths({ "a.jpg", "b.txt", "ghost.jpg", "sub/c.png", "sub/deep/d.jpg" }), toSet(files));
+    EXPECT_TRUE(current.value("").files.contains("ghost.jpg"));
+    EXPECT_FALSE(current.value("/sub").files.contains("changed.jpg"));
+}
+
+TEST_F(tst_DirWalker, diffSnapshot)
+{
+    DirSnapshot previous;
+    previous.insert("", snapshotEntry(100));
+    previous.insert("/same", snapshotEntry(200));
+    previous.insert("/changed", snapshotEntry(300));
+    previous.insert("/racy", snapshotEntry(0));
+
+    DirSnapshot current = previous;
+    QSet<QString> changedDirs;
+    QSet<QString> currentDirs;
+    // 刚修改过的目录(修改时间为 0)始终视为变化
+    EXPECT_TRUE(diffDirSnapshot(root, previous, current, changedDirs, currentDirs));
+    EXPECT_EQ(paths({ "racy" }), changedDirs);
+    EXPECT_EQ(paths({ "same", "changed", "racy" }) + QSet<QString>({ root }), currentDirs);
+
+    previous["/racy"].modifyTime = 400;
+    current["/racy"].modifyTime = 400;
+    changedDirs.clear();
+    currentDirs.clear();
+    EXPECT_FALSE(diffDirSnapshot(root, previous, current, changedDirs, currentDirs));
+    EXPECT_TRUE(changedDirs.isEmpty());
+    EXPECT_EQ(4, currentDirs.size());
+
+    // 修改时间变化及新增的目录需要比较，删除的目录仅体现在返回值中
+    current["/changed"].modifyTime = 301;
+    current.insert("/added", snapshotEntry(500));
+    current.remove("/same");
+    changedDirs.clear();
+    currentDirs.clear();
+    EXPECT_TRUE(diffDirSnapshot(root + '/', previous, current, changedDirs, currentDirs));
+    EXPECT_EQ(paths({ "changed", "added" }), changedDirs);
+    EXPECT_FALSE(currentDirs.contains(path("same")));
+    EXPECT_TRUE(currentDirs.contains(root));
+
+    current = previous;
+    current.remove("/same");
+    changedDirs.clear();
+    currentDirs.clear();
+    EXPECT_TRUE(diffDirSnapshot(root, previous, current, changedDirs, currentDirs));
+    EXPECT_TRUE(changedDirs.isEmpty());
+}
+
+TEST_F(tst_DirWalker, diffSnapshotAtFileSystemRoot)
+{
+    DirSnapshot current;
+    current.insert("", snapshotEntry(0));
+    current.insert("/media", snapshotEntry(0));
+
+    QSet<QString> changedDirs;
+    QSet<QString> currentDirs;
+    EXPECT_TRUE(diffDirSnapshot("/", DirSnapshot(), current, changedDirs, currentDirs));
+    EXPECT_EQ(QSet<QString>({ "/", "/media" }), changedDirs);
+    EXPECT_EQ(changedDirs, currentDirs);
+}
+
+TEST_F(tst_DirWalker, snapshotStream)
+{
+    DirSnapshotEntry entry;
+    entry.modifyTime = 123456789;
+    entry.files = QStringList({ "a.jpg", "b.png" });
+    entry.subDirs = QStringList({ "sub" });
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << entry;
+
+    DirSnapshotEntry read;
+    QDataStream in(data);
+    in >> read;
+    EXPECT_EQ(QDataStream::Ok, in.status());
+    EXPECT_EQ(entry.modifyTime, read.modifyTime);
+    EXPECT_EQ(entry.files, read.files);
+    EXPECT_EQ(entry.subDirs, read.subDirs);
+}
+
+int main(int argc, char *argv[])
+{
+    // 媒体文件扩展名列表依赖图像格式插件
+    QCoreApplication app(argc, argv);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,330 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QDebug>
+
+#include "unionimage/exifparser.h"
+
+using namespace LibUnionImage_NameSpace;
+
+// 构造的 TIFF 数据布局(相对 TIFF 头的偏移)
+static const int s_ifd0Offset = 8;           // IFD0 ，包含 4 个字段
+static const int s_makeEntry = 10;           // Make 字段
+static const int s_exifPointerEntry = 46;    // Exif IFD 指针字段
+static const int s_makeValue = 62;           // Make 字段值 "Canon"
+static const int s_exifIfdOffset = 68;       // Exif IFD ，包含 1 个字段
+static const int s_dateEntry = 70;           // DateTimeOriginal 字段
+
+/**
+   @brief 按字节序 \a bigEndian 写入 TIFF 数据的辅助类
+ */
+class TiffWriter
+{
+public:
+    explicit TiffWriter(bool bigEndian)
+        : bigEndian(bigEndian)
+    {
+    }
+
+    void put16(int offset, quint16 value)
+    {
+        ensure(offset + 2);
+        data[offset + (bigEndian ? 0 : 1)] = char(value >> 8);
+        data[offset + (bigEndian ? 1 : 0)] = char(value & 0xFF);
+    }
+
+    void put32(int offset, quint32 value)
+    {
+        put16(offset + (bigEndian ? 0 : 2), quint16(value >> 16));
+        put16(offset + (bigEndian ? 2 : 0), quint16(value & 0xFFFF));
+    }
+
+    void putBytes(int offset, const QByteArray &bytes)
+    {
+        ensure(offset + bytes.size());
+        data.replace(offset, bytes.size(), bytes);
+    }
+
+    void putEntry(int offset, quint16 tag, quint16 type, quint32 count, quint32 value)
+    {
+        put16(offset, tag);
+        put16(offset + 2, type);
+        put32(offset + 4, count);
+        if (3 == type && 1 == count) {
+            put16(offset + 8, quint16(value));
+            put16(offset + 10, 0);
+        } else {
+            put32(offset + 8, value);
+        }
+    }
+
+    bool bigEndian;
+    QByteArray data;
+
+private:
+    void ensure(int size)
+    {
+        if (data.size() < size) {
+            data.append(QByteArray(size - data.size(), '\0'));
+        }
+    }
+};
+
+/**
+   @return 构造包含 Make 、Model 、Orientation 及 Exif IFD(DateTimeOriginal) 的 TIFF 数据
+ */
+static QByteArray createTiff(bool bigEndian)
+{
+    TiffWriter writer(bigEndian);
+    writer.putBytes(0, bigEndian ? QByteArray("MM", 2) : QByteArray("II", 2));
+    writer.put16(2, 42);
+    writer.put32(4, s_ifd0Offset);
+
+    writer.put16(s_ifd0Offset, 4);
+    writer.putEntry(s_makeEntry, 0x010F, 2, 6, s_makeValue);
+    // Model 不超过 4 字节，直接存储在字段中
+    writer.putEntry(s_makeEntry + 12, 0x0110, 2, 3, 0);
+    writer.putBytes(s_makeEntry + 12 + 8, QByteArray("R5\0", 3));
+    writer.putEntry(s_makeEntry + 24, 0x0112, 3, 1, 6);
+    writer.putEntry(s_exifPointerEntry, 0x8769, 4, 1, s_exifIfdOffset);
+    writer.put32(s_exifPointerEntry + 12, 0);
+    writer.putBytes(s_makeValue, QByteArray("Canon\0", 6));
+
+    const int dateValue = s_dateEntry + 12 + 4;
+    writer.put16(s_exifIfdOffset, 1);
+    writer.putEntry(s_dateEntry, 0x9003, 2, 20, dateValue);
+    writer.put32(s_dateEntry + 12, 0);
+    writer.putBytes(dateValue, QByteArray("2023:05:06 07:08:09\0", 20));
+    return writer.data;
+}
+
+/**
+   @return 将 TIFF 数据 \a tiff 包装为 JPEG 文件数据(SOI + JFIF APP0 + Exif APP1 + SOS + EOI)
+ */
+static QByteArray wrapJpeg(const QByteArray &tiff)
+{
+    QByteArray data("\xFF\xD8", 2);
+    data.append(QByteArray("\xFF\xE0\x00\x10JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00", 18));
+
+    const int length = 2 + 6 + tiff.size();
+    data.append("\xFF\xE1", 2);
+    data.append(char(length >> 8));
+    data.append(char(length & 0xFF));
+    data.append(QByteArray("Exif\0\0", 6));
+    data.append(tiff);
+
+    data.append(QByteArray("\xFF\xDA\x00\x02\x11\x22\xFF\xD9", 8));
+    return data;
+}
+
+static void expectFullInfo(const ExifInfo &info)
+{
+    EXPECT_TRUE(info.valid);
+    EXPECT_EQ(6, info.orientation);
+    EXPECT_EQ(QString("Canon"), info.make);
+    EXPECT_EQ(QString("R5"), info.model);
+    EXPECT_EQ(QDateTime(QDate(2023, 5, 6), QTime(7, 8, 9)), info.dateTimeOriginal);
+}
+
+class tst_ExifParser : public testing::Test
+{
+};
+
+TEST_F(tst_ExifParser, parseTiffBothByteOrders)
+{
+    expectFullInfo(ExifParser::parse(createTiff(true)));
+    expectFullInfo(ExifParser::parse(createTiff(false)));
+}
+
+TEST_F(tst_ExifParser, parseJpeg)
+{
+    expectFullInfo(ExifParser::parse(wrapJpeg(createTiff(true))));
+    expectFullInfo(ExifParser::parse(wrapJpeg(createTiff(false))));
+}
+
+TEST_F(tst_ExifParser, parseDeviceRestoresPosition)
+{
+    QByteArray data = wrapJpeg(createTiff(false));
+    QBuffer buffer(&data);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    ASSERT_TRUE(buffer.seek(5));
+
+    expectFullInfo(ExifParser::parseDevice(&buffer));
+    EXPECT_EQ(5, buffer.pos());
+}
+
+TEST_F(tst_ExifParser, rejectInvalidDevice)
+{
+    EXPECT_FALSE(ExifParser::parseDevice(nullptr).valid);
+
+    QBuffer closed;
+    EXPECT_FALSE(ExifParser::parseDevice(&closed).valid);
+}
+
+TEST_F(tst_ExifParser, truncatedData)
+{
+    // 任意位置截断的数据均不应越界访问，截断位置之前的字段仍可解析
+    const QByteArray tiff = createTiff(true);
+    const QByteArray jpeg = wrapJpeg(tiff);
+    for (int size = 0; size <= jpeg.size(); ++size) {
+        ExifInfo info = ExifParser::parse(jpeg.left(size));
+        EXPECT_GE(info.orientation, 1);
+        EXPECT_LE(info.orientation, 8);
+    }
+    for (int size = 0; size <= tiff.size(); ++size) {
+        ExifInfo info = ExifParser::parse(tiff.left(size));
+        EXPECT_GE(info.orientation, 1);
+        EXPECT_LE(info.orientation, 8);
+    }
+
+    // 截断在 Exif IFD 之前时，IFD0 的字段不受影响
+    ExifInfo info = ExifParser::parse(tiff.left(s_exifIfdOffset));
+    EXPECT_EQ(6, info.orientation);
+    EXPECT_EQ(QString("Canon"), info.make);
+    EXPECT_FALSE(info.dateTimeOriginal.isValid());
+}
+
+TEST_F(tst_ExifParser, malformedEntries)
+{
+    for (bool bigEndian : { true, false }) {
+        // 字段数量远超数据长度
+        TiffWriter count(bigEndian);
+        count.data = createTiff(bigEndian);
+        count.put16(s_ifd0Offset, 0xFFFF);
+        EXPECT_EQ(6, ExifParser::parse(count.data).orientation);
+
+        // IFD0 偏移越界
+        TiffWriter ifd(bigEndian);
+        ifd.data = createTiff(bigEndian);
+        ifd.put32(4, 0xFFFFFFF0);
+        EXPECT_EQ(1, ExifParser::parse(ifd.data).orientation);
+        EXPECT_TRUE(ExifParser::parse(ifd.data).make.isEmpty());
+
+        // 字段值数量溢出，该字段被忽略，其余字段正常解析
+        TiffWriter overflow(bigEndian);
+        overflow.data = createTiff(bigEndian);
+        overflow.put32(s_makeEntry + 4, 0xFFFFFFFF);
+        ExifInfo info = ExifParser::parse(overflow.data);
+        EXPECT_TRUE(info.make.isEmpty());
+        EXPECT_EQ(6, info.orientation);
+
+        // 字段值偏移越界
+        TiffWriter value(bigEndian);
+        value.data = createTiff(bigEndian);
+        value.put32(s_dateEntry + 8, 0x7FFFFFFF);
+        EXPECT_FALSE(ExifParser::parse(value.data).dateTimeOriginal.isValid());
+
+        // 不支持的数据类型
+        TiffWriter type(bigEndian);
+        type.data = createTiff(bigEndian);
+        type.put16(s_makeEntry + 2, 0x00EE);
+        EXPECT_TRUE(ExifParser::parse(type.data).make.isEmpty());
+
+        // 方向值超出范围时使用默认方向
+        TiffWriter orientation(bigEndian);
+        orientation.data = createTiff(bigEndian);
+        orientation.put16(s_makeEntry + 24 + 8, 9);
+        EXPECT_EQ(1, ExifParser::parse(orientation.data).orientation);
+    }
+}
+
+TEST_F(tst_ExifParser, loopingIfds)
+{
+    for (bool bigEndian : { true, false }) {
+        // Exif IFD 指针指向 IFD0 自身
+        TiffWriter self(bigEndian);
+        self.data = createTiff(bigEndian);
+        self.put32(s_exifPointerEntry + 8, s_ifd0Offset);
+        ExifInfo info = ExifParser::parse(self.data);
+        EXPECT_EQ(6, info.orientation);
+        EXPECT_FALSE(info.dateTimeOriginal.isValid());
+
+        // IFD0 及 Exif IFD 的下一 IFD 指针相互指向，解析不跟随 IFD 链
+        TiffWriter cycle(bigEndian);
+        cycle.data = createTiff(bigEndian);
+        cycle.put32(s_exifPointerEntry + 12, s_exifIfdOffset);
+        cycle.put32(s_dateEntry + 12, s_ifd0Offset);
+        expectFullInfo(ExifParser::parse(cycle.data));
+
+        // IFD0 偏移指向 TIFF 头内部
+        TiffWriter header(bigEndian);
+        header.data = createTiff(bigEndian);
+        header.put32(4, 0);
+        EXPECT_EQ(1, ExifParser::parse(header.data).orientation);
+    }
+}
+
+TEST_F(tst_ExifParser, malformedJpegSegments)
+{
+    // 数据段长度小于 2
+    QByteArray shortSegment("\xFF\xD8\xFF\xE1\x00\x01", 6);
+    EXPECT_FALSE(ExifParser::parse(shortSegment).valid);
+
+    // 数据段长度超出文件
+    QByteArray longSegment("\xFF\xD8\xFF\xE1\xFF\xFF" "Exif\0\0", 12);
+    EXPECT_FALSE(ExifParser::parse(longSegment).valid);
+
+    // 大量填充字节
+    QByteArray fill("\xFF\xD8", 2);
+    fill.append(QByteArray(4096, '\xFF'));
+    EXPECT_FALSE(ExifParser::parse(fill).valid);
+
+    // 数据段标记缺失
+    QByteArray noMarker("\xFF\xD8\x00\x00\x00\x00", 6);
+    EXPECT_FALSE(ExifParser::parse(noMarker).valid);
+
+    // 非 Exif 的 APP1 数据段(如 XMP)之后的 Exif 数据段
+    QByteArray xmp("\xFF\xD8\xFF\xE1\x00\x06http", 10);
+    xmp.append(wrapJpeg(createTiff(true)).mid(2));
+    expectFullInfo(ExifParser::parse(xmp));
+
+    // 通过设备读取同样需要处理异常数据段
+    QBuffer buffer(&longSegment);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    EXPECT_FALSE(ExifParser::parseDevice(&buffer).valid);
+}
+
+TEST_F(tst_ExifParser, randomMutation)
+{
+    // 固定随机种子，失败时可复现
+    QRandomGenerator generator(20250101);
+    const QByteArray samples[] = { createTiff(true), createTiff(false), wrapJpeg(createTiff(true)), wrapJpeg(createTiff(false)) };
+
+    for (const QByteArray &sample : samples) {
+        for (int i = 0; i < 5000; ++i) {
+            QByteArray data = sample;
+            const int mutations = 1 + generator.bounded(8);
+            for (int m = 0; m < mutations; ++m) {
+                data[generator.bounded(data.size())] = char(generator.bounded(256));
+            }
+            if (generator.bounded(4) == 0) {
+                data.truncate(generator.bounded(data.size()));
+            }
+
+            ExifInfo info = ExifParser::parse(data);
+            EXPECT_GE(info.orientation, 1);
+            EXPECT_LE(info.orientation, 8);
+
+            QBuffer buffer(&data);
+            ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+            info = ExifParser::parseDevice(&buffer);
+            EXPECT_GE(info.orientation, 1);
+            EXPECT_LE(info.orientation, 8);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
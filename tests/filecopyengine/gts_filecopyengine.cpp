@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTemporaryDir>
+
+#include "imageengine/filecopyengine.h"
+
+/**
+   @brief 创建文件 \a path ，写入 \a size 字节的随机数据
+   @return 写入的数据
+ */
+static QByteArray createFile(const QString &path, int size)
+{
+    QByteArray data(size, '\0');
+    for (int i = 0; i < size; ++i) {
+        data[i] = char(QRandomGenerator::global()->bounded(256));
+    }
+    QFile file(path);
+    EXPECT_TRUE(file.open(QIODevice::WriteOnly));
+    EXPECT_EQ(size, file.write(data));
+    return data;
+}
+
+static QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+static QSet<QString> toSet(const QStringList &list)
+{
+    return QSet<QString>(list.begin(), list.end());
+}
+
+class tst_FileCopyEngine : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(sourceDir.isValid());
+        ASSERT_TRUE(targetDir.isValid());
+    }
+
+    FileCopyEngine::Task task(const QString &name) const
+    {
+        return { sourceDir.filePath(name), targetDir.filePath(name) };
+    }
+
+    QTemporaryDir sourceDir;
+    QTemporaryDir targetDir;
+};
+
+TEST_F(tst_FileCopyEngine, copyFiles)
+{
+    // 空文件、小文件及跨多个首尾校验块的文件
+    const QList<QPair<QString, int>> files = {
+        { "empty.jpg", 0 }, { "small.png", 100 }, { "large.jpg", 300 * 1024 }, { "other.mp4", 70 * 1024 }
+    };
+    QList<FileCopyEngine::Task> tasks;
+    QHash<QString, QByteArray> contents;
+    for (const auto &file : files) {
+        contents.insert(targetDir.filePath(file.first), createFile(sourceDir.filePath(file.first), file.second));
+        tasks << task(file.first);
+    }
+
+    FileCopyEngine engine;
+    engine.setMaxConcurrent(2);
+    qint64 lastCopied = -1;
+    qint64 lastTotal = -1;
+    QObject::connect(&engine, &FileCopyEngine::progressChanged, [&](qint64 copiedBytes, qint64 totalBytes, qint64) {
+        EXPECT_GE(copiedBytes, lastCopied);
+        lastCopied = copiedBytes;
+        lastTotal = totalBytes;
+    });
+
+    const QStringList copied = engine.copy(tasks);
+    EXPECT_EQ(toSet(QStringList(contents.keyBegin(), contents.keyEnd())), toSet(copied));
+    for (const QString &target : copied) {
+        EXPECT_EQ(contents.value(target), readFile(target)) << target.toStdString();
+    }
+
+    // 结束时汇报的进度为全部数据
+    const qint64 total = 300 * 1024 + 70 * 1024 + 100;
+    EXPECT_EQ(total, lastTotal);
+    EXPECT_EQ(total, lastCopied);
+}
+
+TEST_F(tst_FileCopyEngine, renameExistingTarget)
+{
+    const QByteArray data = createFile(sourceDir.filePath("a.jpg"), 1000);
+    const QByteArray existing = createFile(targetDir.filePath("a.jpg"), 10);
+    createFile(targetDir.filePath("noext"), 10);
+    createFile(sourceDir.filePath("noext"), 20);
+
+    // 已有文件不被覆盖，目标文件名追加序号
+    FileCopyEngine engine;
+    QStringList copied = engine.copy({ task("a.jpg"), task("noext") });
+    EXPECT_EQ(QSet<QString>({ targetDir.filePath("a_1.jpg"), targetDir.filePath("noext_1") }), toSet(copied));
+    EXPECT_EQ(existing, readFile(targetDir.filePath("a.jpg")));
+    EXPECT_EQ(data, readFile(targetDir.filePath("a_1.jpg")));
+
+    copied = engine.copy({ task("a.jpg") });
+    EXPECT_EQ(QStringList({ targetDir.filePath("a_2.jpg") }), copied);
+}
+
+TEST_F(tst_FileCopyEngine, skipMissingSource)
+{
+    createFile(sourceDir.filePath("a.jpg"), 1000);
+
+    // 源文件不存在时不创建目标文件，不影响其它文件
+    FileCopyEngine engine;
+    const QStringList copied = engine.copy({ task("missing.jpg"), task("a.jpg") });
+    EXPECT_EQ(QStringList({ targetDir.filePath("a.jpg") }), copied);
+    EXPECT_FALSE(QFile::exists(targetDir.filePath("missing.jpg")));
+
+    EXPECT_TRUE(engine.copy({}).isEmpty());
+}
+
+TEST_F(tst_FileCopyEngine, concurrency)
+{
+    // 并发数按设备自动选择，同一设备结果一致
+    const int concurrent = FileCopyEngine::concurrencyFor(sourceDir.path());
+    EXPECT_GE(concurrent, 1);
+    EXPECT_EQ(concurrent, FileCopyEngine::concurrencyFor(targetDir.path()));
+
+    createFile(sourceDir.filePath("a.jpg"), 1000);
+    FileCopyEngine engine;
+    engine.setMaxConcurrent(0);
+    EXPECT_EQ(QStringList({ targetDir.filePath("a.jpg") }), engine.copy({ task("a.jpg") }));
+}
+
+int main(int argc, char *argv[])
+{
+    // 复制在线程池中执行，进度信号由调用线程发出
+    QCoreApplication app(argc, argv);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
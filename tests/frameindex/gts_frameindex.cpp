@@ -0,0 +1,354 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QImage>
+#include <QImageReader>
+
+#include "unionimage/frameindex.h"
+
+using namespace LibUnionImage_NameSpace;
+
+// 测试 TIFF 每页的 IFD 字段数及大小，每页为 2x2 的 8 位灰度图，条带数据紧跟在 IFD 之后
+static const int s_tiffEntryCount = 8;
+static const int s_tiffIfdSize = 2 + s_tiffEntryCount * 12 + 4;
+static const int s_tiffStripSize = 4;
+static const int s_tiffPageSize = s_tiffIfdSize + s_tiffStripSize;
+
+static void writeTiffEntry(QDataStream &stream, quint16 tag, quint16 type, quint32 value)
+{
+    stream << tag << type << quint32(1);
+    if (3 == type) {
+        // SHORT 类型的值左对齐存储在字段中
+        stream << quint16(value) << quint16(0);
+    } else {
+        stream << value;
+    }
+}
+
+/**
+   @return 页数与 \a grays 相同的 TIFF 文件数据，每页以对应的灰度值填充，\a bigEndian 指定字节序
+ */
+static QByteArray createTiff(const QList<quint8> &grays, bool bigEndian = false)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    stream.writeRawData(bigEndian ? "MM" : "II", 2);
+    stream << quint16(42) << quint32(8);
+
+    for (int i = 0; i < grays.size(); ++i) {
+        const quint32 ifd = quint32(8 + i * s_tiffPageSize);
+        stream << quint16(s_tiffEntryCount);
+        writeTiffEntry(stream, 256, 3, 2);                       // ImageWidth
+        writeTiffEntry(stream, 257, 3, 2);                       // ImageLength
+        writeTiffEntry(stream, 258, 3, 8);                       // BitsPerSample
+        writeTiffEntry(stream, 259, 3, 1);                       // Compression: 无压缩
+        writeTiffEntry(stream, 262, 3, 1);                       // PhotometricInterpretation: 黑色为 0
+        writeTiffEntry(stream, 273, 4, ifd + s_tiffIfdSize);     // StripOffsets
+        writeTiffEntry(stream, 278, 3, 2);                       // RowsPerStrip
+        writeTiffEntry(stream, 279, 4, s_tiffStripSize);         // StripByteCounts
+        stream << quint32(i + 1 < grays.size() ? ifd + s_tiffPageSize : 0);
+        for (int j = 0; j < s_tiffStripSize; ++j) {
+            stream << grays.at(i);
+        }
+    }
+    return data;
+}
+
+static QList<quint8> pageGrays(int count)
+{
+    QList<quint8> grays;
+    for (int i = 0; i < count; ++i) {
+        grays << quint8(i * 50);
+    }
+    return grays;
+}
+
+/**
+   @return 仅含一个 StripByteCounts(LONG8) 字段的 BigTIFF 文件数据
+   @param ifdOffset 文件头中的 IFD0 偏移
+   @param valueCount 字段值的个数，大于 1 时 \a value 为值数组的偏移
+   @param next 下一个 IFD 的偏移
+ */
+static QByteArray createBigTiff(quint64 ifdOffset, quint64 valueCount, quint64 value, quint64 next)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("II", 2);
+    stream << quint16(43) << quint16(8) << quint16(0) << ifdOffset;
+    stream << quint64(1) << quint16(279) << quint16(16) << valueCount << value << next;
+    return data;
+}
+
+/**
+   @return GIF 文件数据，\a delays 为每帧的显示时长(1/100 s)，小于 0 时该帧无图形控制扩展
+ */
+static QByteArray createGif(const QList<int> &delays, QList<qint64> *offsets = nullptr)
+{
+    QByteArray data("GIF89a");
+    // 逻辑屏幕描述符，含 2 色全局颜色表
+    data.append("\x01\x00\x01\x00\x80\x00\x00", 7);
+    data.append("\x00\x00\x00\xFF\xFF\xFF", 6);
+    // 循环播放的应用扩展
+    data.append("\x21\xFF\x0B" "NETSCAPE2.0" "\x03\x01\x00\x00\x00", 19);
+
+    for (int delay : delays) {
+        if (offsets) {
+            *offsets << data.size();
+        }
+        if (delay >= 0) {
+            data.append("\x21\xF9\x04\x00", 4);
+            data.append(char(delay & 0xFF));
+            data.append(char(delay >> 8));
+            data.append("\x00\x00", 2);
+        }
+        data.append("\x2C\x00\x00\x00\x00\x01\x00\x01\x00\x00", 10);
+        data.append("\x02\x02\x4C\x01\x00", 5);
+    }
+    data.append('\x3B');
+    return data;
+}
+
+static void appendLE32(QByteArray &data, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        data.append(char((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+   @return 动态 WebP 文件数据，\a durations 为每帧的显示时长(ms)，\a payloadSizes 为每帧 ANMF 数据块的大小
+ */
+static QByteArray createAnimatedWebP(const QList<int> &durations, const QList<int> &payloadSizes)
+{
+    QByteArray body("WEBP");
+    body.append("VP8X");
+    appendLE32(body, 10);
+    body.append("\x02\x00\x00\x00\x00\x00\x00\x00\x00\x00", 10);
+    body.append("ANIM");
+    appendLE32(body, 6);
+    body.append(QByteArray(6, '\0'));
+
+    for (int i = 0; i < durations.size(); ++i) {
+        const int size = payloadSizes.at(i);
+        body.append("ANMF");
+        appendLE32(body, quint32(size));
+        QByteArray payload(size, '\0');
+        payload[12] = char(durations.at(i) & 0xFF);
+        payload[13] = char((durations.at(i) >> 8) & 0xFF);
+        body.append(payload);
+        if (size & 1) {
+            body.append('\0');
+        }
+    }
+
+    QByteArray data("RIFF");
+    appendLE32(data, quint32(body.size()));
+    return data + body;
+}
+
+class tst_FrameIndex : public testing::Test
+{
+};
+
+TEST_F(tst_FrameIndex, buildTiff)
+{
+    for (bool bigEndian : { false, true }) {
+        const QByteArray data = createTiff(pageGrays(4), bigEndian);
+        ASSERT_TRUE(FrameIndex::isTiff(data));
+
+        const FrameIndexList frames = FrameIndex::build(data);
+        ASSERT_EQ(4, frames.size()) << "bigEndian:" << bigEndian;
+        for (int i = 0; i < frames.size(); ++i) {
+            EXPECT_EQ(8 + i * s_tiffPageSize, frames.at(i).offset);
+            EXPECT_EQ(s_tiffStripSize, frames.at(i).size);
+            EXPECT_EQ(0, frames.at(i).delay);
+        }
+    }
+}
+
+TEST_F(tst_FrameIndex, readTiffFrame)
+{
+    if (!QImageReader::supportedImageFormats().contains("tiff")) {
+        GTEST_SKIP() << "tiff image plugin not available";
+    }
+
+    // 根据索引直接读取指定页，与逐页读取的结果一致
+    const QList<quint8> grays = pageGrays(3);
+    for (bool bigEndian : { false, true }) {
+        const QByteArray data = createTiff(grays, bigEndian);
+        const FrameIndexList frames = FrameIndex::build(data);
+        ASSERT_EQ(grays.size(), frames.size());
+        for (int i = grays.size() - 1; i >= 0; --i) {
+            QImage image;
+            ASSERT_TRUE(FrameIndex::readTiffFrame(data, frames.at(i), image)) << "page:" << i;
+            EXPECT_EQ(QSize(2, 2), image.size());
+            EXPECT_EQ(grays.at(i), qGray(image.pixel(1, 1))) << "page:" << i << "bigEndian:" << bigEndian;
+        }
+    }
+
+    QImage image;
+    FrameIndexEntry invalid;
+    invalid.offset = createTiff(grays).size();
+    EXPECT_FALSE(FrameIndex::readTiffFrame(createTiff(grays), invalid, image));
+}
+
+TEST_F(tst_FrameIndex, maxFrames)
+{
+    const QByteArray tiff = createTiff(pageGrays(5));
+    EXPECT_EQ(5, FrameIndex::build(tiff).size());
+    EXPECT_EQ(2, FrameIndex::build(tiff, 2).size());
+    EXPECT_EQ(1, FrameIndex::build(tiff, 1).size());
+
+    const QByteArray gif = createGif({ 10, 10, 10, 10 });
+    EXPECT_EQ(4, FrameIndex::build(gif).size());
+    EXPECT_EQ(2, FrameIndex::build(gif, 2).size());
+
+    const QByteArray webp = createAnimatedWebP({ 40, 40, 40 }, { 16, 16, 16 });
+    EXPECT_EQ(3, FrameIndex::build(webp).size());
+    EXPECT_EQ(2, FrameIndex::build(webp, 2).size());
+}
+
+TEST_F(tst_FrameIndex, tiffLoopAndTruncation)
+{
+    // IFD 链表循环指向首页时停止
+    QByteArray data = createTiff(pageGrays(3));
+    const int lastNext = 8 + 2 * s_tiffPageSize + 2 + s_tiffEntryCount * 12;
+    data[lastNext] = char(8);
+    EXPECT_EQ(3, FrameIndex::build(data).size());
+
+    // 数据截断时仅索引完整的 IFD
+    EXPECT_EQ(1, FrameIndex::build(createTiff(pageGrays(3)).left(8 + s_tiffPageSize + 4)).size());
+    EXPECT_TRUE(FrameIndex::build(createTiff(pageGrays(3)).left(8)).isEmpty());
+}
+
+TEST_F(tst_FrameIndex, bigTiff)
+{
+    // IFD0 位于文件头之后，下一个 IFD 偏移为 0
+    const QByteArray data = createBigTiff(16, 1, 5000, 0);
+    ASSERT_TRUE(FrameIndex::isTiff(data));
+    FrameIndexList frames = FrameIndex::build(data);
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(16, frames.first().offset);
+    EXPECT_EQ(5000, frames.first().size);
+}
+
+TEST_F(tst_FrameIndex, bigTiffOffsetOverflow)
+{
+    // 64 位偏移接近上限，与长度相加或转换为有符号数时溢出，应视为无效而不越界访问
+    EXPECT_TRUE(FrameIndex::build(createBigTiff(0xFFFFFFFFFFFFFFF0ULL, 1, 0, 0)).isEmpty());
+    EXPECT_TRUE(FrameIndex::build(createBigTiff(0x8000000000000000ULL, 1, 0, 0)).isEmpty());
+
+    // 字段值数组的偏移溢出时该页数据大小为 0
+    FrameIndexList frames = FrameIndex::build(createBigTiff(16, 2, 0xFFFFFFFFFFFFFFF8ULL, 0));
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(0, frames.first().size);
+
+    // 字段值个数过大
+    frames = FrameIndex::build(createBigTiff(16, 0x2000000000000000ULL, 16, 0));
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(0, frames.first().size);
+
+    // 下一个 IFD 的偏移溢出时停止
+    EXPECT_EQ(1, FrameIndex::build(createBigTiff(16, 1, 100, 0xFFFFFFFFFFFFFFFFULL)).size());
+}
+
+TEST_F(tst_FrameIndex, buildGif)
+{
+    QList<qint64> offsets;
+    const QByteArray data = createGif({ 5, -1, 12 }, &offsets);
+    const FrameIndexList frames = FrameIndex::build(data);
+    ASSERT_EQ(3, frames.size());
+
+    // 帧从图形控制扩展开始，无图形控制扩展时从图像描述符开始
+    EXPECT_EQ(offsets.at(0), frames.at(0).offset);
+    EXPECT_EQ(offsets.at(1), frames.at(1).offset);
+    EXPECT_EQ(offsets.at(2), frames.at(2).offset);
+    EXPECT_EQ(offsets.at(1) - offsets.at(0), frames.at(0).size);
+    EXPECT_EQ(50, frames.at(0).delay);
+    EXPECT_EQ(0, frames.at(1).delay);
+    EXPECT_EQ(120, frames.at(2).delay);
+
+    // 数据截断时仅索引完整的帧
+    EXPECT_EQ(2, FrameIndex::build(data.left(int(offsets.at(2)) + 12)).size());
+}
+
+TEST_F(tst_FrameIndex, buildWebP)
+{
+    // 奇数大小的数据块后有填充字节
+    const QByteArray data = createAnimatedWebP({ 40, 300 }, { 17, 20 });
+    const FrameIndexList frames = FrameIndex::build(data);
+    ASSERT_EQ(2, frames.size());
+    EXPECT_EQ(8 + 17, frames.at(0).size);
+    EXPECT_EQ(frames.at(0).offset + 8 + 18, frames.at(1).offset);
+    EXPECT_EQ(40, frames.at(0).delay);
+    EXPECT_EQ(300, frames.at(1).delay);
+
+    // 静态 WebP 无帧索引
+    QByteArray still("RIFF");
+    appendLE32(still, 4 + 8 + 10);
+    still.append("WEBPVP8 ");
+    appendLE32(still, 10);
+    still.append(QByteArray(10, '\0'));
+    EXPECT_TRUE(FrameIndex::build(still).isEmpty());
+}
+
+TEST_F(tst_FrameIndex, unsupportedData)
+{
+    EXPECT_TRUE(FrameIndex::build(QByteArray()).isEmpty());
+    EXPECT_TRUE(FrameIndex::build(QByteArray("\x89PNG\r\n\x1A\n", 8)).isEmpty());
+    EXPECT_FALSE(FrameIndex::isTiff(QByteArray("II*")));
+}
+
+TEST_F(tst_FrameIndex, serialize)
+{
+    // 空索引同样生成数据，用于标记文件已扫描
+    const QByteArray empty = FrameIndex::serialize(FrameIndexList());
+    EXPECT_FALSE(empty.isEmpty());
+    EXPECT_TRUE(FrameIndex::deserialize(empty).isEmpty());
+
+    const FrameIndexList frames = FrameIndex::build(createGif({ 5, 7, 9 }));
+    const FrameIndexList restored = FrameIndex::deserialize(FrameIndex::serialize(frames));
+    ASSERT_EQ(frames.size(), restored.size());
+    for (int i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(frames.at(i).offset, restored.at(i).offset);
+        EXPECT_EQ(frames.at(i).size, restored.at(i).size);
+        EXPECT_EQ(frames.at(i).delay, restored.at(i).delay);
+    }
+}
+
+TEST_F(tst_FrameIndex, deserializeInvalid)
+{
+    const QByteArray data = FrameIndex::serialize(FrameIndex::build(createGif({ 5, 7, 9 })));
+
+    // 截断的数据
+    EXPECT_TRUE(FrameIndex::deserialize(data.left(data.size() - 1)).isEmpty());
+    EXPECT_TRUE(FrameIndex::deserialize(QByteArray()).isEmpty());
+
+    // 版本不匹配
+    QByteArray version = data;
+    version[3] = char(version.at(3) + 1);
+    EXPECT_TRUE(FrameIndex::deserialize(version).isEmpty());
+
+    // 帧数异常
+    QByteArray count;
+    QDataStream stream(&count, QIODevice::WriteOnly);
+    stream << quint32(1) << qint32(-1);
+    EXPECT_TRUE(FrameIndex::deserialize(count).isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    // 读取 TIFF 页需要加载图像格式插件
+    QCoreApplication app(argc, argv);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
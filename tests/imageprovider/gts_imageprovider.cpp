@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QGuiApplication>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QImage>
+#include <QMap>
+#include <QQuickTextureFactory>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QTimer>
+#include <QTransform>
+#include <QUrl>
+
+#include "imagedata/imageprovider.h"
+#include "imagedata/imagetileprovider.h"
+#include "imagedata/thumbnailcache.h"
+#include "imageengine/imagedataservice.h"
+#include "unionimage/unionimage.h"
+
+/**
+   @return 按文件名生成的测试图像，文件名(去除 "tiled_" 前缀)指定图像格式，未知格式返回空图像
+ */
+static QImage createImage(const QString &path)
+{
+    static const QMap<QString, QImage::Format> s_formats = {
+        { "mono", QImage::Format_Mono },
+        { "indexed8", QImage::Format_Indexed8 },
+        { "grayscale8", QImage::Format_Grayscale8 },
+        { "grayscale16", QImage::Format_Grayscale16 },
+        { "rgb888", QImage::Format_RGB888 },
+        { "rgb32", QImage::Format_RGB32 },
+        { "argb32", QImage::Format_ARGB32 },
+        { "rgba64", QImage::Format_RGBA64 },
+    };
+
+    QString name = QFileInfo(path).completeBaseName();
+    name.remove("tiled_");
+    if (!s_formats.contains(name)) {
+        return QImage();
+    }
+
+    QImage image(64, 48, QImage::Format_RGB32);
+    image.fill(QColor(200, 120, 40));
+    return image.convertToFormat(s_formats.value(name));
+}
+
+// 以下为图像加载器依赖的解码接口，替换为按文件名生成指定格式的图像，模拟解码器返回非显示格式的数据；
+// 显示格式转换 toDisplayFormat 使用 displayformat.cpp 中的实现
+namespace LibUnionImage_NameSpace {
+
+bool loadStaticImageFromFile(const QString &path, QImage &res, QString &errorMsg, const QString &)
+{
+    res = createImage(path);
+    if (res.isNull()) {
+        errorMsg = "unknown test image";
+    }
+    return !res.isNull();
+}
+
+bool loadImageFrame(const QString &path, int, QImage &res, QString &errorMsg)
+{
+    return loadStaticImageFromFile(path, res, errorMsg, QString());
+}
+
+bool rotateImage(int angel, QImage &image)
+{
+    // 旋转后的图像不保证为显示格式
+    image = image.transformed(QTransform().rotate(angel)).convertToFormat(QImage::Format_RGB32);
+    return true;
+}
+
+}  // namespace LibUnionImage_NameSpace
+
+bool ImageTileProvider::isTiledImage(const QString &filePath)
+{
+    return QFileInfo(filePath).completeBaseName().startsWith("tiled_");
+}
+
+QImage ImageTileProvider::readScaledImage(const QString &filePath, const QSize &requestedSize)
+{
+    return createImage(filePath).scaled(requestedSize, Qt::KeepAspectRatio);
+}
+
+// 快速预览仅在缩略图未缓存时使用，测试不涉及，仅用于链接
+ImageDataService *ImageDataService::instance(QObject *)
+{
+    return nullptr;
+}
+
+QString ImageDataService::knownThumbnailPath(const QString &)
+{
+    return QString();
+}
+
+QString ImageDataService::getScaledPath(const QString &)
+{
+    return QString();
+}
+
+static const QStringList s_formatNames = { "mono", "indexed8", "grayscale8", "grayscale16", "rgb888", "rgb32", "argb32", "rgba64" };
+
+/**
+   @return 图像加载器 \a id 对应的测试文件路径 \a name
+ */
+static QString providerId(const QString &name)
+{
+    return QString("file:///tmp/imageprovider/%1.png").arg(name);
+}
+
+/**
+   @return 通过异步加载器 \a provider 请求 \a id 图像，等待应答完成后返回应答中的图像
+ */
+static QImage requestAsync(AsyncImageProvider &provider, const QString &id, const QSize &requestedSize)
+{
+    // 加载任务在线程池中立即执行，先占用线程，保证连接完成信号后才开始加载
+    QSemaphore gate;
+    QThreadPool::globalInstance()->start([&gate]() { gate.acquire(); });
+
+    QQuickImageResponse *response = provider.requestImageResponse(id, requestedSize);
+    bool finished = false;
+    QEventLoop loop;
+    QObject::connect(response, &QQuickImageResponse::finished, &loop, [&]() {
+        finished = true;
+        loop.quit();
+    }, Qt::QueuedConnection);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    gate.release();
+    loop.exec();
+
+    // 应答超时时任务可能仍在执行，不能释放
+    EXPECT_TRUE(finished) << id.toStdString();
+    if (!finished) {
+        return QImage();
+    }
+
+    QImage image;
+    if (QQuickTextureFactory *factory = response->textureFactory()) {
+        image = factory->image();
+        delete factory;
+    }
+    delete response;
+    return image;
+}
+
+class tst_ImageProvider : public testing::Test
+{
+};
+
+TEST_F(tst_ImageProvider, asyncResponseFormat)
+{
+    AsyncImageProvider provider;
+    for (const QString &name : s_formatNames) {
+        const QImage image = requestAsync(provider, providerId(name), QSize());
+        ASSERT_FALSE(image.isNull()) << name.toStdString();
+        EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format()) << name.toStdString();
+        EXPECT_EQ(QSize(64, 48), image.size()) << name.toStdString();
+    }
+}
+
+TEST_F(tst_ImageProvider, asyncScaledAndCachedFormat)
+{
+    AsyncImageProvider provider;
+    const QString id = providerId("indexed8");
+
+    // 按请求大小缩放后的图像
+    QImage image = requestAsync(provider, id, QSize(32, 24));
+    EXPECT_EQ(QSize(32, 24), image.size());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+
+    // 从缓存读取的图像
+    image = requestAsync(provider, id, QSize());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+
+    // 多页图的指定帧
+    image = requestAsync(provider, id + "#frame_2", QSize());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+}
+
+TEST_F(tst_ImageProvider, asyncRotatedFormat)
+{
+    AsyncImageProvider provider;
+    const QString id = providerId("rgb888");
+    ASSERT_FALSE(requestAsync(provider, id, QSize()).isNull());
+
+    // 旋转处理更新缓存后，缓存中的图像不再为显示格式
+    provider.rotateImageCached(90, QUrl(id).toLocalFile());
+    const QImage image = requestAsync(provider, id, QSize());
+    EXPECT_EQ(QSize(48, 64), image.size());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+}
+
+TEST_F(tst_ImageProvider, asyncTiledPreviewFormat)
+{
+    AsyncImageProvider provider;
+    const QImage image = requestAsync(provider, providerId("tiled_grayscale8"), QSize(32, 32));
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+}
+
+TEST_F(tst_ImageProvider, asyncInvalidImage)
+{
+    AsyncImageProvider provider;
+    EXPECT_TRUE(requestAsync(provider, providerId("unknown"), QSize()).isNull());
+}
+
+TEST_F(tst_ImageProvider, syncRequestFormat)
+{
+    ImageProvider provider;
+    for (const QString &name : s_formatNames) {
+        QSize size;
+        const QImage image = provider.requestImage(providerId(name), &size, QSize());
+        ASSERT_FALSE(image.isNull()) << name.toStdString();
+        EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format()) << name.toStdString();
+        EXPECT_EQ(QSize(64, 48), size) << name.toStdString();
+    }
+
+    const QString id = providerId("rgba64");
+    provider.rotateImageCached(90, QUrl(id).toLocalFile());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, provider.requestImage(id, nullptr, QSize()).format());
+}
+
+TEST_F(tst_ImageProvider, cachedThumbnailFormat)
+{
+    // 缩略图缓存中的图像可能来自旋转处理
+    const QString id = providerId("argb32");
+    ThumbnailCache::instance()->add(QUrl(id).toLocalFile(), 0, createImage(id));
+
+    ThumbnailProvider provider;
+    const QImage image = provider.requestImage(id, nullptr, QSize());
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(QImage::Format_ARGB32_Premultiplied, image.format());
+}
+
+int main(int argc, char *argv[])
+{
+    // 纹理工厂依赖 QGuiApplication ，测试环境无显示服务时使用 offscreen 平台
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    // 单线程执行，加载任务排在占用线程的任务之后
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
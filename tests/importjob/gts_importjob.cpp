@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QImage>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QSet>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <csignal>
+
+#include "albumControl.h"
+#include "dbmanager/dbmanager.h"
+#include "dbmanager/importbatch.h"
+#include "unionimage/unionimage.h"
+
+// 子进程参数：提交部分批次后在批次事务中终止自身
+static const QString s_killArg = "--import-until-killed";
+static const int s_fileCount = 14;
+static const int s_batchSize = 4;
+static const int s_committedBatches = 2;  // 子进程终止前完整提交的批次数
+static const QString s_albumName = "Import";
+
+static QString emptyHash()
+{
+    return LibUnionImage_NameSpace::hashByString(QString(" "));
+}
+
+/**
+   @return 目录 \a dir 中的全部图片，按文件名排列
+ */
+static QStringList imagePaths(const QString &dir)
+{
+    QStringList paths;
+    for (const QString &name : QDir(dir).entryList(QDir::Files, QDir::Name)) {
+        paths << QDir(dir).filePath(name);
+    }
+    return paths;
+}
+
+/**
+   @return 执行 \a sql 得到的首个整数值，执行失败时返回 -1 ，DBManager 使用默认数据库连接
+ */
+static int queryInt(const QString &sql)
+{
+    QSqlQuery query;
+    if (!query.exec(sql) || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+static int albumRowCount(int UID)
+{
+    return queryInt(QString("SELECT COUNT(*) FROM AlbumTable3 WHERE UID = %1 AND PathHash != \"%2\"").arg(UID).arg(emptyHash()));
+}
+
+static int imageRowCount(int UID)
+{
+    return queryInt(QString("SELECT COUNT(*) FROM ImageTable3 WHERE UID = \"%1\"").arg(UID));
+}
+
+/**
+   @brief 子进程：与导入线程相同解析并提交 s_committedBatches 个批次，在下一批次写入数据但未提交时终止自身
+ */
+static int importUntilKilled()
+{
+    const ImportJobInfoList jobs = DBManager::instance()->getImportJobs();
+    if (jobs.size() != 1 || jobs.first().sources.isEmpty()) {
+        return 1;
+    }
+
+    const ImportJobInfo job = jobs.first();
+    DBImgInfoList infos;
+    for (const QString &path : imagePaths(job.sources.first())) {
+        DBImgInfo info = AlbumControl::instance()->getDBInfo(path, false);
+        info.albumUID = QString::number(job.UID);
+        infos << info;
+    }
+
+    for (int i = 0; i < s_committedBatches; ++i) {
+        if (!DBManager::instance()->commitImportBatch(job.jobID, i + 1, infos.mid(i * s_batchSize, s_batchSize), job.UID, AutoImport)) {
+            return 1;
+        }
+    }
+
+    const DBImgInfoList batch = infos.mid(s_committedBatches * s_batchSize, s_batchSize);
+    QStringList paths;
+    for (const DBImgInfo &info : batch) {
+        paths << info.filePath;
+    }
+    QSqlQuery query;
+    query.exec("BEGIN IMMEDIATE TRANSACTION");
+    ImportBatch::writeImgInfos(query, batch);
+    ImportBatch::writeAlbumPaths(query, s_albumName, job.UID, AutoImport, paths);
+    ::raise(SIGKILL);
+    return 1;
+}
+
+/**
+   @return 通过 AlbumControl 恢复未完成的导入任务，导入完成时返回 true
+ */
+static bool resumeImportJobs()
+{
+    bool finished = false;
+    QEventLoop loop;
+    QObject::connect(AlbumControl::instance(), &AlbumControl::sigImportFinished, &loop, [&]() {
+        finished = true;
+        loop.quit();
+    });
+    QObject::connect(AlbumControl::instance(), &AlbumControl::sigImportFailed, &loop, &QEventLoop::quit);
+    QObject::connect(AlbumControl::instance(), &AlbumControl::sigRepeatUrls, &loop, &QEventLoop::quit);
+    QTimer::singleShot(30000, &loop, &QEventLoop::quit);
+
+    AlbumControl::instance()->resumeImportJobs();
+    loop.exec();
+    return finished;
+}
+
+class tst_ImportJob : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        UID = DBManager::instance()->createAlbum(s_albumName, QStringList(" "), AutoImport);
+        ASSERT_GE(UID, 0);
+    }
+
+    void TearDown() override
+    {
+        DBManager::instance()->removeAlbum(UID);
+    }
+
+    QTemporaryDir dir;
+    int UID = -1;
+};
+
+TEST_F(tst_ImportJob, resumeAfterKilledBatch)
+{
+    QImage image(32, 24, QImage::Format_RGB32);
+    for (int i = 0; i < s_fileCount; ++i) {
+        image.fill(QColor(i * 16, 100, 200));
+        ASSERT_TRUE(image.save(dir.filePath(QString("%1.jpg").arg(i, 2, 10, QChar('0'))), "JPEG"));
+    }
+    const QStringList paths = imagePaths(dir.path());
+    ASSERT_EQ(s_fileCount, paths.size());
+    const int jobID = DBManager::instance()->createImportJob({ dir.path() }, UID, true);
+    ASSERT_GE(jobID, 0);
+
+    QProcess process;
+    process.start(QCoreApplication::applicationFilePath(), { s_killArg });
+    ASSERT_TRUE(process.waitForFinished(30000));
+    ASSERT_EQ(QProcess::CrashExit, process.exitStatus());
+
+    // 终止时未提交的批次整体回滚，任务进度与已提交的数据一致
+    const int committed = s_committedBatches * s_batchSize;
+    const ImportJobInfoList jobs = DBManager::instance()->getImportJobs();
+    ASSERT_EQ(1, jobs.size());
+    EXPECT_EQ(jobID, jobs.first().jobID);
+    EXPECT_EQ(committed, jobs.first().cursor);
+    EXPECT_EQ(s_committedBatches, jobs.first().batchID);
+    EXPECT_EQ(committed, imageRowCount(UID));
+    EXPECT_EQ(committed, albumRowCount(UID));
+
+    // 与应用启动时相同，由导入线程跳过已导入的文件，从已提交的批次号继续
+    ASSERT_TRUE(resumeImportJobs());
+    EXPECT_TRUE(DBManager::instance()->getImportJobs().isEmpty());
+
+    // 每个文件在图片表与相册中各有且仅有一条记录
+    EXPECT_EQ(s_fileCount, imageRowCount(UID));
+    EXPECT_EQ(s_fileCount, albumRowCount(UID));
+    const QStringList albumPaths = DBManager::instance()->getPathsByAlbum(UID);
+    EXPECT_EQ(QSet<QString>(paths.begin(), paths.end()), QSet<QString>(albumPaths.begin(), albumPaths.end()));
+}
+
+TEST_F(tst_ImportJob, finishRemovesDuplicateAlbumRows)
+{
+    DBImgInfoList infos;
+    for (int i = 0; i < 3; ++i) {
+        DBImgInfo info;
+        info.filePath = dir.filePath(QString("%1.jpg").arg(i));
+        info.time = QDateTime::currentDateTime();
+        info.changeTime = info.time;
+        info.importTime = info.time;
+        info.albumUID = QString::number(UID);
+        infos << info;
+    }
+    const int jobID = DBManager::instance()->createImportJob({ dir.path() }, UID, true);
+    ASSERT_GE(jobID, 0);
+
+    // 批次提交不清理相册重复记录，同一文件在不同批次中加入相册时重复
+    ASSERT_TRUE(DBManager::instance()->commitImportBatch(jobID, 1, infos.mid(0, 2), UID, AutoImport));
+    ASSERT_TRUE(DBManager::instance()->commitImportBatch(jobID, 2, infos.mid(1, 2), UID, AutoImport));
+    EXPECT_EQ(4, albumRowCount(UID));
+    EXPECT_EQ(3, imageRowCount(UID));
+
+    // 重复提交已提交的批次不产生新数据
+    ASSERT_TRUE(DBManager::instance()->commitImportBatch(jobID, 2, infos.mid(1, 2), UID, AutoImport));
+    EXPECT_EQ(4, albumRowCount(UID));
+    EXPECT_EQ(4, DBManager::instance()->getImportJobs().first().cursor);
+
+    // 任务完成时统一清理，保留相册占位记录
+    ASSERT_TRUE(DBManager::instance()->finishImportJob(jobID, AutoImport));
+    EXPECT_EQ(3, albumRowCount(UID));
+    EXPECT_EQ(1, queryInt(QString("SELECT COUNT(*) FROM AlbumTable3 WHERE UID = %1 AND PathHash = \"%2\"").arg(UID).arg(emptyHash())));
+    EXPECT_TRUE(DBManager::instance()->getImportJobs().isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    // 数据库、配置及缓存写入临时目录，子进程沿用父进程设置的目录
+    const bool killedChild = argc > 1 && s_killArg == QString::fromLocal8Bit(argv[1]);
+    QScopedPointer<QTemporaryDir> homeDir;
+    if (!killedChild) {
+        homeDir.reset(new QTemporaryDir);
+        qputenv("XDG_DATA_HOME", QDir(homeDir->path()).filePath("data").toLocal8Bit());
+        qputenv("XDG_CONFIG_HOME", QDir(homeDir->path()).filePath("config").toLocal8Bit());
+        qputenv("XDG_CACHE_HOME", QDir(homeDir->path()).filePath("cache").toLocal8Bit());
+    }
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    if (killedChild) {
+        return importUntilKilled();
+    }
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2025 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+#include <QTransform>
+
+#include "unionimage/exifparser.h"
+
+using namespace LibUnionImage_NameSpace;
+
+/**
+   @return 生成大小为 \a size 的 JPEG 文件数据，四个象限分别填充不同颜色，用于判断旋转方向
+ */
+static QByteArray createJpeg(const QSize &size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    const int halfWidth = size.width() / 2;
+    const int halfHeight = size.height() / 2;
+    QPainter painter(&image);
+    painter.fillRect(0, 0, halfWidth, halfHeight, Qt::red);
+    painter.fillRect(halfWidth, 0, size.width() - halfWidth, halfHeight, Qt::green);
+    painter.fillRect(0, halfHeight, halfWidth, size.height() - halfHeight, Qt::blue);
+    painter.fillRect(halfWidth, halfHeight, size.width() - halfWidth, size.height() - halfHeight, Qt::white);
+    painter.end();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPEG", 95);
+    return data;
+}
+
+/**
+   @brief 将 JPEG 文件数据 \a data 的方向字段设置为 \a orientation ，不存在 EXIF 数据段时先插入
+ */
+static void setOrientation(QByteArray &data, int orientation)
+{
+    if (!ExifParser::parse(data).valid) {
+        ASSERT_TRUE(ExifParser::rotateJpegOrientation(data, 0));
+    }
+
+    int tiffOffset = 0;
+    int tiffLength = 0;
+    int insertOffset = 0;
+    bool bigEndian = true;
+    ASSERT_TRUE(ExifParser::findJpegExifSegment(data, tiffOffset, tiffLength, insertOffset));
+    int entry = ExifParser::findIfd0Entry(data, tiffOffset, tiffLength, 0x0112, bigEndian);
+    ASSERT_NE(-1, entry);
+    data[entry + 8] = char(bigEndian ? 0 : orientation);
+    data[entry + 9] = char(bigEndian ? orientation : 0);
+}
+
+/**
+   @return 按 EXIF 方向解码 JPEG 文件数据 \a data 得到的显示图像
+ */
+static QImage decodeJpeg(const QByteArray &data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "JPEG");
+    reader.setAutoTransform(true);
+    return reader.read();
+}
+
+/**
+   @return 图像 \a left 和 \a right 大小相同且各象限中心的颜色相近
+ */
+static bool sameQuadrants(const QImage &left, const QImage &right)
+{
+    if (left.isNull() || left.size() != right.size()) {
+        return false;
+    }
+
+    for (int y = 1; y < 4; y += 2) {
+        for (int x = 1; x < 4; x += 2) {
+            QPoint point(left.width() * x / 4, left.height() * y / 4);
+            QRgb a = left.pixel(point);
+            QRgb b = right.pixel(point);
+            if (qAbs(qRed(a) - qRed(b)) > 48 || qAbs(qGreen(a) - qGreen(b)) > 48 || qAbs(qBlue(a) - qBlue(b)) > 48) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class tst_JpegRotate : public testing::Test
+{
+};
+
+TEST_F(tst_JpegRotate, insertExifWhenMissing)
+{
+    const QByteArray origin = createJpeg(QSize(64, 32));
+    ASSERT_FALSE(ExifParser::parse(origin).valid);
+
+    QByteArray data = origin;
+    ASSERT_TRUE(ExifParser::rotateJpegOrientation(data, 90));
+    EXPECT_EQ(6, ExifParser::parse(data).orientation);
+
+    // 仅插入 EXIF 数据段，原有数据保持不变
+    int tiffOffset = 0;
+    int tiffLength = 0;
+    int insertOffset = 0;
+    ASSERT_TRUE(ExifParser::findJpegExifSegment(data, tiffOffset, tiffLength, insertOffset));
+    const int segmentSize = data.size() - origin.size();
+    const int segmentStart = tiffOffset - 10;
+    EXPECT_EQ(origin.left(segmentStart), data.left(segmentStart));
+    EXPECT_EQ(origin.mid(segmentStart), data.mid(segmentStart + segmentSize));
+}
+
+TEST_F(tst_JpegRotate, rejectNonJpeg)
+{
+    QByteArray data("not a jpeg file");
+    EXPECT_FALSE(ExifParser::rotateJpegOrientation(data, 90));
+    EXPECT_EQ(QByteArray("not a jpeg file"), data);
+}
+
+TEST_F(tst_JpegRotate, composeAllOrientations)
+{
+    const QByteArray origin = createJpeg(QSize(64, 32));
+    const int angles[] = { 90, 180, 270, -90 };
+
+    // 旋转后的显示图像应与原显示图像旋转相同角度一致，覆盖含镜像的方向 2/4/5/7
+    for (int orientation = 1; orientation <= 8; ++orientation) {
+        QByteArray data = origin;
+        setOrientation(data, orientation);
+        const QImage before = decodeJpeg(data);
+        ASSERT_FALSE(before.isNull());
+
+        for (int angle : angles) {
+            QByteArray rotated = data;
+            ASSERT_TRUE(ExifParser::rotateJpegOrientation(rotated, angle));
+            const QImage expected = before.transformed(QTransform().rotate(angle));
+            EXPECT_TRUE(sameQuadrants(expected, decodeJpeg(rotated)))
+                << "orientation:" << orientation << "angle:" << angle
+                << "result:" << ExifParser::parse(rotated).orientation;
+        }
+    }
+}
+
+TEST_F(tst_JpegRotate, rewriteOrientationOnly)
+{
+    // 约 12MP 的图片，无损旋转仅改写方向字段，图像数据不重新编码
+    QByteArray data = createJpeg(QSize(4000, 3000));
+    ASSERT_TRUE(ExifParser::rotateJpegOrientation(data, 0));
+    const QByteArray origin = data;
+
+    int tiffOffset = 0;
+    int tiffLength = 0;
+    int insertOffset = 0;
+    bool bigEndian = true;
+    ASSERT_TRUE(ExifParser::findJpegExifSegment(origin, tiffOffset, tiffLength, insertOffset));
+    const int entry = ExifParser::findIfd0Entry(origin, tiffOffset, tiffLength, 0x0112, bigEndian);
+    ASSERT_NE(-1, entry);
+
+    ASSERT_TRUE(ExifParser::rotateJpegOrientation(data, 90));
+    EXPECT_EQ(6, ExifParser::parse(data).orientation);
+
+    // 除方向字段的取值外，文件其余字节(含压缩图像数据)完全一致
+    ASSERT_EQ(origin.size(), data.size());
+    for (int i = 0; i < origin.size(); ++i) {
+        if (i == entry + 8 || i == entry + 9) {
+            continue;
+        }
+        ASSERT_EQ(origin.at(i), data.at(i)) << "offset:" << i;
+    }
+
+    // 旋转 4 次为一周，方向复原后文件与原文件一致
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ExifParser::rotateJpegOrientation(data, 90));
+    }
+    EXPECT_EQ(origin, data);
+}
+
+int main(int argc, char *argv[])
+{
+    // 解码 JPEG 需要加载图像格式插件
+    QCoreApplication app(argc, argv);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}